@@ -0,0 +1,14 @@
+#include "ArduinoUart.h"
+
+unsigned long arduinoSerialFormat(const SerialConfig& config)
+{
+  // [data bits - 5][parity: none, even, odd][stop bits - 1]
+  static const unsigned long formats[4][3][2] = {
+    {{SERIAL_5N1, SERIAL_5N2}, {SERIAL_5E1, SERIAL_5E2}, {SERIAL_5O1, SERIAL_5O2}},
+    {{SERIAL_6N1, SERIAL_6N2}, {SERIAL_6E1, SERIAL_6E2}, {SERIAL_6O1, SERIAL_6O2}},
+    {{SERIAL_7N1, SERIAL_7N2}, {SERIAL_7E1, SERIAL_7E2}, {SERIAL_7O1, SERIAL_7O2}},
+    {{SERIAL_8N1, SERIAL_8N2}, {SERIAL_8E1, SERIAL_8E2}, {SERIAL_8O1, SERIAL_8O2}},
+  };
+
+  return formats[config.data_bits - 5][static_cast<int>(config.parity)][config.stop_bits - 1];
+}
@@ -0,0 +1,52 @@
+#ifndef ARDUINO_UART_H
+#define ARDUINO_UART_H
+
+#include <SerialConfig.h>
+#include <Arduino.h>
+
+// The core's SERIAL_* format for a framing
+unsigned long arduinoSerialFormat(const SerialConfig& config);
+
+// UartConnection policy over one of a core's hardware serial ports. The
+// core buffers RX in its own interrupt, so the connection polls that
+// buffer. The generic API has no pin, RTS/CTS, FIFO threshold or idle
+// timeout settings, so those are ignored.
+//
+// Each port is its own policy, so on boards with several:
+//
+//   UartConnection<ArduinoUart1, 256> first;
+//   UartConnection<ArduinoUart<decltype(Serial2), Serial2>, 256> second;
+template<typename Serial, Serial& port>
+struct ArduinoUart
+{
+  static const bool interruptDriven = false;
+
+  static void begin(const SerialConfig& config, void (*)())
+  {
+    port.begin(config.baud_rate, arduinoSerialFormat(config));
+  }
+
+  static bool readable()
+  {
+    return port.available() > 0;
+  }
+
+  static char getc()
+  {
+    return static_cast<char>(port.read());
+  }
+
+  static void putc(char c)
+  {
+    port.write(static_cast<uint8_t>(c));
+  }
+
+  static void write(const char* data, size_t size)
+  {
+    port.write(reinterpret_cast<const uint8_t*>(data), size);
+  }
+};
+
+using ArduinoUart1 = ArduinoUart<decltype(Serial1), Serial1>;
+
+#endif //ARDUINO_UART_H
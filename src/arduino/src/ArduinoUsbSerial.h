@@ -0,0 +1,49 @@
+#ifndef ARDUINO_USB_SERIAL_H
+#define ARDUINO_USB_SERIAL_H
+
+#include <Arduino.h>
+
+// UsbCdcConnection policy over the core's native USB Serial. USB NAKs the
+// host while the core's buffer is full, so nothing needs dropping.
+struct ArduinoUsbSerial
+{
+  static const bool backpressure = true;
+
+  static size_t buffered()
+  {
+    int n = Serial.available();
+    return n > 0 ? n : 0;
+  }
+
+  static size_t read(char* data, size_t size)
+  {
+    return Serial.readBytes(data, size);
+  }
+
+  static void putc(char c)
+  {
+    Serial.write(static_cast<uint8_t>(c));
+  }
+
+  static size_t write(const char* data, size_t size)
+  {
+    return Serial.write(reinterpret_cast<const uint8_t*>(data), size);
+  }
+
+  static void flush()
+  {
+    Serial.flush();
+  }
+
+  static uint32_t micros()
+  {
+    return ::micros();
+  }
+
+  static void idle()
+  {
+    yield();
+  }
+};
+
+#endif //ARDUINO_USB_SERIAL_H
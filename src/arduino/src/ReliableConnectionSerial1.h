@@ -5,20 +5,29 @@
 #ifndef RELIABLECONNECTIONSerial1_H
 #define RELIABLECONNECTIONSerial1_H
 
-#include <Connection.h>
+#include <UartConnection.h>
 
-class ReliableConnectionSerial1 : public Connection
+#include "ArduinoUart.h"
+
+// Sizes for this build, overridable with -D (e.g. platformio.ini build_flags).
+// Small by default for AVR-class boards; the ring must be a power of two.
+#ifndef TRANSMISSION_SERIAL1_RX_SIZE
+#define TRANSMISSION_SERIAL1_RX_SIZE 256
+#endif
+
+#ifndef TRANSMISSION_SERIAL1_READ_SIZE
+#define TRANSMISSION_SERIAL1_READ_SIZE 64
+#endif
+
+// begin() is optional here, for sketches that don't call Serial1.begin()
+// themselves
+class ReliableConnectionSerial1 : public UartConnection<ArduinoUart1, TRANSMISSION_SERIAL1_RX_SIZE, 0, TRANSMISSION_SERIAL1_READ_SIZE>
 {
   public:
-    ReliableConnectionSerial1();
-    ~ReliableConnectionSerial1() {}
+    static const int maxBufferSize = TRANSMISSION_SERIAL1_RX_SIZE;
 
-    int tryReadOne();
-    char readOne();
-    std::vector<char> read();
-    std::vector<char> read(int size);
-    void write(std::vector<char> bs);
-    bool availableForReading();
+    ReliableConnectionSerial1() {}
+    ~ReliableConnectionSerial1() {}
 };
 
 #endif //RELIABLECONNECTIONSerial1_H
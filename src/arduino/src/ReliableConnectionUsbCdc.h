@@ -5,20 +5,27 @@
 #ifndef RELIABLECONNECTIONUSBCDC_H
 #define RELIABLECONNECTIONUSBCDC_H
 
-#include <Connection.h>
+#include <UsbCdcConnection.h>
 
-class ReliableConnectionUsbCdc : public Connection
+#include "ArduinoUsbSerial.h"
+
+// Set like the Serial1 sizes (see ReliableConnectionSerial1.h).
+// Small by default for AVR-class boards; the ring must be a power of two.
+#ifndef TRANSMISSION_USB_CDC_RX_SIZE
+#define TRANSMISSION_USB_CDC_RX_SIZE 256
+#endif
+
+#ifndef TRANSMISSION_USB_CDC_READ_SIZE
+#define TRANSMISSION_USB_CDC_READ_SIZE 64
+#endif
+
+class ReliableConnectionUsbCdc : public UsbCdcConnection<ArduinoUsbSerial, TRANSMISSION_USB_CDC_RX_SIZE, TRANSMISSION_USB_CDC_READ_SIZE>
 {
   public:
-    ReliableConnectionUsbCdc();
-    ~ReliableConnectionUsbCdc() {}
+    static const int maxBufferSize = TRANSMISSION_USB_CDC_RX_SIZE;
 
-    int tryReadOne();
-    char readOne();
-    std::vector<char> read();
-    std::vector<char> read(int size);
-    void write(std::vector<char> bs);
-    bool availableForReading();
+    ReliableConnectionUsbCdc() {}
+    ~ReliableConnectionUsbCdc() {}
 };
 
 #endif //RELIABLECONNECTIONUSBCDC_H
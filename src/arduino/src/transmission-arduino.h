@@ -8,4 +8,15 @@
 #include "ReliableConnectionSerial1.h"
 #include "ReliableConnectionUsbCdc.h"
 
+#include <ram_budget.h>
+
+// What this library's backends take with the sizes of this build; print
+// TransmissionRam::total, or define TRANSMISSION_RAM_BUDGET (in bytes) to
+// fail the build when they would not fit
+using TransmissionRam = RamBudget<ReliableConnectionSerial1, ReliableConnectionUsbCdc>;
+
+#ifdef TRANSMISSION_RAM_BUDGET
+static_assert(TransmissionRam::fits(TRANSMISSION_RAM_BUDGET), "Transmission connections exceed TRANSMISSION_RAM_BUDGET");
+#endif
+
 #endif //TRANSMISSION_TRANSMISSION_ARDUINO_H
\ No newline at end of file
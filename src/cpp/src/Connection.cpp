@@ -6,8 +6,10 @@
 
 #include <cstring>
 
+#ifndef TRANSMISSION_NO_HEAP
 void Connection::write(std::string s)
 {
   std::vector<char> bs(s.begin(), s.end());
   write(bs);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
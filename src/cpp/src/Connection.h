@@ -6,17 +6,30 @@
 #include <string>
 #include <cstdint>
 
+// TRANSMISSION_NO_HEAP is for boards that must not allocate once running.
+// The embedded connections never allocate after begin() through their
+// span and StaticVector calls; in this mode the calls that hand over a
+// std::vector are flagged as deprecated wherever a sketch still uses them,
+// and write(std::string) is gone.
+#ifdef TRANSMISSION_NO_HEAP
+#define TRANSMISSION_ALLOCATES [[deprecated("allocates; use the span or StaticVector overloads")]]
+#else
+#define TRANSMISSION_ALLOCATES
+#endif
+
 class EXPORT Connection
 {
     public:
         virtual ~Connection() = default;
 
+#ifndef TRANSMISSION_NO_HEAP
         void write(std::string s);
+#endif
 
         [[nodiscard]] virtual int tryReadOne() = 0;
         [[nodiscard]] virtual char readOne() = 0;
-        [[nodiscard]] virtual std::vector<char> read(int size) = 0;
-        virtual void write(std::vector<char> bs) = 0;
+        [[nodiscard]] TRANSMISSION_ALLOCATES virtual std::vector<char> read(int size) = 0;
+        TRANSMISSION_ALLOCATES virtual void write(std::vector<char> bs) = 0;
         virtual bool availableForReading() = 0;
 };
 
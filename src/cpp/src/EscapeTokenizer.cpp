@@ -0,0 +1,182 @@
+#include "EscapeTokenizer.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static const char ESC = 0x1B;
+static const char BEL = 0x07;
+static const char CAN = 0x18;
+static const char SUB = 0x1A;
+
+EscapeTokenizer::EscapeTokenizer() {
+  reset();
+}
+
+void EscapeTokenizer::reset() {
+  state = State::ground;
+  restart_escape = false;
+  sequence_length = 0;
+}
+
+bool EscapeTokenizer::pending() const {
+  return state != State::ground;
+}
+
+size_t EscapeTokenizer::pendingLength() const {
+  return state == State::ground ? 0 : sequence_length;
+}
+
+size_t EscapeTokenizer::findEscape(const char* data, size_t length) {
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i escape = _mm_set1_epi8(ESC);
+  for (; i + 16 <= length; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, escape));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t escape = vdupq_n_u8(ESC);
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+    if (vmaxvq_u8(vceqq_u8(chunk, escape)) != 0) {
+      break;  // The tail loop pins down the exact byte
+    }
+  }
+#endif
+
+  // Tail, or the whole buffer on MCUs; newlib and glibc memchr scan a word
+  // at a time
+  const void* found = memchr(data + i, ESC, length - i);
+  return found ? static_cast<const char*>(found) - data : length;
+}
+
+void EscapeTokenizer::beginSequence() {
+  sequence[0] = ESC;
+  sequence_length = 1;
+  state = State::escape;
+}
+
+void EscapeTokenizer::finishSequence() {
+  if (restart_escape) {
+    restart_escape = false;
+    beginSequence();
+  } else {
+    sequence_length = 0;
+    state = State::ground;
+  }
+}
+
+// Append bytes of the current sequence until it completes, the buffer
+// fills, or the input runs out. Returns the number of bytes consumed.
+size_t EscapeTokenizer::consumeSequence(const char* data, size_t length, bool& complete) {
+  size_t i = 0;
+
+  while (i < length && sequence_length < maxSequenceLength) {
+    char c = data[i];
+    unsigned char u = static_cast<unsigned char>(c);
+
+    // An ESC abandons anything but a string, whose ESC may begin ST
+    if (c == ESC && state != State::oscString && state != State::controlString) {
+      if (state == State::stringEscape && sequence_length > 0) {
+        // ESC ESC inside a string: the first ended it and starts anew
+        sequence_length--;
+        restart_escape = true;
+      }
+      complete = true;
+      return i;
+    }
+
+    sequence[sequence_length++] = c;
+    i++;
+
+    if (c == CAN || c == SUB) {
+      complete = true;
+      return i;
+    }
+
+    switch (state) {
+      case State::escape:
+        if (c == '[') {
+          state = State::csi;
+        } else if (c == ']') {
+          state = State::oscString;
+        } else if (c == 'P' || c == 'X' || c == '^' || c == '_') {
+          state = State::controlString;
+        } else if (c == 'N' || c == 'O') {
+          state = State::singleShift;
+        } else if (u >= 0x20 && u <= 0x2F) {
+          state = State::escapeIntermediate;
+        } else if (u >= 0x30 && u <= 0x7E) {
+          complete = true;
+        }
+        break;
+
+      case State::escapeIntermediate:
+        if (u >= 0x30 && u <= 0x7E) {
+          complete = true;
+        }
+        break;
+
+      case State::singleShift:
+        if (u >= 0x20) {
+          complete = true;
+        }
+        break;
+
+      case State::csi:
+        // Parameters 0x30-0x3F and intermediates 0x20-0x2F until the final byte
+        if (u >= 0x40 && u <= 0x7E) {
+          complete = true;
+        }
+        break;
+
+      case State::oscString:
+        if (c == BEL) {
+          complete = true;
+        } else if (c == ESC) {
+          state = State::stringEscape;
+        }
+        break;
+
+      case State::controlString:
+        if (c == ESC) {
+          state = State::stringEscape;
+        }
+        break;
+
+      case State::stringEscape:
+        if (c == '\\') {
+          complete = true;  // ST
+        } else {
+          // Not ST: the string ended at the ESC, which starts a new
+          // sequence, unless it already went out in a partial piece
+          sequence_length--;
+          if (sequence_length > 0) {
+            sequence_length--;
+            restart_escape = true;
+          }
+          complete = true;
+          i--;
+        }
+        break;
+
+      case State::ground:
+        break;
+    }
+
+    if (complete) {
+      return i;
+    }
+  }
+
+  return i;
+}
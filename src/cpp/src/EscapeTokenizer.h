@@ -0,0 +1,106 @@
+#ifndef ESCAPE_TOKENIZER_H_
+#define ESCAPE_TOKENIZER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Splits a byte stream into plain text runs and whole ANSI/VT100 escape
+// sequences (ESC x, CSI, SS2/SS3, OSC and DCS/SOS/PM/APC strings), keeping
+// state across calls so a sequence cut in half by a read boundary comes out
+// whole on a later feed(). It never waits for bytes: a partial sequence
+// just stays pending until the rest arrives or flush() is called.
+//
+// Text runs are passed to the sink straight from the caller's buffer and
+// are found with a vector scan for ESC. Sequence bytes are gathered in a
+// fixed buffer; one longer than maxSequenceLength (a long OSC title, say)
+// is passed on as partialSequence pieces and a final sequence piece, so no
+// byte is ever dropped.
+//
+// The sink is any callable taking (EscapeTokenizer::Token, const char*, size_t).
+class EscapeTokenizer {
+  public:
+    static const size_t maxSequenceLength = 128;
+
+    enum class Token : uint8_t {
+      text,
+      sequence,
+      partialSequence
+    };
+
+    EscapeTokenizer();
+
+    template<typename Sink>
+    void feed(const char* data, size_t length, Sink&& sink) {
+      size_t i = 0;
+      while (i < length) {
+        if (state == State::ground) {
+          size_t run = findEscape(data + i, length - i);
+          if (run > 0) {
+            sink(Token::text, data + i, run);
+            i += run;
+          }
+          if (i == length) {
+            break;
+          }
+          beginSequence();
+          i++;
+          continue;
+        }
+
+        bool complete = false;
+        i += consumeSequence(data + i, length - i, complete);
+
+        if (complete) {
+          if (sequence_length > 0) {
+            sink(Token::sequence, sequence, sequence_length);
+          }
+          finishSequence();
+        } else if (sequence_length == maxSequenceLength) {
+          sink(Token::partialSequence, sequence, sequence_length);
+          sequence_length = 0;
+        }
+      }
+    }
+
+    // Pass on a pending partial sequence as is, e.g. a lone ESC keypress
+    // that nothing followed
+    template<typename Sink>
+    void flush(Sink&& sink) {
+      if (state != State::ground && sequence_length > 0) {
+        sink(Token::partialSequence, sequence, sequence_length);
+      }
+      reset();
+    }
+
+    void reset();
+
+    // True while a sequence has started but not finished
+    bool pending() const;
+    size_t pendingLength() const;
+
+    // Offset of the first ESC in data, or length if there is none
+    static size_t findEscape(const char* data, size_t length);
+
+  private:
+    enum class State : uint8_t {
+      ground,
+      escape,
+      escapeIntermediate,
+      singleShift,
+      csi,
+      oscString,
+      controlString,
+      stringEscape
+    };
+
+    State state;
+    bool restart_escape;  // The sequence ended at an ESC that starts the next one
+    size_t sequence_length;
+    char sequence[maxSequenceLength];
+
+    void beginSequence();
+    void finishSequence();
+    size_t consumeSequence(const char* data, size_t length, bool& complete);
+};
+
+#endif // ESCAPE_TOKENIZER_H_
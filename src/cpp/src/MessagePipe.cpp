@@ -0,0 +1,124 @@
+#include "MessagePipe.h"
+
+#include <algorithm>
+
+// MessagePipe implementation
+MessagePipe::MessagePipe()
+    : end_a(std::make_unique<MessagePipeEnd>(channel_b_to_a, channel_a_to_b)),
+      end_b(std::make_unique<MessagePipeEnd>(channel_a_to_b, channel_b_to_a))
+{
+}
+
+MessagePipeEnd& MessagePipe::getEndA() {
+  return *end_a;
+}
+
+MessagePipeEnd& MessagePipe::getEndB() {
+  return *end_b;
+}
+
+// MessagePipeEnd implementation
+MessagePipeEnd::MessagePipeEnd(MessageChannel& read_channel, MessageChannel& write_channel)
+    : read_channel(read_channel), write_channel(write_channel)
+{
+}
+
+bool MessagePipeEnd::send(std::vector<char>&& message) {
+  if (message.empty()) {
+    return true;
+  }
+
+  return write_channel.messages.push(std::move(message));
+}
+
+bool MessagePipeEnd::receive(std::vector<char>& message) {
+  // Finish any message the byte interface has started on first
+  if (partial_offset < partial.size()) {
+    message.assign(partial.begin() + partial_offset, partial.end());
+    partial.clear();
+    partial_offset = 0;
+    return true;
+  }
+
+  return read_channel.messages.pop(message);
+}
+
+std::vector<char> MessagePipeEnd::allocate(size_t capacity) {
+  std::vector<char> buffer;
+  if (write_channel.recycled.pop(buffer)) {
+    buffer.clear();
+  }
+
+  buffer.reserve(capacity);
+  return buffer;
+}
+
+void MessagePipeEnd::release(std::vector<char>&& message) {
+  // If the peer is not allocating, the pool is full and the buffer is freed
+  read_channel.recycled.push(std::move(message));
+}
+
+bool MessagePipeEnd::loadPartial() {
+  if (partial_offset < partial.size()) {
+    return true;
+  }
+
+  if (!partial.empty()) {
+    release(std::move(partial));
+    partial = std::vector<char>();
+  }
+  partial_offset = 0;
+
+  return read_channel.messages.pop(partial);
+}
+
+int MessagePipeEnd::tryReadOne() {
+  if (!loadPartial()) {
+    return -1;  // No data available
+  }
+
+  return static_cast<unsigned char>(partial[partial_offset++]);
+}
+
+char MessagePipeEnd::readOne() {
+  if (!loadPartial()) {
+    return -1;
+  }
+
+  return partial[partial_offset++];
+}
+
+std::vector<char> MessagePipeEnd::read(int size) {
+  std::vector<char> result;
+  if (size <= 0) {
+    return result;
+  }
+
+  // A whole message that fits is handed over without copying
+  if (partial_offset >= partial.size() && loadPartial() && partial.size() == static_cast<size_t>(size)) {
+    result.swap(partial);
+    partial_offset = 0;
+    return result;
+  }
+
+  result.reserve(size);
+  while (result.size() < static_cast<size_t>(size) && loadPartial()) {
+    size_t n = std::min(partial.size() - partial_offset, size - result.size());
+    result.insert(result.end(), partial.begin() + partial_offset, partial.begin() + partial_offset + n);
+    partial_offset += n;
+  }
+
+  return result;  // Return partial read if not enough data
+}
+
+void MessagePipeEnd::write(std::vector<char> bs) {
+  send(std::move(bs));
+}
+
+bool MessagePipeEnd::availableForReading() {
+  return partial_offset < partial.size() || !read_channel.messages.empty();
+}
+
+size_t MessagePipeEnd::messagesAvailable() const {
+  return read_channel.messages.count();
+}
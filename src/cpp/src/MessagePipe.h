@@ -0,0 +1,81 @@
+#ifndef MESSAGE_PIPE_H_
+#define MESSAGE_PIPE_H_
+
+#include "Connection.h"
+#include "spsc_queue.h"
+#include <memory>
+
+// Queues of whole buffers for one direction of a MessagePipe. Sent buffers
+// travel through messages; the receiver hands spent buffers back through
+// recycled so the sender can reuse their allocations.
+struct MessageChannel {
+  static const int maxMessages = 16;
+
+  SpscQueue<std::vector<char>, maxMessages> messages;
+  SpscQueue<std::vector<char>, maxMessages> recycled;
+};
+
+// A MessagePipe end moves buffer ownership instead of copying bytes, so
+// sending a 64 KB buffer costs one pointer move. The byte-oriented
+// Connection interface still works on top of it for existing callers.
+class EXPORT MessagePipeEnd : public Connection {
+  public:
+    MessagePipeEnd(MessageChannel& read_channel, MessageChannel& write_channel);
+
+    // Zero-copy fast path. send() returns false when the peer has
+    // maxMessages buffers outstanding; the buffer is left with the caller.
+    bool send(std::vector<char>&& message);
+    bool receive(std::vector<char>& message);
+
+    // Buffer pool: allocate() prefers a buffer the peer released, so steady
+    // state traffic does not touch the heap. release() returns a received
+    // buffer to the peer.
+    std::vector<char> allocate(size_t capacity);
+    void release(std::vector<char>&& message);
+
+    using Connection::write;
+
+    // Connection interface. write() moves its argument into a single
+    // message and drops it if the queue is full, like PipeEnd.
+    [[nodiscard]] int tryReadOne() override;
+    [[nodiscard]] char readOne() override;
+    [[nodiscard]] std::vector<char> read(int size) override;
+    void write(std::vector<char> bs) override;
+    bool availableForReading() override;
+
+    size_t messagesAvailable() const;
+
+  private:
+    MessageChannel& read_channel;
+    MessageChannel& write_channel;
+
+    // Message currently being consumed through the byte interface
+    std::vector<char> partial;
+    size_t partial_offset = 0;
+
+    bool loadPartial();
+};
+
+class EXPORT MessagePipe {
+  public:
+    MessagePipe();
+    ~MessagePipe() = default;
+
+    MessagePipeEnd& getEndA();
+    MessagePipeEnd& getEndB();
+
+    // Disable copying and moving
+    MessagePipe(const MessagePipe&) = delete;
+    MessagePipe& operator=(const MessagePipe&) = delete;
+    MessagePipe(MessagePipe&&) = delete;
+    MessagePipe& operator=(MessagePipe&&) = delete;
+
+  private:
+    MessageChannel channel_a_to_b;
+    MessageChannel channel_b_to_a;
+
+    std::unique_ptr<MessagePipeEnd> end_a;
+    std::unique_ptr<MessagePipeEnd> end_b;
+};
+
+#endif // MESSAGE_PIPE_H_
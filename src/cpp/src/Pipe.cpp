@@ -20,8 +20,7 @@ PipeEnd& Pipe::getEndB() {
 }
 
 // PipeEnd implementation
-PipeEnd::PipeEnd(InterruptSafeRingBuffer<char, 4096>& read_buf,
-                 InterruptSafeRingBuffer<char, 4096>& write_buf)
+PipeEnd::PipeEnd(PipeBuffer& read_buf, PipeBuffer& write_buf)
     : read_buffer(read_buf), write_buffer(write_buf)
 {
 }
@@ -43,26 +42,23 @@ char PipeEnd::readOne() {
 }
 
 std::vector<char> PipeEnd::read(int size) {
-  std::vector<char> result;
-  result.reserve(size);
-
-  char ch;
-  for (int i = 0; i < size; ++i) {
-    if (!read_buffer.get(ch)) {
-      break;  // Return partial read if not enough data
-    }
-    result.push_back(ch);
+  if (size <= 0) {
+    return std::vector<char>();
   }
 
+  std::vector<char> result(size);
+  size_t count = read_buffer.get(result.data(), result.size());
+  result.resize(count);  // Return partial read if not enough data
+
   return result;
 }
 
 void PipeEnd::write(std::vector<char> bs) {
-  for (char ch : bs) {
-    if (!write_buffer.put(ch)) {
-      return;
-    }
-  }
+  tryWrite(bs);
+}
+
+size_t PipeEnd::tryWrite(const std::vector<char>& bs) {
+  return write_buffer.put(bs.data(), bs.size());
 }
 
 bool PipeEnd::availableForReading()
@@ -2,14 +2,16 @@
 #define PIPE_H_
 
 #include "Connection.h"
+#include "TransmissionConfig.h"
 #include "ring_buffer.h"
 #include <memory>
 
+using PipeBuffer = InterruptSafeRingBuffer<char, TRANSMISSION_PIPE_SIZE>;
+
 // PipeEnd must be fully defined before Pipe since Pipe uses unique_ptr<PipeEnd>
 class EXPORT PipeEnd : public Connection {
   public:
-    PipeEnd(InterruptSafeRingBuffer<char, 4096>& read_buf,
-            InterruptSafeRingBuffer<char, 4096>& write_buf);
+    PipeEnd(PipeBuffer& read_buf, PipeBuffer& write_buf);
 
     [[nodiscard]] int tryReadOne() override;
     [[nodiscard]] char readOne() override;
@@ -17,14 +19,17 @@ class EXPORT PipeEnd : public Connection {
     void write(std::vector<char> bs) override;
     bool availableForReading() override;
 
+    // Write as much as fits and return how many bytes were accepted
+    size_t tryWrite(const std::vector<char>& bs);
+
     // Additional utility methods for testing
     size_t available() const;
     size_t writeSpace() const;
     void flush();
 
   private:
-    InterruptSafeRingBuffer<char, 4096>& read_buffer;
-    InterruptSafeRingBuffer<char, 4096>& write_buffer;
+    PipeBuffer& read_buffer;
+    PipeBuffer& write_buffer;
 };
 
 class EXPORT Pipe {
@@ -46,9 +51,9 @@ class EXPORT Pipe {
   private:
     // Two ring buffers for bidirectional communication
     // Buffer A->B: written by end A, read by end B
-    InterruptSafeRingBuffer<char, 4096> buffer_a_to_b;
+    PipeBuffer buffer_a_to_b;
     // Buffer B->A: written by end B, read by end A
-    InterruptSafeRingBuffer<char, 4096> buffer_b_to_a;
+    PipeBuffer buffer_b_to_a;
 
     std::unique_ptr<PipeEnd> end_a;
     std::unique_ptr<PipeEnd> end_b;
@@ -0,0 +1,54 @@
+#ifndef SERIAL_CONFIG_H_
+#define SERIAL_CONFIG_H_
+
+#include <stdint.h>
+
+// Line settings for a UART, taken by every Serial1 backend and the host
+// serial backends. The defaults are the 115200 8N1 without flow control
+// that every backend used to hard-code.
+//
+// Settings a platform has no control over are ignored there: the host
+// drivers own their FIFOs and idle timers, the RP2040's PL011 has a fixed
+// 32 bit-time RX timeout, and Teensy's HardwareSerial exposes neither.
+struct SerialConfig {
+  enum class Parity : uint8_t {
+    none,
+    even,
+    odd
+  };
+
+  uint32_t baud_rate = 115200;
+  uint8_t data_bits = 8;    // 5 to 8
+  uint8_t stop_bits = 1;    // 1 or 2
+  Parity parity = Parity::none;
+
+  // TX/RX pins for parts that can route a UART to several; -1 keeps the
+  // port's default. Host backends and generic Arduino cores ignore them.
+  int8_t tx_pin = -1;
+  int8_t rx_pin = -1;
+
+  // RTS/CTS hardware flow control. Pins of -1 mean the board's default
+  // (and, on Teensy, where there is none, no RTS or no CTS).
+  bool hardware_flow_control = false;
+  int8_t rts_pin = -1;
+  int8_t cts_pin = -1;
+
+  // Bytes in the hardware RX FIFO that raise the RX interrupt; 0 keeps the
+  // backend's default. Lower reacts sooner, higher interrupts less often.
+  uint8_t rx_fifo_threshold = 0;
+
+  // Character times of line silence after which bytes below the threshold
+  // are handed up anyway; 0 keeps the backend's default
+  uint8_t rx_idle_timeout = 0;
+
+  SerialConfig() {}
+  SerialConfig(uint32_t baud_rate) : baud_rate(baud_rate) {}
+
+  bool valid() const {
+    return baud_rate > 0 &&
+           data_bits >= 5 && data_bits <= 8 &&
+           (stop_bits == 1 || stop_bits == 2);
+  }
+};
+
+#endif // SERIAL_CONFIG_H_
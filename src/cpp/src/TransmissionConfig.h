@@ -0,0 +1,34 @@
+#ifndef TRANSMISSION_CONFIG_H_
+#define TRANSMISSION_CONFIG_H_
+
+// Build-wide sizes shared by more than one backend. Each can be overridden
+// with -D, for the library and its callers alike.
+
+// Each direction's ring in Pipe and BlockingPipe. A power of two.
+#ifndef TRANSMISSION_PIPE_SIZE
+#define TRANSMISSION_PIPE_SIZE 4096
+#endif
+
+// Both rings of FdConnection and IoUringConnection. A power of two.
+#ifndef TRANSMISSION_FD_BUFFER_SIZE
+#define TRANSMISSION_FD_BUFFER_SIZE 4096
+#endif
+
+// The RX ring of TcpConnection and UnixSocketConnection (a power of two),
+// and their maxReadSize: the chunk callers read at a time, and the most a
+// stream receiveMessage() hands back.
+#ifndef TRANSMISSION_SOCKET_BUFFER_SIZE
+#define TRANSMISSION_SOCKET_BUFFER_SIZE 65536
+#endif
+
+#ifndef TRANSMISSION_SOCKET_READ_SIZE
+#define TRANSMISSION_SOCKET_READ_SIZE 1024
+#endif
+
+// Each direction's ring in SharedMemoryPipe. A power of two, and the same
+// for every process that shares a pipe.
+#ifndef TRANSMISSION_SHM_PIPE_SIZE
+#define TRANSMISSION_SHM_PIPE_SIZE 65536
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef UART_CONNECTION_H_
+#define UART_CONNECTION_H_
+
+#include "Connection.h"
+#include "SerialConfig.h"
+#include "static_vector.h"
+#include "uart_receiver.h"
+#include "uart_transmitter.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// The shared core of the Serial1 backends: an interrupt-fed RX ring with
+// XON/XOFF flow control behind the Connection interface. Each board only
+// supplies a UART policy of static functions, so the ISR path inlines
+// down to register accesses:
+//
+//   static const bool interruptDriven;
+//   static void begin(const SerialConfig& config, void (*isr)());
+//   static bool readable();
+//   static char getc();
+//   static void putc(char c);                 blocking
+//
+// plus, optionally, the bulk buffered()/read() pair of uart_receiver.h and
+//
+//   static void write(const char* data, size_t size);   blocking
+//
+// begin() must configure the peripheral and route its RX interrupt to isr,
+// which is a trampoline bound to this instantiation at compile time.
+//
+// With TxSize 0, write() blocks in the policy until the driver has taken
+// everything. A nonzero TxSize adds a TX ring that write() copies into and
+// the policy's TX interrupt drains (see uart_transmitter.h); that interrupt
+// must be routed to the same isr. A policy without an interrupt of its own
+// (one over a core's HardwareSerial, which already buffers in its ISR) sets
+// interruptDriven to false, and the ring is then filled from the main loop
+// on every read.
+//
+// There is one live instance per policy, the one constructed last. Board
+// policies are templated on their port, so connections on different UARTs
+// each get their own rings and trampoline.
+//
+// Both rings live inside the connection, so its sizeof is its RAM cost
+// (see ram_budget.h). ReadSize caps what read() with no argument returns,
+// in a StaticVector: that, the span calls and the StaticVector write never
+// allocate, so a loop built on them runs without the heap.
+template<typename Uart, size_t RxSize, size_t TxSize = 0, size_t ReadSize = 128>
+class UartConnection : public Connection
+{
+  static_assert(ReadSize > 0, "ReadSize must be at least 1");
+
+  public:
+    static constexpr char XON  = 0x11;
+    static constexpr char XOFF = 0x13;
+
+    static constexpr int maxReadSize = ReadSize;
+
+    UartConnection() {
+      instance = this;
+    }
+
+    ~UartConnection() {
+      if (instance == this) {
+        instance = nullptr;
+      }
+    }
+
+    UartConnection(const UartConnection&) = delete;
+    UartConnection& operator=(const UartConnection&) = delete;
+
+    void begin(const SerialConfig& config = SerialConfig()) {
+      if (!config.valid()) {
+        return;
+      }
+
+      Uart::begin(config, &onInterrupt);
+
+      if (receiver.xonXoff()) {
+        Uart::putc(XON);
+      }
+    }
+
+    void enableXonXoff() {
+      receiver.setXonXoff(true);
+    }
+
+    void disableXonXoff() {
+      receiver.setXonXoff(false);
+    }
+
+    // Bytes dropped because the RX ring was full
+    uint32_t droppedBytes() const {
+      return receiver.droppedBytes();
+    }
+
+    // Bulk read into the caller's buffer; returns what was there, up to size
+    size_t read(char* data, size_t size) {
+      poll();
+      return receiver.read(data, size);
+    }
+
+    // Queues what fits and returns the count; only waits when TxSize is 0
+    size_t write(const char* data, size_t size) {
+      return transmitter.write(data, size);
+    }
+
+    // Blocks until everything written has been handed to the UART
+    void flush() {
+      transmitter.drain();
+    }
+
+    using Connection::write;
+
+    // Connection
+    int tryReadOne() override {
+      poll();
+      return receiver.tryReadOne();
+    }
+
+    // Blocks until a byte arrives
+    char readOne() override {
+      int c;
+      while ((c = tryReadOne()) < 0) {
+      }
+      return static_cast<char>(c);
+    }
+
+    // Returns what has arrived, up to size, without waiting
+    TRANSMISSION_ALLOCATES std::vector<char> read(int size) override {
+      std::vector<char> results;
+      if (size <= 0) {
+        return results;
+      }
+
+      results.resize(size);
+      results.resize(read(results.data(), results.size()));
+      return results;
+    }
+
+    // Returns once everything is queued; blocks only while the TX ring is full
+    TRANSMISSION_ALLOCATES void write(std::vector<char> bs) override {
+      writeAll(bs.data(), bs.size());
+    }
+
+    bool availableForReading() override {
+      poll();
+      return receiver.available();
+    }
+    // end Connection
+
+    // Returns what has arrived, up to ReadSize, without waiting
+    StaticVector<char, ReadSize> read() {
+      StaticVector<char, ReadSize> results;
+      results.resize(read(results.data(), results.capacity()));
+      return results;
+    }
+
+    // Returns once everything is queued, like write(std::vector)
+    template<size_t N>
+    void write(const StaticVector<char, N>& bs) {
+      writeAll(bs.data(), bs.size());
+    }
+
+    // RX and TX trampoline handed to Uart::begin()
+    static void onInterrupt() {
+      UartConnection* self = instance;
+      if (self) {
+        self->receiver.service();
+        self->transmitter.service();
+      }
+    }
+
+  private:
+    static inline UartConnection* volatile instance = nullptr;
+
+    UartReceiver<Uart, RxSize> receiver;
+    UartTransmitter<Uart, TxSize> transmitter;
+
+    void poll() {
+      if constexpr (!Uart::interruptDriven) {
+        receiver.service();
+      }
+    }
+
+    void writeAll(const char* data, size_t size) {
+      while (size > 0) {
+        size_t n = transmitter.write(data, size);
+        data += n;
+        size -= n;
+        if (size > 0) {
+          transmitter.waitForRoom();
+        }
+      }
+    }
+};
+
+#endif // UART_CONNECTION_H_
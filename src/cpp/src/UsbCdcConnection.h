@@ -0,0 +1,154 @@
+#ifndef USB_CDC_CONNECTION_H_
+#define USB_CDC_CONNECTION_H_
+
+#include "Connection.h"
+#include "static_vector.h"
+#include "uart_receiver.h"
+#include "usb_transmitter.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// The shared core of the USB CDC backends. RX is emptied from the USB
+// stack into a flow-controlled ring in bulk, a contiguous span per read;
+// TX is staged into full 64 byte packets (see usb_transmitter.h). Each
+// board only supplies a policy over its USB serial:
+//
+//   static size_t buffered();                  bytes the stack holds now
+//   static size_t read(char* data, size_t n);  up to buffered(), no waiting
+//   static void putc(char c);                  XON/XOFF
+//   static size_t write(const char* data, size_t size);   blocking
+//   static void flush();                       send a partial packet now
+//   static uint32_t micros();
+//   static void idle();                        while a read waits
+//
+// The ring is filled, and a held-back partial packet sent once its flush
+// delay has passed, on every call; poll() does just that for loops that
+// may not read or write for a while.
+//
+// The ring and the packet stage live inside the connection, so its sizeof
+// is its RAM cost (see ram_budget.h). ReadSize caps what read() with no
+// argument returns; as with UartConnection, only the std::vector calls
+// allocate.
+template<typename Usb, size_t RxSize, size_t ReadSize = 512>
+class UsbCdcConnection : public Connection
+{
+  static_assert(ReadSize > 0, "ReadSize must be at least 1");
+
+  public:
+    static constexpr char XON  = 0x11;
+    static constexpr char XOFF = 0x13;
+
+    static constexpr int maxReadSize = ReadSize;
+
+    void begin() {
+      if (receiver.xonXoff()) {
+        Usb::putc(XON);
+      }
+    }
+
+    void enableXonXoff() {
+      receiver.setXonXoff(true);
+    }
+
+    void disableXonXoff() {
+      receiver.setXonXoff(false);
+    }
+
+    // How long a partial packet may wait for more bytes; 1 ms by default
+    void setFlushDelay(uint32_t delay_us) {
+      transmitter.setFlushDelay(delay_us);
+    }
+
+    void poll() {
+      receiver.service();
+      transmitter.poll();
+    }
+
+    // Sends a held-back partial packet now
+    void flush() {
+      transmitter.flush();
+    }
+
+    // Bulk read into the caller's buffer; returns what was there, up to size
+    size_t read(char* data, size_t size) {
+      poll();
+      return receiver.read(data, size);
+    }
+
+    void write(const char* data, size_t size) {
+      transmitter.write(data, size);
+      transmitter.poll();
+    }
+
+    using Connection::write;
+
+    // Connection
+    int tryReadOne() override {
+      poll();
+      return receiver.tryReadOne();
+    }
+
+    // Blocks until a byte arrives
+    char readOne() override {
+      int c;
+      while ((c = tryReadOne()) < 0) {
+        Usb::idle();
+      }
+      return static_cast<char>(c);
+    }
+
+    // Blocks until size bytes have arrived, copying them out in spans
+    TRANSMISSION_ALLOCATES std::vector<char> read(int size) override {
+      std::vector<char> results;
+      if (size <= 0) {
+        return results;
+      }
+
+      results.resize(size);
+      size_t filled = 0;
+      while (true) {
+        filled += read(results.data() + filled, results.size() - filled);
+        if (filled == results.size()) {
+          break;
+        }
+        Usb::idle();
+      }
+
+      return results;
+    }
+
+    TRANSMISSION_ALLOCATES void write(std::vector<char> bs) override {
+      write(bs.data(), bs.size());
+    }
+
+    bool availableForReading() override {
+      poll();
+      return receiver.available();
+    }
+    // end Connection
+
+    // Returns what has arrived, up to ReadSize, without waiting
+    StaticVector<char, ReadSize> read() {
+      StaticVector<char, ReadSize> results;
+      results.resize(read(results.data(), results.capacity()));
+      return results;
+    }
+
+    template<size_t N>
+    void write(const StaticVector<char, N>& bs) {
+      write(bs.data(), bs.size());
+    }
+
+    // Bytes dropped because the RX ring was full
+    uint32_t droppedBytes() const {
+      return receiver.droppedBytes();
+    }
+
+  private:
+    UartReceiver<Usb, RxSize> receiver;
+    UsbTransmitter<Usb> transmitter;
+};
+
+#endif // USB_CDC_CONNECTION_H_
@@ -0,0 +1,237 @@
+// frame_receiver.h
+// Delimited-frame receive path: the interrupt notes where each frame ends
+// as it stores the bytes, and queues a descriptor for it, so the main loop
+// takes whole messages without scanning for the delimiter again.
+
+#ifndef FRAME_RECEIVER_H
+#define FRAME_RECEIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#include "ring_buffer.h"
+#include "spsc_queue.h"
+#include "uart_receiver.h"
+
+// Where a complete frame sits in the ring, and when it arrived
+struct FrameDescriptor {
+    uint32_t timestamp = 0;   // Uart::micros() as its delimiter was stored
+    uint32_t offset = 0;      // ring index of its first byte
+    uint32_t length = 0;      // bytes in the ring, delimiter included
+    bool truncated = false;   // the ring filled mid-frame and bytes were dropped
+
+    FrameDescriptor() = default;
+    FrameDescriptor(uint32_t timestamp, uint32_t offset, uint32_t length, bool truncated)
+        : timestamp(timestamp), offset(offset), length(length), truncated(truncated) {}
+};
+
+template<typename Uart, typename = void>
+struct UartHasClock : std::false_type {};
+
+template<typename Uart>
+struct UartHasClock<Uart, decltype(void(Uart::micros()))> : std::true_type {};
+
+// Uart is the same policy as for uart_receiver.h, bulk or FIFO; with a
+// static uint32_t micros() the descriptors carry arrival times, otherwise
+// they read 0. Call service() from the policy's interrupt, or from the
+// loop for a policy without one, and read frames from the main loop:
+//
+//   static FrameReceiver<Rp2040Uart0, 4096, 64> receiver;
+//   static void onUart() { receiver.service(); }
+//
+//   char line[256];
+//   receiver.drain(line, sizeof(line), [](const FrameDescriptor& frame, const char* data, size_t size) {
+//       handleLine(data, size);
+//   });
+//
+// Should the descriptor queue fill up, a frame's boundary is not queued
+// and it arrives joined to the next one, delimiter and all, rather than
+// being lost; mergedFrames() counts those. Bytes that find the ring full
+// are dropped, and the frames they belonged to are marked truncated.
+//
+// A policy with backpressure (see uart_receiver.h) instead keeps them in
+// the driver while complete frames wait in the ring, and service() picks
+// them up once those are read; call it again after draining. Only a frame
+// too long for the ring, which could never complete, is cut short, up to
+// its delimiter.
+template<typename Uart, size_t SIZE, size_t FRAMES, char DELIMITER = '\n'>
+class FrameReceiver {
+public:
+    static const char delimiter = DELIMITER;
+
+    // Producer interface (ISR or driver task). Returns the bytes stored.
+    size_t service() {
+        size_t stored = 0;
+
+        while (true) {
+            char* span;
+            size_t space = ring.writeSpan(span);
+
+            if (space == 0) {
+                // Frames to read will free the ring; the link holds the
+                // sender off meanwhile
+                if constexpr (UartHasBackpressure<Uart>::value) {
+                    if (frames.count() > 0) {
+                        break;
+                    }
+                }
+
+                if (!drop()) {
+                    break;
+                }
+                continue;
+            }
+
+            size_t n = fetch(span, space);
+            if (n == 0) {
+                break;
+            }
+
+            // Publish the bytes before the descriptors that point at them
+            ring.commit(n);
+            scan(span, n);
+            stored += n;
+        }
+
+        return stored;
+    }
+
+    // Consumer interface (main loop). Copies the next complete frame into
+    // data, up to size, and frees it; false when none has completed. A
+    // frame longer than size has the rest skipped: frame.length says so.
+    bool read(FrameDescriptor& frame, char* data, size_t size) {
+        return frames.drain([&](FrameDescriptor& next) {
+            frame = next;
+            take(next, data, size);
+        }, 1) == 1;
+    }
+
+    // Calls handle(frame, data, copied) for up to max complete frames, each
+    // copied into buffer in turn, and frees them together
+    template<typename F>
+    size_t drain(char* buffer, size_t size, F&& handle, size_t max = FRAMES) {
+        return frames.drain([&](FrameDescriptor& frame) {
+            size_t copied = take(frame, buffer, size);
+            handle(static_cast<const FrameDescriptor&>(frame), static_cast<const char*>(buffer), copied);
+        }, max);
+    }
+
+    // Complete frames waiting
+    size_t available() const {
+        return frames.count();
+    }
+
+    // Bytes in the ring, including a frame still arriving
+    size_t count() const {
+        return ring.count();
+    }
+
+    // Bytes thrown away because the ring was full
+    uint32_t droppedBytes() const {
+        return dropped_bytes;
+    }
+
+    // Boundaries lost to a full descriptor queue
+    uint32_t mergedFrames() const {
+        return merged_frames;
+    }
+
+private:
+    InterruptSafeRingBuffer<char, SIZE> ring;
+    SpscQueue<FrameDescriptor, FRAMES> frames;
+
+    // Producer only: running byte positions, modulo the size_t range
+    size_t written = 0;
+    size_t frame_start = 0;
+    bool truncated = false;
+
+    volatile uint32_t dropped_bytes = 0;
+    volatile uint32_t merged_frames = 0;
+
+    size_t fetch(char* span, size_t space) {
+        if constexpr (UartHasBulkRead<Uart>::value) {
+            size_t pending = Uart::buffered();
+            if (pending == 0) {
+                return 0;
+            }
+            return Uart::read(span, pending < space ? pending : space);
+        } else {
+            size_t n = 0;
+            while (n < space && Uart::readable()) {
+                span[n++] = Uart::getc();
+            }
+            return n;
+        }
+    }
+
+    // Ring full: discard what the driver holds, still watching for the
+    // delimiter so the frame in the ring can end and be read out. With
+    // backpressure a byte at a time, so what follows that delimiter stays
+    // in the driver.
+    bool drop() {
+        char scratch[UartHasBackpressure<Uart>::value ? 1 : 32];
+        size_t n = fetch(scratch, sizeof(scratch));
+        if (n == 0) {
+            return false;
+        }
+
+        dropped_bytes = dropped_bytes + n;
+
+        for (size_t i = 0; i < n; i++) {
+            if (scratch[i] != DELIMITER) {
+                truncated = true;
+            } else if (written != frame_start) {
+                // Its delimiter at least was lost
+                truncated = true;
+                close(written);
+            } else {
+                // Nothing of it reached the ring; the next starts whole
+                truncated = false;
+            }
+        }
+
+        return true;
+    }
+
+    void scan(const char* span, size_t n) {
+        size_t base = written;
+        written += n;
+
+        const char* p = span;
+        const char* end = span + n;
+        while (p < end) {
+            const char* found = static_cast<const char*>(memchr(p, DELIMITER, end - p));
+            if (!found) {
+                break;
+            }
+            close(base + (found - span) + 1);
+            p = found + 1;
+        }
+    }
+
+    void close(size_t end) {
+        uint32_t stamp = 0;
+        if constexpr (UartHasClock<Uart>::value) {
+            stamp = Uart::micros();
+        }
+
+        if (!frames.emplace(stamp, frame_start & (SIZE - 1), end - frame_start, truncated)) {
+            merged_frames = merged_frames + 1;
+            return;
+        }
+
+        frame_start = end;
+        truncated = false;
+    }
+
+    // Consumer only: copies frame out of the ring, up to size, and frees it
+    size_t take(const FrameDescriptor& frame, char* data, size_t size) {
+        size_t copied = ring.get(data, frame.length < size ? frame.length : size);
+        ring.consume(frame.length - copied);
+        return copied;
+    }
+};
+
+#endif // FRAME_RECEIVER_H
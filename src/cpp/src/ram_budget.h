@@ -0,0 +1,33 @@
+// ram_budget.h
+// Compile-time accounting of the static RAM that connections take, so a
+// build can fail when its rings no longer fit the board.
+
+#ifndef RAM_BUDGET_H
+#define RAM_BUDGET_H
+
+#include <stddef.h>
+
+// The UART, USB and socket connections keep their rings inside the object,
+// so sizeof is what each one costs wherever it is placed: in .bss for a
+// global, on the stack or heap otherwise. Driver-side buffers (the ESP32's
+// UART driver, a core's HardwareSerial, lwIP) are not included.
+//
+// List the connections a sketch creates and check them against what the
+// board can spare:
+//
+//   using Links = RamBudget<ReliableConnectionSerial1, ReliableConnectionUsbCdc>;
+//   static_assert(Links::total <= 16 * 1024, "links need more than 16 KiB");
+//
+// Each board's umbrella header does this for its own backends when
+// TRANSMISSION_RAM_BUDGET is defined (in bytes) for the build.
+template<typename... Connections>
+struct RamBudget {
+    static constexpr size_t count = sizeof...(Connections);
+    static constexpr size_t total = (sizeof(Connections) + ... + 0);
+
+    static constexpr bool fits(size_t budget) {
+        return total <= budget;
+    }
+};
+
+#endif // RAM_BUDGET_H
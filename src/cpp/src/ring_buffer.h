@@ -6,6 +6,30 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
+
+// volatile keeps the compiler from caching indices, but on multi-core parts
+// (RP2040, ESP32, hosts, processes sharing memory) the CPU can still reorder
+// the slot and index accesses. Thread fences order them: free on x86, a dmb
+// on ARM. A single core always sees its own accesses, an interrupt's
+// included, in program order, so there only the compiler needs fencing.
+// AVR and Teensy are single-core; define TRANSMISSION_SINGLE_CORE for
+// other such boards. The RP2040 is a Cortex-M0+ too, which is why this
+// can't be keyed off the architecture.
+#if !defined(TRANSMISSION_SINGLE_CORE) && (defined(__AVR__) || defined(TEENSYDUINO))
+#define TRANSMISSION_SINGLE_CORE
+#endif
+
+#if defined(__GNUC__) && defined(TRANSMISSION_SINGLE_CORE)
+#define RING_BUFFER_ACQUIRE() __atomic_signal_fence(__ATOMIC_ACQUIRE)
+#define RING_BUFFER_RELEASE() __atomic_signal_fence(__ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+#define RING_BUFFER_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define RING_BUFFER_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#define RING_BUFFER_ACQUIRE()
+#define RING_BUFFER_RELEASE()
+#endif
 
 template<typename T, size_t SIZE>
 class InterruptSafeRingBuffer {
@@ -28,8 +52,10 @@ public:
         if (next_head == tail) {
             return false;  // Buffer full
         }
+        RING_BUFFER_ACQUIRE();
         
         buffer[head] = item;
+        RING_BUFFER_RELEASE();
         head = next_head;
         return true;
     }
@@ -39,12 +65,82 @@ public:
         if (head == tail) {
             return false;  // Buffer empty
         }
+        RING_BUFFER_ACQUIRE();
         
         item = buffer[tail];
+        RING_BUFFER_RELEASE();
         tail = (tail + 1) & (SIZE - 1);
         return true;
     }
     
+    // Bulk producer interface: copy as many items as fit, return the count
+    size_t put(const T* items, size_t count) {
+        size_t h = head;
+        size_t space = (tail - h - 1) & (SIZE - 1);
+        size_t n = count < space ? count : space;
+        RING_BUFFER_ACQUIRE();
+
+        // At most two contiguous spans; the fences above and below make it
+        // safe to copy them without per-element volatile accesses
+        size_t first = (SIZE - h) < n ? (SIZE - h) : n;
+        memcpy(const_cast<T*>(&buffer[h]), items, first * sizeof(T));
+        memcpy(const_cast<T*>(&buffer[0]), items + first, (n - first) * sizeof(T));
+
+        RING_BUFFER_RELEASE();
+        head = (h + n) & (SIZE - 1);
+        return n;
+    }
+
+    // Bulk consumer interface: copy up to count items, return the count
+    size_t get(T* items, size_t count) {
+        size_t t = tail;
+        size_t stored = (head - t) & (SIZE - 1);
+        size_t n = count < stored ? count : stored;
+        RING_BUFFER_ACQUIRE();
+
+        size_t first = (SIZE - t) < n ? (SIZE - t) : n;
+        memcpy(items, const_cast<const T*>(&buffer[t]), first * sizeof(T));
+        memcpy(items + first, const_cast<const T*>(&buffer[0]), (n - first) * sizeof(T));
+
+        RING_BUFFER_RELEASE();
+        tail = (t + n) & (SIZE - 1);
+        return n;
+    }
+
+    // Zero-copy producer interface: expose the contiguous free space at
+    // head, fill it directly (e.g. with read(2)), then commit what was used
+    size_t writeSpan(T*& data) {
+        size_t h = head;
+        size_t space = (tail - h - 1) & (SIZE - 1);
+        size_t contiguous = SIZE - h;
+        RING_BUFFER_ACQUIRE();
+
+        data = const_cast<T*>(&buffer[h]);
+        return space < contiguous ? space : contiguous;
+    }
+
+    void commit(size_t count) {
+        RING_BUFFER_RELEASE();
+        head = (head + count) & (SIZE - 1);
+    }
+
+    // Zero-copy consumer interface: expose the contiguous stored items at
+    // tail, use them in place (e.g. with write(2)), then consume what was used
+    size_t readSpan(const T*& data) {
+        size_t t = tail;
+        size_t stored = (head - t) & (SIZE - 1);
+        size_t contiguous = SIZE - t;
+        RING_BUFFER_ACQUIRE();
+
+        data = const_cast<const T*>(&buffer[t]);
+        return stored < contiguous ? stored : contiguous;
+    }
+
+    void consume(size_t count) {
+        RING_BUFFER_RELEASE();
+        tail = (tail + count) & (SIZE - 1);
+    }
+
     // Check if data available (safe from either context)
     bool available() const {
         return head != tail;
@@ -82,6 +178,7 @@ public:
         if (head == tail) {
             return false;
         }
+        RING_BUFFER_ACQUIRE();
         item = buffer[tail];
         return true;
     }
@@ -0,0 +1,138 @@
+// socket_receiver.h
+// Bulk receive path for stream sockets: fills a ring straight from the
+// socket into its contiguous free space, and copies out in spans.
+
+#ifndef SOCKET_RECEIVER_H
+#define SOCKET_RECEIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ring_buffer.h"
+
+// Socket is anything with the receive half of Arduino's Client API plus a
+// clock and a way to wait, so the same code runs over a WiFiClient on the
+// ESP32 and a host TCP socket in tests:
+//
+//   int available();                        bytes readable without blocking
+//   int read(uint8_t* data, size_t size);   nonblocking; <= 0 when none
+//   bool connected();                       false once the peer has closed
+//   uint32_t millis();
+//   void wait(uint32_t timeout_ms);         until readable, closed or timed
+//                                           out; may return early
+//
+// Unlike the UART receivers this is not interrupt-fed: producer and
+// consumer are both the caller's thread.
+template<typename Socket, size_t SIZE>
+class SocketReceiver {
+public:
+    static const uint32_t forever = 0xFFFFFFFF;
+
+    explicit SocketReceiver(Socket& socket) : socket(socket) {}
+
+    // Moves everything the socket holds now into the ring, a span at a time;
+    // returns the bytes stored. What does not fit stays in the socket.
+    size_t fill() {
+        size_t stored = 0;
+
+        while (true) {
+            char* span;
+            size_t space = ring.writeSpan(span);
+            if (space == 0) {
+                break;
+            }
+
+            int pending = socket.available();
+            if (pending <= 0) {
+                break;
+            }
+
+            size_t want = static_cast<size_t>(pending) < space ? static_cast<size_t>(pending) : space;
+            int n = socket.read(reinterpret_cast<uint8_t*>(span), want);
+            if (n <= 0) {
+                break;
+            }
+
+            ring.commit(n);
+            stored += n;
+        }
+
+        return stored;
+    }
+
+    // Whatever has arrived, up to size, without waiting. Once the ring is
+    // empty the rest is read from the socket straight into data.
+    size_t read(char* data, size_t size) {
+        size_t n = ring.get(data, size);
+
+        while (n < size) {
+            int pending = socket.available();
+            if (pending <= 0) {
+                break;
+            }
+
+            int got = socket.read(reinterpret_cast<uint8_t*>(data + n), size - n);
+            if (got <= 0) {
+                break;
+            }
+            n += got;
+        }
+
+        return n;
+    }
+
+    // Up to size bytes, waiting until they have all arrived, the peer has
+    // closed, or timeout_ms has passed (forever never passes)
+    size_t read(char* data, size_t size, uint32_t timeout_ms) {
+        uint32_t start = socket.millis();
+        size_t n = 0;
+
+        while (true) {
+            n += read(data + n, size - n);
+            if (n == size || !socket.connected()) {
+                break;
+            }
+
+            uint32_t elapsed = socket.millis() - start;
+            if (timeout_ms != forever && elapsed >= timeout_ms) {
+                break;
+            }
+
+            socket.wait(timeout_ms == forever ? forever : timeout_ms - elapsed);
+        }
+
+        return n;
+    }
+
+    // -1 when nothing has arrived, otherwise the byte as 0-255
+    int tryReadOne() {
+        char c;
+        if (!ring.get(c)) {
+            fill();
+            if (!ring.get(c)) {
+                return -1;
+            }
+        }
+        return static_cast<unsigned char>(c);
+    }
+
+    bool available() {
+        return !ring.empty() || socket.available() > 0;
+    }
+
+    // Bytes in the ring
+    size_t count() const {
+        return ring.count();
+    }
+
+    // Forget what is buffered, e.g. when reconnecting
+    void clear() {
+        ring.clear();
+    }
+
+private:
+    Socket& socket;
+    InterruptSafeRingBuffer<char, SIZE> ring;
+};
+
+#endif // SOCKET_RECEIVER_H
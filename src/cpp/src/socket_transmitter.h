@@ -0,0 +1,165 @@
+// socket_transmitter.h
+// Transmit path for stream sockets: keeps what the socket has not taken yet
+// in a ring and retries it, instead of dropping the tail of a short write.
+
+#ifndef SOCKET_TRANSMITTER_H
+#define SOCKET_TRANSMITTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ring_buffer.h"
+
+// Socket is the same as for socket_receiver.h, plus its send half:
+//
+//   size_t write(const uint8_t* data, size_t size);   nonblocking; what the
+//                                                     stack took, maybe 0
+//                                                     (a blocking write
+//                                                     would stall poll()
+//                                                     and hide backpressure)
+//   void waitWritable(uint32_t timeout_ms);           until it can take more,
+//                                                     closed or timed out
+//
+// Small writes can be coalesced: with setCoalescing(min_bytes, max_delay_ms)
+// bytes are held until min_bytes are queued or the oldest has waited
+// max_delay_ms, and then go out as one segment. Pair that with the socket's
+// no-delay option so the stack does not add Nagle's wait on top.
+template<typename Socket, size_t SIZE>
+class SocketTransmitter {
+public:
+    static const uint32_t forever = 0xFFFFFFFF;
+
+    explicit SocketTransmitter(Socket& socket) : socket(socket) {}
+
+    void setCoalescing(size_t min_bytes, uint32_t max_delay_ms) {
+        coalesce_bytes = min_bytes;
+        coalesce_delay_ms = max_delay_ms;
+    }
+
+    // Queues what fits and sends what is due; returns the bytes accepted,
+    // fewer than size when the ring is full
+    size_t write(const char* data, size_t size) {
+        if (ring.empty()) {
+            oldest_ms = socket.millis();
+        }
+
+        size_t n = ring.put(data, size);
+        poll();
+        return n;
+    }
+
+    // Sends what is due, as far as the socket takes it; returns bytes sent
+    size_t poll() {
+        if (ring.empty() || !due()) {
+            return 0;
+        }
+        return send();
+    }
+
+    // Sends everything queued, coalesced or not, waiting while the socket
+    // is backed up. False when the deadline passed or the socket closed
+    // with bytes still queued.
+    bool flush(uint32_t timeout_ms = forever) {
+        uint32_t start = socket.millis();
+
+        while (!ring.empty()) {
+            if (send() > 0) {
+                continue;
+            }
+
+            if (!socket.connected()) {
+                return false;
+            }
+
+            uint32_t elapsed = socket.millis() - start;
+            if (timeout_ms != forever && elapsed >= timeout_ms) {
+                return false;
+            }
+
+            socket.waitWritable(timeout_ms == forever ? forever : timeout_ms - elapsed);
+        }
+
+        return true;
+    }
+
+    // Waits until the ring has room for size bytes (or as many as it can
+    // ever hold); false on timeout or close
+    bool waitForRoom(size_t size, uint32_t timeout_ms = forever) {
+        size_t wanted = size < SIZE - 1 ? size : SIZE - 1;
+        uint32_t start = socket.millis();
+
+        while (ring.free() < wanted) {
+            if (send() > 0) {
+                continue;
+            }
+
+            if (!socket.connected()) {
+                return false;
+            }
+
+            uint32_t elapsed = socket.millis() - start;
+            if (timeout_ms != forever && elapsed >= timeout_ms) {
+                return false;
+            }
+
+            socket.waitWritable(timeout_ms == forever ? forever : timeout_ms - elapsed);
+        }
+
+        return true;
+    }
+
+    // Room left in the ring
+    size_t availableForWrite() const {
+        return ring.free();
+    }
+
+    // Bytes queued but not yet taken by the socket
+    size_t pending() const {
+        return ring.count();
+    }
+
+    // Forget what is queued, e.g. when reconnecting
+    void clear() {
+        ring.clear();
+    }
+
+private:
+    Socket& socket;
+    InterruptSafeRingBuffer<char, SIZE> ring;
+    size_t coalesce_bytes = 0;
+    uint32_t coalesce_delay_ms = 0;
+    uint32_t oldest_ms = 0;
+
+    bool due() {
+        return ring.count() >= coalesce_bytes ||
+               socket.millis() - oldest_ms >= coalesce_delay_ms;
+    }
+
+    // One or two spans, until the socket takes less than it was offered
+    size_t send() {
+        size_t sent = 0;
+
+        while (true) {
+            const char* span;
+            size_t length = ring.readSpan(span);
+            if (length == 0) {
+                break;
+            }
+
+            size_t n = socket.write(reinterpret_cast<const uint8_t*>(span), length);
+            if (n == 0) {
+                break;
+            }
+
+            ring.consume(n);
+            sent += n;
+            if (n < length) {
+                break;
+            }
+        }
+
+        return sent;
+    }
+};
+
+#endif // SOCKET_TRANSMITTER_H
@@ -0,0 +1,139 @@
+// spsc_queue.h
+// A lock-free single producer / single consumer queue for non-trivial types.
+// InterruptSafeRingBuffer copies through volatile storage, which only works
+// for plain values; this queue moves objects in and out instead.
+//
+// It suits structured records handed from an ISR to the main loop, such as
+// the frame descriptors of frame_receiver.h: emplace() builds the record in
+// its slot, and drain() lets the consumer handle a batch in place and
+// release all their slots with a single index store.
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+#include "ring_buffer.h"
+
+template<typename T, size_t SIZE>
+class SpscQueue {
+    static_assert((SIZE & (SIZE - 1)) == 0, "Size must be power of 2");
+
+private:
+    alignas(T) unsigned char storage[SIZE * sizeof(T)];
+    volatile size_t head = 0;  // Written by producer
+    volatile size_t tail = 0;  // Written by consumer
+
+    T* slot(size_t index) {
+        return reinterpret_cast<T*>(storage + index * sizeof(T));
+    }
+
+public:
+    SpscQueue() = default;
+
+    ~SpscQueue() {
+        drain([](T&) {});
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer interface. On failure item is left untouched.
+    bool push(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    bool push(const T& item) {
+        return emplace(item);
+    }
+
+    // Constructs the item in its slot; false, constructing nothing, when full
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        size_t h = head;
+        size_t next_head = (h + 1) & (SIZE - 1);
+
+        if (next_head == tail) {
+            return false;  // Queue full
+        }
+        RING_BUFFER_ACQUIRE();
+
+        new (slot(h)) T(std::forward<Args>(args)...);
+        RING_BUFFER_RELEASE();
+        head = next_head;
+        return true;
+    }
+
+    // Consumer interface
+    bool pop(T& item) {
+        size_t t = tail;
+
+        if (head == t) {
+            return false;  // Queue empty
+        }
+        RING_BUFFER_ACQUIRE();
+
+        T* p = slot(t);
+        item = std::move(*p);
+        p->~T();
+        RING_BUFFER_RELEASE();
+        tail = (t + 1) & (SIZE - 1);
+        return true;
+    }
+
+    // Consumer: calls handle(T&) on up to max items, oldest first, then
+    // destroys them and frees their slots at once. Items pushed meanwhile
+    // wait for the next call. Returns the number handled.
+    template<typename F>
+    size_t drain(F&& handle, size_t max = SIZE) {
+        size_t t = tail;
+        size_t n = (head - t) & (SIZE - 1);
+        if (n > max) {
+            n = max;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        RING_BUFFER_ACQUIRE();
+
+        for (size_t i = 0; i < n; i++) {
+            T* p = slot((t + i) & (SIZE - 1));
+            handle(*p);
+            p->~T();
+        }
+        RING_BUFFER_RELEASE();
+        tail = (t + n) & (SIZE - 1);
+        return n;
+    }
+
+    // Consumer only: the oldest item, or nullptr when empty
+    T* front() {
+        if (head == tail) {
+            return nullptr;
+        }
+        RING_BUFFER_ACQUIRE();
+        return slot(tail);
+    }
+
+    bool empty() const {
+        return head == tail;
+    }
+
+    bool full() const {
+        return ((head + 1) & (SIZE - 1)) == tail;
+    }
+
+    size_t count() const {
+        size_t h = head;
+        size_t t = tail;
+        return (h - t) & (SIZE - 1);
+    }
+
+    static constexpr size_t capacity() {
+        return SIZE - 1;
+    }
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,94 @@
+// static_vector.h
+// A vector with its capacity fixed at compile time and its elements stored
+// inline, for reads that must not touch the heap.
+
+#ifndef STATIC_VECTOR_H
+#define STATIC_VECTOR_H
+
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+#ifndef TRANSMISSION_NO_HEAP
+#include <vector>
+#endif
+
+// Only for trivially copyable T, which covers the byte buffers the
+// connections hand out. Growing past N is not an error: push_back() and
+// resize() stop at capacity and say so.
+//
+// Outside TRANSMISSION_NO_HEAP it converts to std::vector, so code written
+// against the older read() that returned one still builds, paying for the
+// copy where it is made.
+template<typename T, size_t N>
+class StaticVector {
+    static_assert(std::is_trivially_copyable<T>::value, "StaticVector holds plain values only");
+
+public:
+    StaticVector() = default;
+
+    StaticVector(const T* data, size_t size) {
+        assign(data, size);
+    }
+
+    T* data() { return items; }
+    const T* data() const { return items; }
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool full() const { return length == N; }
+    static constexpr size_t capacity() { return N; }
+
+    T* begin() { return items; }
+    T* end() { return items + length; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + length; }
+
+    T& operator[](size_t index) { return items[index]; }
+    const T& operator[](size_t index) const { return items[index]; }
+
+    void clear() {
+        length = 0;
+    }
+
+    // False, and unchanged, when full
+    bool push_back(const T& item) {
+        if (length == N) {
+            return false;
+        }
+        items[length++] = item;
+        return true;
+    }
+
+    // Clamped to capacity; returns the new size. New elements are left
+    // as they were, for filling through data().
+    size_t resize(size_t size) {
+        length = size < N ? size : N;
+        return length;
+    }
+
+    // Copies in what fits; returns the count
+    size_t assign(const T* data, size_t size) {
+        length = 0;
+        return append(data, size);
+    }
+
+    size_t append(const T* data, size_t size) {
+        size_t n = N - length < size ? N - length : size;
+        memcpy(items + length, data, n * sizeof(T));
+        length += n;
+        return n;
+    }
+
+#ifndef TRANSMISSION_NO_HEAP
+    operator std::vector<T>() const {
+        return std::vector<T>(begin(), end());
+    }
+#endif
+
+private:
+    T items[N];
+    size_t length = 0;
+};
+
+#endif // STATIC_VECTOR_H
@@ -7,5 +7,9 @@
 
 #include "Connection.h"
 #include "Pipe.h"
+#include "MessagePipe.h"
+#include "EscapeTokenizer.h"
+#include "SerialConfig.h"
+#include "UartConnection.h"
 
 #endif //TRANSMISSION_TRANSMISSION_CPP_H
\ No newline at end of file
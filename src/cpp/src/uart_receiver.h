@@ -0,0 +1,202 @@
+// uart_receiver.h
+// Batched UART receive path: moves everything a UART driver has buffered
+// into a flow-controlled ring in bulk, instead of one driver call per byte.
+
+#ifndef UART_RECEIVER_H
+#define UART_RECEIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "ring_buffer.h"
+
+// Uart is a policy over the board's driver with static members, so the
+// calls inline into the ISR or driver task. A hardware FIFO is read a byte
+// at a time:
+//
+//   static bool readable();                    RX FIFO not empty
+//   static char getc();
+//   static void putc(char c);                  blocking; used for XON/XOFF
+//
+// A driver that buffers in software (ESP-IDF) can instead be emptied in
+// bulk, which service() prefers when the policy has it:
+//
+//   static size_t buffered();                  bytes the driver holds now
+//   static size_t read(char* data, size_t n);  nonblocking bulk read
+//
+// A link that pushes back on the sender by itself when its driver is full,
+// like USB CDC with its NAKs, declares
+//
+//   static const bool backpressure = true;
+//
+// and what the ring cannot take then stays in the driver instead of being
+// dropped.
+//
+// Pair it with a driver set to interrupt at an RX FIFO threshold and after
+// an RX idle timeout (see SerialConfig): a burst then arrives as a handful
+// of service() calls, each of which empties the driver into the ring's
+// contiguous free space in one read, or two when the span wraps.
+template<typename Uart, typename = void>
+struct UartHasBulkRead : std::false_type {};
+
+template<typename Uart>
+struct UartHasBulkRead<Uart, decltype(void(Uart::buffered()))> : std::true_type {};
+
+template<typename Uart, typename = void>
+struct UartHasBackpressure : std::false_type {};
+
+template<typename Uart>
+struct UartHasBackpressure<Uart, decltype(void(Uart::backpressure))> : std::integral_constant<bool, Uart::backpressure> {};
+
+template<typename Uart, size_t SIZE>
+class UartReceiver {
+public:
+    static constexpr char XON  = 0x11;
+    static constexpr char XOFF = 0x13;
+
+    UartReceiver(uint8_t high_percent = 75, uint8_t low_percent = 25)
+        : ring(high_percent, low_percent) {}
+
+    // Producer interface (ISR or driver task). Returns the bytes stored.
+    size_t service() {
+        size_t stored;
+        if constexpr (UartHasBulkRead<Uart>::value) {
+            stored = serviceBulk();
+        } else {
+            stored = serviceFifo();
+        }
+
+        if (xon_xoff && !paused && ring.shouldSendXOFF()) {
+            Uart::putc(XOFF);
+            paused = true;
+        }
+
+        return stored;
+    }
+
+    // Consumer interface (main loop)
+    size_t read(char* data, size_t size) {
+        size_t n = ring.get(data, size);
+        resumeIfDrained();
+        return n;
+    }
+
+    // -1 when empty, otherwise the byte as 0-255
+    int tryReadOne() {
+        char c;
+        if (!ring.get(c)) {
+            return -1;
+        }
+        resumeIfDrained();
+        return static_cast<unsigned char>(c);
+    }
+
+    bool available() const {
+        return ring.available();
+    }
+
+    size_t count() const {
+        return ring.count();
+    }
+
+    void setXonXoff(bool enable) {
+        xon_xoff = enable;
+    }
+
+    bool xonXoff() const {
+        return xon_xoff;
+    }
+
+    bool isPaused() const {
+        return paused;
+    }
+
+    // Bytes thrown away because the ring was full
+    uint32_t droppedBytes() const {
+        return dropped_bytes;
+    }
+
+private:
+    FlowControlRingBuffer<char, SIZE> ring;
+    volatile bool xon_xoff = false;
+    volatile bool paused = false;
+    volatile uint32_t dropped_bytes = 0;
+
+    size_t serviceBulk() {
+        size_t stored = 0;
+        size_t pending = Uart::buffered();
+
+        while (pending > 0) {
+            char* span;
+            size_t space = ring.writeSpan(span);
+
+            if (space == 0) {
+                if constexpr (UartHasBackpressure<Uart>::value) {
+                    break;
+                }
+
+                // Ring full: drop what the driver holds rather than let its
+                // own buffer overflow, and keep count
+                char scratch[32];
+                size_t n = Uart::read(scratch, pending < sizeof(scratch) ? pending : sizeof(scratch));
+                if (n == 0) {
+                    break;
+                }
+                dropped_bytes = dropped_bytes + n;
+                pending -= n;
+                continue;
+            }
+
+            size_t n = Uart::read(span, pending < space ? pending : space);
+            if (n == 0) {
+                break;
+            }
+            ring.commit(n);
+            stored += n;
+            pending -= n;
+
+            if (pending == 0) {
+                // More may have landed while we copied
+                pending = Uart::buffered();
+            }
+        }
+
+        return stored;
+    }
+
+    size_t serviceFifo() {
+        size_t stored = 0;
+
+        while (Uart::readable()) {
+            char* span;
+            size_t space = ring.writeSpan(span);
+
+            if (space == 0) {
+                Uart::getc();
+                dropped_bytes = dropped_bytes + 1;
+                continue;
+            }
+
+            // Fill the span straight from the FIFO, one commit per span
+            size_t n = 0;
+            do {
+                span[n++] = Uart::getc();
+            } while (n < space && Uart::readable());
+
+            ring.commit(n);
+            stored += n;
+        }
+
+        return stored;
+    }
+
+    void resumeIfDrained() {
+        if (paused && xon_xoff && ring.shouldSendXON()) {
+            Uart::putc(XON);
+            paused = false;
+        }
+    }
+};
+
+#endif // UART_RECEIVER_H
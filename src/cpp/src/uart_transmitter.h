@@ -0,0 +1,156 @@
+// uart_transmitter.h
+// Interrupt-driven UART transmit path: write() copies into a ring and
+// returns, and the TX interrupt refills the hardware FIFO from it.
+
+#ifndef UART_TRANSMITTER_H
+#define UART_TRANSMITTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "ring_buffer.h"
+
+// Uart is the same policy as for uart_receiver.h. Buffering writes needs
+// the TX FIFO and its interrupt:
+//
+//   static bool writable();                    TX FIFO has room
+//   static void setTxInterrupt(bool enable);   FIFO at or below its level
+//
+// The interrupt should fire as the FIFO drains past its level, and should
+// be safe to assume edge triggered: like the RP2040's PL011, it need not
+// fire when enabled over an already empty FIFO. write() therefore primes
+// the FIFO itself and only then enables the interrupt.
+//
+// A policy whose putc() can run while the TX interrupt is refilling the
+// FIFO (XON/XOFF from the main loop) must make its check-and-write atomic.
+template<typename Uart, typename = void>
+struct UartHasTxInterrupt : std::false_type {};
+
+template<typename Uart>
+struct UartHasTxInterrupt<Uart, decltype(void(Uart::setTxInterrupt(true)), void(Uart::writable()))> : std::true_type {};
+
+template<typename Uart, typename = void>
+struct UartHasBulkWrite : std::false_type {};
+
+template<typename Uart>
+struct UartHasBulkWrite<Uart, decltype(void(Uart::write(static_cast<const char*>(nullptr), size_t(0))))> : std::true_type {};
+
+template<typename Uart, size_t SIZE>
+class UartTransmitter {
+    static_assert(UartHasTxInterrupt<Uart>::value, "A TX ring needs a Uart policy with writable() and setTxInterrupt()");
+
+public:
+    // Main loop: queues what fits and returns the count, without waiting
+    size_t write(const char* data, size_t size) {
+        size_t n = ring.put(data, size);
+        kick();
+
+        if (n < size) {
+            // The FIFO may have just taken some off the ring
+            n += ring.put(data + n, size - n);
+            if (!active) {
+                kick();
+            }
+        }
+
+        return n;
+    }
+
+    // Main loop: with the ring full, hands its oldest byte to the UART,
+    // waiting in putc() for the FIFO like an unbuffered write would
+    void waitForRoom() {
+        Uart::setTxInterrupt(false);
+        active = false;
+
+        char c;
+        if (ring.full() && ring.get(c)) {
+            Uart::putc(c);
+        }
+
+        kick();
+    }
+
+    // Main loop: waits until the whole ring has been handed to the UART
+    void drain() {
+        Uart::setTxInterrupt(false);
+        active = false;
+
+        char c;
+        while (ring.get(c)) {
+            Uart::putc(c);
+        }
+    }
+
+    // Main loop: bytes not yet handed to the FIFO
+    size_t pending() const {
+        return ring.count();
+    }
+
+    // TX interrupt
+    void service() {
+        if (!active) {
+            return;
+        }
+
+        fill();
+
+        if (ring.empty()) {
+            Uart::setTxInterrupt(false);
+            active = false;
+        }
+    }
+
+    // Main loop: moves what the FIFO can take right now and arms the
+    // interrupt for the rest. The interrupt is masked first so that only
+    // one side ever consumes the ring.
+    void kick() {
+        Uart::setTxInterrupt(false);
+        active = false;
+
+        fill();
+
+        if (!ring.empty()) {
+            active = true;
+            Uart::setTxInterrupt(true);
+        }
+    }
+
+private:
+    InterruptSafeRingBuffer<char, SIZE> ring;
+    volatile bool active = false;
+
+    void fill() {
+        char c;
+        while (Uart::writable() && ring.get(c)) {
+            Uart::putc(c);
+        }
+    }
+};
+
+// Without a ring, writes go straight to the driver and block until it has
+// taken them all
+template<typename Uart>
+class UartTransmitter<Uart, 0> {
+public:
+    size_t write(const char* data, size_t size) {
+        if constexpr (UartHasBulkWrite<Uart>::value) {
+            Uart::write(data, size);
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                Uart::putc(data[i]);
+            }
+        }
+        return size;
+    }
+
+    size_t pending() const {
+        return 0;
+    }
+
+    void waitForRoom() {}
+    void drain() {}
+    void service() {}
+};
+
+#endif // UART_TRANSMITTER_H
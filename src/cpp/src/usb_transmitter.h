@@ -0,0 +1,98 @@
+// usb_transmitter.h
+// Packet-aligned transmit path for USB CDC: hands the stack whole bulk
+// packets and holds back a partial one until it fills or a short timer
+// runs out.
+
+#ifndef USB_TRANSMITTER_H
+#define USB_TRANSMITTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// A CDC write that is not a multiple of the endpoint's packet size ends
+// its transfer with a short packet, and a stream of small writes becomes a
+// stream of short packets, one per frame or microframe. Staging up to one
+// packet keeps every packet full while data keeps coming, and the timer
+// bounds how long the tail waits when it stops.
+//
+// Usb is a policy over the board's USB serial with static members:
+//
+//   static size_t write(const char* data, size_t size);   blocking
+//   static void flush();                   send a partial packet now
+//   static uint32_t micros();
+template<typename Usb, size_t PACKET = 64>
+class UsbTransmitter {
+public:
+    static const size_t packetSize = PACKET;
+
+    // How long a partial packet may wait for more bytes
+    void setFlushDelay(uint32_t delay_us) {
+        flush_delay_us = delay_us;
+    }
+
+    void write(const char* data, size_t size) {
+        while (size > 0) {
+            // Whole packets go straight from the caller's buffer
+            if (staged == 0 && size >= PACKET) {
+                size_t n = size - size % PACKET;
+                Usb::write(data, n);
+                unflushed = true;
+                data += n;
+                size -= n;
+                continue;
+            }
+
+            if (staged == 0) {
+                staged_at = Usb::micros();
+            }
+
+            size_t n = PACKET - staged < size ? PACKET - staged : size;
+            memcpy(stage + staged, data, n);
+            staged += n;
+            data += n;
+            size -= n;
+
+            if (staged == PACKET) {
+                Usb::write(stage, PACKET);
+                unflushed = true;
+                staged = 0;
+            }
+        }
+    }
+
+    // Sends a partial packet once it has waited out the flush delay
+    void poll() {
+        if (staged > 0 && Usb::micros() - staged_at >= flush_delay_us) {
+            flush();
+        }
+    }
+
+    // A no-op when nothing has been handed to the stack since the last one
+    void flush() {
+        if (staged == 0 && !unflushed) {
+            return;
+        }
+
+        if (staged > 0) {
+            Usb::write(stage, staged);
+            staged = 0;
+        }
+        Usb::flush();
+        unflushed = false;
+    }
+
+    // Bytes held back in a partial packet
+    size_t pending() const {
+        return staged;
+    }
+
+private:
+    char stage[PACKET];
+    size_t staged = 0;
+    bool unflushed = false;   // written to the stack since the last flush
+    uint32_t staged_at = 0;
+    uint32_t flush_delay_us = 1000;
+};
+
+#endif // USB_TRANSMITTER_H
@@ -0,0 +1,141 @@
+#include "Esp32Uart.h"
+#include <Arduino.h>
+#include <driver/uart.h>
+
+// ESP32-S3 specific configuration
+static const int UART1_TX_PIN = 17;  // Adjust for your hardware
+static const int UART1_RX_PIN = 18;  // Adjust for your hardware
+
+template<int PORT>
+QueueHandle_t Esp32Uart<PORT>::uart_queue = nullptr;
+
+template<int PORT>
+void (*Esp32Uart<PORT>::data_handler)() = nullptr;
+
+// ESP32-S3 uses task-based UART handling instead of direct ISR
+template<int PORT>
+static void uart_event_task(void*) {
+    const uart_port_t port = static_cast<uart_port_t>(PORT);
+    uart_event_t event;
+
+    while (true) {
+        if (xQueueReceive(Esp32Uart<PORT>::uart_queue, (void*)&event, portMAX_DELAY)) {
+            switch (event.type) {
+                case UART_DATA:
+                    // Everything the driver holds, in one or two reads
+                    if (Esp32Uart<PORT>::data_handler) {
+                        Esp32Uart<PORT>::data_handler();
+                    }
+                    break;
+
+                case UART_FIFO_OVF:
+                    uart_flush_input(port);
+                    xQueueReset(Esp32Uart<PORT>::uart_queue);
+                    break;
+
+                case UART_BUFFER_FULL:
+                    uart_flush_input(port);
+                    xQueueReset(Esp32Uart<PORT>::uart_queue);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+template<int PORT>
+void Esp32Uart<PORT>::begin(const SerialConfig& config, void (*handler)()) {
+    const uart_port_t port = static_cast<uart_port_t>(PORT);
+    data_handler = handler;
+
+    uart_config_t uart_config = {};
+    uart_config.baud_rate = config.baud_rate;
+    uart_config.data_bits = static_cast<uart_word_length_t>(UART_DATA_5_BITS + (config.data_bits - 5));
+    uart_config.stop_bits = config.stop_bits == 2 ? UART_STOP_BITS_2 : UART_STOP_BITS_1;
+
+    switch (config.parity) {
+        case SerialConfig::Parity::even: uart_config.parity = UART_PARITY_EVEN; break;
+        case SerialConfig::Parity::odd: uart_config.parity = UART_PARITY_ODD; break;
+        default: uart_config.parity = UART_PARITY_DISABLE; break;
+    }
+
+    // RTS drops once the 128 byte RX FIFO holds this many bytes
+    uart_config.flow_ctrl = config.hardware_flow_control ? UART_HW_FLOWCTRL_CTS_RTS : UART_HW_FLOWCTRL_DISABLE;
+    uart_config.rx_flow_ctrl_thresh = 122;
+    uart_config.source_clk = UART_SCLK_DEFAULT;
+
+    int tx_pin = config.tx_pin >= 0 ? config.tx_pin : (PORT == 1 ? UART1_TX_PIN : UART_PIN_NO_CHANGE);
+    int rx_pin = config.rx_pin >= 0 ? config.rx_pin : (PORT == 1 ? UART1_RX_PIN : UART_PIN_NO_CHANGE);
+    int rts_pin = config.rts_pin >= 0 ? config.rts_pin : UART_PIN_NO_CHANGE;
+    int cts_pin = config.cts_pin >= 0 ? config.cts_pin : UART_PIN_NO_CHANGE;
+
+    // Install UART driver with event queue
+    uart_driver_install(port, TRANSMISSION_ESP32_UART_DRIVER_SIZE, TRANSMISSION_ESP32_UART_DRIVER_SIZE, 20, &uart_queue, 0);
+    uart_param_config(port, &uart_config);
+    uart_set_pin(port, tx_pin, rx_pin, rts_pin, cts_pin);
+
+    // Batch RX events: one per threshold's worth of a burst, plus one when
+    // the line goes idle, instead of one per byte. The driver rejects a
+    // threshold that fills the whole FIFO, which would leave the default
+    // of one event per byte in place.
+    int rx_threshold = config.rx_fifo_threshold > 0 ? config.rx_fifo_threshold : defaultRxThreshold;
+    if (rx_threshold > UART_FIFO_LEN - 1) {
+        rx_threshold = UART_FIFO_LEN - 1;
+    }
+    esp_err_t err = uart_set_rx_full_threshold(port, rx_threshold);
+    if (err != ESP_OK) {
+        log_e("UART%d: rx threshold %d rejected: %s", PORT, rx_threshold, esp_err_to_name(err));
+    }
+    uart_set_rx_timeout(port, config.rx_idle_timeout > 0 ? config.rx_idle_timeout : defaultRxIdleTimeout);
+
+    // Create high-priority UART event handling task, one per port
+    xTaskCreate(uart_event_task<PORT>, "uart_event_task", 4096, NULL, 12, NULL);
+
+    // Wait for initialization
+    delay(10);
+}
+
+template<int PORT>
+bool Esp32Uart<PORT>::readable() {
+    return buffered() > 0;
+}
+
+template<int PORT>
+char Esp32Uart<PORT>::getc() {
+    char c = 0;
+    uart_read_bytes(uart_port_t(PORT), &c, 1, 0);
+    return c;
+}
+
+template<int PORT>
+size_t Esp32Uart<PORT>::buffered() {
+    size_t length = 0;
+    uart_get_buffered_data_len(uart_port_t(PORT), &length);
+    return length;
+}
+
+template<int PORT>
+size_t Esp32Uart<PORT>::read(char* data, size_t size) {
+    int n = uart_read_bytes(uart_port_t(PORT), data, size, 0);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+template<int PORT>
+void Esp32Uart<PORT>::putc(char c) {
+    uart_write_bytes(uart_port_t(PORT), &c, 1);
+}
+
+template<int PORT>
+void Esp32Uart<PORT>::write(const char* data, size_t size) {
+    uart_write_bytes(uart_port_t(PORT), data, size);
+}
+
+template struct Esp32Uart<0>;
+template struct Esp32Uart<1>;
+#if SOC_UART_NUM > 2
+template struct Esp32Uart<2>;
+#endif
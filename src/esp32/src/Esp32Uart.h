@@ -0,0 +1,57 @@
+#ifndef _ESP32_UART_H_
+#define _ESP32_UART_H_
+
+#include <SerialConfig.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// UartConnection policy over ESP-IDF's driver for UART_NUM_0 + PORT. The
+// driver buffers RX in software and reports it on an event queue; a task
+// per port drains that queue and calls the connection's handler once per
+// UART_DATA event, which then empties the driver in bulk. Ports run side by
+// side, each with its own driver buffers, task and handler:
+//
+//   UartConnection<Esp32Uart1, 4096> first;
+//   UartConnection<Esp32Uart2, 4096> second;
+//
+// The driver's own RX and TX buffers come from the heap, this many bytes
+// each per port, on top of the connection's ring.
+#ifndef TRANSMISSION_ESP32_UART_DRIVER_SIZE
+#define TRANSMISSION_ESP32_UART_DRIVER_SIZE 4096
+#endif
+
+template<int PORT>
+struct Esp32Uart
+{
+    static const bool interruptDriven = true;
+
+    // Defaults for SerialConfig's rx_fifo_threshold and rx_idle_timeout:
+    // a burst wakes the event task every 64 bytes, and its tail 2
+    // character times after the line goes quiet. A threshold past the
+    // RX FIFO is clamped to UART_FIFO_LEN - 1.
+    static const uint8_t defaultRxThreshold = 64;
+    static const uint8_t defaultRxIdleTimeout = 2;
+
+    static QueueHandle_t uart_queue;
+    static void (*data_handler)();
+
+    // TX/RX default to GPIO 17/18 on UART1. Other pins of -1, and every pin
+    // on the other ports, stay wherever the GPIO matrix already routes them.
+    static void begin(const SerialConfig& config, void (*handler)());
+
+    static bool readable();
+    static char getc();
+    static size_t buffered();
+    static size_t read(char* data, size_t size);
+    static void putc(char c);
+    static void write(const char* data, size_t size);
+};
+
+using Esp32Uart0 = Esp32Uart<0>;
+using Esp32Uart1 = Esp32Uart<1>;
+using Esp32Uart2 = Esp32Uart<2>;
+
+#endif
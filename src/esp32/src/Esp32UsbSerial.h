@@ -0,0 +1,44 @@
+#ifndef _ESP32_USB_SERIAL_H_
+#define _ESP32_USB_SERIAL_H_
+
+#include <Arduino.h>
+
+// UsbCdcConnection policy over the ESP32's USB Serial (USB-OTG CDC or the
+// S3/C3 USB-Serial-JTAG). USB NAKs the host while the driver's buffer is
+// full, so nothing needs dropping. Waiting reads sleep a tick so the idle
+// task, and its watchdog, still run.
+struct Esp32UsbSerial
+{
+    static const bool backpressure = true;
+
+    static size_t buffered() {
+        int n = Serial.available();
+        return n > 0 ? n : 0;
+    }
+
+    static size_t read(char* data, size_t size) {
+        return Serial.readBytes(data, size);
+    }
+
+    static void putc(char c) {
+        Serial.write(static_cast<uint8_t>(c));
+    }
+
+    static size_t write(const char* data, size_t size) {
+        return Serial.write(reinterpret_cast<const uint8_t*>(data), size);
+    }
+
+    static void flush() {
+        Serial.flush();
+    }
+
+    static uint32_t micros() {
+        return ::micros();
+    }
+
+    static void idle() {
+        delay(1);
+    }
+};
+
+#endif
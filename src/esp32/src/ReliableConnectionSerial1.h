@@ -1,49 +1,32 @@
 #ifndef _RELIABLE_CONNECTION_SERIAL1_H_
 #define _RELIABLE_CONNECTION_SERIAL1_H_
 
-#include <Connection.h>
+#include <UartConnection.h>
 
-#include <ring_buffer.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "Esp32Uart.h"
 
-class ReliableConnectionSerial1 : public Connection
-{
-  public:
-    static const char XON  = 0x11;
-    static const char XOFF = 0x13;
+// Sizes for this build, overridable with -D (e.g. platformio.ini build_flags).
+// The ring must be a power of two; for other ports or several sizes at
+// once, use UartConnection<Esp32Uart2, RX, 0, READ> directly.
+#ifndef TRANSMISSION_SERIAL1_RX_SIZE
+#define TRANSMISSION_SERIAL1_RX_SIZE 4096
+#endif
 
-    static const int maxBufferSize = 4096;
-    static const int maxReadSize = 32;
+#ifndef TRANSMISSION_SERIAL1_READ_SIZE
+#define TRANSMISSION_SERIAL1_READ_SIZE 128
+#endif
 
-				static QueueHandle_t uart_queue;
+class ReliableConnectionSerial1 : public UartConnection<Esp32Uart1, TRANSMISSION_SERIAL1_RX_SIZE, 0, TRANSMISSION_SERIAL1_READ_SIZE>
+{
+  public:
+    static const int maxBufferSize = TRANSMISSION_SERIAL1_RX_SIZE;
 
     static ReliableConnectionSerial1* instance;
 
     static ReliableConnectionSerial1* getInstance();
-    static void uart0_handler();
 
-				ReliableConnectionSerial1();
+    ReliableConnectionSerial1();
     ~ReliableConnectionSerial1() {}
-
-    void begin();
-				void enableXonXoff();
-    void disableXonXoff();
-
-    // Connection
-    int tryReadOne();
-    char readOne();
-    std::vector<char> read();
-    std::vector<char> read(int size);
-    void write(std::vector<char> bs);
-				bool availableForReading();
-    // end Connection
-
-	private:
-		bool xonXoffEnabled = false;
-		FlowControlRingBuffer<char, maxBufferSize> ring;
-		volatile bool paused = false;
-		volatile bool buffer_full = false;
 };
 
-#endif
\ No newline at end of file
+#endif
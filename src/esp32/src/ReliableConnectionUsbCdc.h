@@ -5,45 +5,33 @@
 #ifndef EDEN_RELIABLECONNECTIONUSBCDC_H
 #define EDEN_RELIABLECONNECTIONUSBCDC_H
 
-#include <Connection.h>
+#include <UsbCdcConnection.h>
 
-#include <ring_buffer.h>
 #include <onda.h>
 
-class ReliableConnectionUsbCdc : public Connection
-{
-  public:
-    static const char XON  = 0x11;
-    static const char XOFF = 0x13;
+#include "Esp32UsbSerial.h"
+
+// Set like the Serial1 sizes (see ReliableConnectionSerial1.h).
+// The ring must be a power of two.
+#ifndef TRANSMISSION_USB_CDC_RX_SIZE
+#define TRANSMISSION_USB_CDC_RX_SIZE 4096
+#endif
 
-    static const int maxBufferSize = 4096;
-    static const int maxReadSize = 32;
+#ifndef TRANSMISSION_USB_CDC_READ_SIZE
+#define TRANSMISSION_USB_CDC_READ_SIZE 512
+#endif
 
-    static void uart0_handler();
+class ReliableConnectionUsbCdc : public UsbCdcConnection<Esp32UsbSerial, TRANSMISSION_USB_CDC_RX_SIZE, TRANSMISSION_USB_CDC_READ_SIZE>
+{
+  public:
+    static const int maxBufferSize = TRANSMISSION_USB_CDC_RX_SIZE;
 
-	static Logger* logger;
+    // Unused since the bulk path stopped logging every byte; kept so
+    // sketches that set it still build
+    static Logger* logger;
 
-    ReliableConnectionUsbCdc();
+    ReliableConnectionUsbCdc() {}
     ~ReliableConnectionUsbCdc() {}
-
-    void begin();
-    void enableXonXoff();
-    void disableXonXoff();
-
-    // Connection
-    int tryReadOne();
-    char readOne();
-    std::vector<char> read();
-    std::vector<char> read(int size);
-    void write(std::vector<char> bs);
-    bool availableForReading();
-    // end Connection
-
-  private:
-    bool xonXoffEnabled = false;
-    FlowControlRingBuffer<char, maxBufferSize> ring;
-    volatile bool paused = false;
-    volatile bool buffer_full = false;
 };
 
-#endif //EDEN_RELIABLECONNECTIONUSBCDC_H
\ No newline at end of file
+#endif //EDEN_RELIABLECONNECTIONUSBCDC_H
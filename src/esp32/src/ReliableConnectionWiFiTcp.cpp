@@ -9,7 +9,8 @@
 Logger* ReliableConnectionWiFiTcp::logger = nullptr;
 
 ReliableConnectionWiFiTcp::ReliableConnectionWiFiTcp(const char* host, uint16_t port)
-    : host(host), port(port), connected(false)
+    : host(host), port(port), socket(client), receiver(socket), transmitter(socket),
+      connected(false), no_delay(true), read_timeout_ms(SocketReceiver<WiFiClientSocket, maxBufferSize>::forever)
 {
 }
 
@@ -61,6 +62,9 @@ bool ReliableConnectionWiFiTcp::connectToHost()
         return false;
     }
 
+    client.setNoDelay(no_delay);
+    receiver.clear();
+    transmitter.clear();
     connected = true;
     if (logger) { logger->info("TCP connected"); }
     return true;
@@ -81,109 +85,119 @@ bool ReliableConnectionWiFiTcp::isConnected()
     return connected && client.connected();
 }
 
-void ReliableConnectionWiFiTcp::fillRingBuffer()
+void ReliableConnectionWiFiTcp::setReadTimeout(uint32_t timeout_ms)
 {
-    // Fill ring buffer from WiFi client
-    while (client.available() > 0 && !ring.full())
+    read_timeout_ms = timeout_ms;
+}
+
+size_t ReliableConnectionWiFiTcp::read(char* data, size_t size)
+{
+    if (!connected)
     {
-        int byte = client.read();
-        if (byte >= 0)
-        {
-            if (logger) { logger->debugf("+0x%02X (%zu)", byte, ring.count() + 1); }
-            if (!ring.put(static_cast<char>(byte)))
-            {
-                if (logger) { logger->debug("Ring buffer full"); }
-                break;
-            }
-        }
+        return 0;
     }
+
+    transmitter.poll();
+    return receiver.read(data, size);
 }
 
-int ReliableConnectionWiFiTcp::tryReadOne()
+size_t ReliableConnectionWiFiTcp::write(const char* data, size_t size)
 {
-    if (!isConnected())
+    if (!connected)
     {
-        return -1;
+        return 0;
     }
 
-    // First check ring buffer
-    char c;
-    if (ring.get(c))
+    return transmitter.write(data, size);
+}
+
+size_t ReliableConnectionWiFiTcp::availableForWrite()
+{
+    return transmitter.availableForWrite();
+}
+
+void ReliableConnectionWiFiTcp::poll()
+{
+    if (connected)
     {
-        return static_cast<unsigned char>(c);
+        transmitter.poll();
     }
+}
 
-    // Try to fill from network
-    fillRingBuffer();
+bool ReliableConnectionWiFiTcp::flush(uint32_t timeout_ms)
+{
+    return connected && transmitter.flush(timeout_ms);
+}
+
+void ReliableConnectionWiFiTcp::setCoalescing(size_t min_bytes, uint32_t max_delay_ms)
+{
+    transmitter.setCoalescing(min_bytes, max_delay_ms);
+}
 
-    // Try ring buffer again
-    if (ring.get(c))
+void ReliableConnectionWiFiTcp::setNoDelay(bool enable)
+{
+    no_delay = enable;
+    if (connected)
     {
-        return static_cast<unsigned char>(c);
+        client.setNoDelay(enable);
+    }
+}
+
+int ReliableConnectionWiFiTcp::tryReadOne()
+{
+    if (!connected)
+    {
+        return -1;
     }
 
-    return -1;
+    transmitter.poll();
+    return receiver.tryReadOne();
 }
 
 char ReliableConnectionWiFiTcp::readOne()
 {
-    if (!isConnected())
+    if (!connected)
     {
         if (logger) { logger->error("Not connected in readOne()"); }
         return 0;
     }
 
-    if (logger) { logger->debugf("readOne()"); }
+    transmitter.poll();
 
     char c;
-    while (true)
+    if (receiver.read(&c, 1, SocketReceiver<WiFiClientSocket, maxBufferSize>::forever) == 1)
     {
-        // Try to fill ring buffer from network
-        fillRingBuffer();
-
-        // Check ring buffer
-        if (ring.get(c))
-        {
-            if (logger) { logger->debugf("-0x%02X (%zu)", static_cast<unsigned char>(c), ring.count()); }
-            return c;
-        }
-
-        // Check connection status
-        if (!isConnected())
-        {
-            if (logger) { logger->error("Connection lost in readOne()"); }
-            return 0;
-        }
-
-        // Small delay to avoid busy-waiting
-        delay(1);
+        return c;
     }
+
+    if (logger) { logger->error("Connection lost in readOne()"); }
+    return 0;
 }
 
 std::vector<char> ReliableConnectionWiFiTcp::read(int size)
 {
     std::vector<char> results;
-    results.reserve(size);
 
-    if (!isConnected())
+    if (!connected)
     {
         if (logger) { logger->error("Not connected in read()"); }
         return results;
     }
 
-    if (logger) { logger->debugf("read(%d)", size); }
-
-    // Block until we have 'size' bytes
-    while (results.size() < static_cast<size_t>(size))
+    if (size <= 0)
     {
-        char c = readOne();
-        results.push_back(c);
+        return results;
+    }
 
-        if (!isConnected())
-        {
-            if (logger) { logger->debug("Connection lost during read()"); }
-            break;
-        }
+    transmitter.poll();
+
+    // Wait for 'size' bytes, copied out of the ring and socket in spans
+    results.resize(size);
+    results.resize(receiver.read(results.data(), results.size(), read_timeout_ms));
+
+    if (logger && results.size() < static_cast<size_t>(size))
+    {
+        logger->debugf("read(%d) returned %zu bytes", size, results.size());
     }
 
     return results;
@@ -197,23 +211,27 @@ void ReliableConnectionWiFiTcp::write(std::vector<char> bs)
         return;
     }
 
-    if (!bs.empty())
+    // Wait for room rather than drop what the stack could not take yet
+    size_t written = 0;
+    while (written < bs.size())
     {
-        size_t written = client.write(reinterpret_cast<const uint8_t*>(bs.data()), bs.size());
+        written += transmitter.write(bs.data() + written, bs.size() - written);
 
-        if (logger && written != bs.size())
+        if (written < bs.size() && !transmitter.waitForRoom(bs.size() - written))
         {
-            logger->debugf("Partial write: %zu/%zu bytes", written, bs.size());
+            if (logger) { logger->error("Connection lost in write()"); }
+            return;
         }
     }
 }
 
 bool ReliableConnectionWiFiTcp::availableForReading()
 {
-    if (!isConnected())
+    if (!connected)
     {
         return false;
     }
 
-    return (ring.count() > 0) || (client.available() > 0);
+    transmitter.poll();
+    return receiver.available();
 }
\ No newline at end of file
@@ -6,15 +6,34 @@
 #define TRANSMISSION_CONNECTIONWIFITCP_H
 
 #include <Connection.h>
-#include <ring_buffer.h>
+#include <socket_receiver.h>
+#include <socket_transmitter.h>
 #include <onda.h>
 #include <WiFi.h>
 
+#include "WiFiClientSocket.h"
+
+// Sizes for this build, overridable with -D (e.g. platformio.ini build_flags).
+// Larger than the UART defaults for WiFi bandwidth; rings must be powers
+// of two.
+#ifndef TRANSMISSION_WIFI_RX_SIZE
+#define TRANSMISSION_WIFI_RX_SIZE 8192
+#endif
+
+#ifndef TRANSMISSION_WIFI_TX_SIZE
+#define TRANSMISSION_WIFI_TX_SIZE 8192
+#endif
+
+#ifndef TRANSMISSION_WIFI_READ_SIZE
+#define TRANSMISSION_WIFI_READ_SIZE 1024
+#endif
+
 class ReliableConnectionWiFiTcp : public Connection
 {
   public:
-    static const int maxBufferSize = 8192;  // Larger for WiFi bandwidth
-    static const int maxReadSize = 1024;
+    static const int maxBufferSize = TRANSMISSION_WIFI_RX_SIZE;
+    static const int maxWriteBufferSize = TRANSMISSION_WIFI_TX_SIZE;
+    static const int maxReadSize = TRANSMISSION_WIFI_READ_SIZE;
 
     static Logger* logger;
 
@@ -26,21 +45,46 @@ class ReliableConnectionWiFiTcp : public Connection
     void disconnect();
     bool isConnected();
 
+    // How long read(size) waits for all size bytes; forever by default
+    void setReadTimeout(uint32_t timeout_ms);
+
+    // Whatever has arrived, up to size, without waiting
+    size_t read(char* data, size_t size);
+
+    // Queues what fits in the TX ring and returns the count; fewer than
+    // size means the link is backed up. Unsent bytes are retried by poll()
+    // and by every later read or write.
+    size_t write(const char* data, size_t size);
+    size_t availableForWrite();
+    void poll();
+    // Sends everything queued; false on timeout or disconnect
+    bool flush(uint32_t timeout_ms = SocketTransmitter<WiFiClientSocket, maxWriteBufferSize>::forever);
+
+    // Hold small writes until min_bytes are queued or the oldest has waited
+    // max_delay_ms; (0, 0) sends at once
+    void setCoalescing(size_t min_bytes, uint32_t max_delay_ms);
+    // TCP_NODELAY; on by default, and reapplied by connectToHost()
+    void setNoDelay(bool enable);
+
+    using Connection::write;
+
     // Connection interface
     int tryReadOne() override;
     char readOne() override;
-    std::vector<char> read(int size) override;
-    void write(std::vector<char> bs) override;
+    TRANSMISSION_ALLOCATES std::vector<char> read(int size) override;
+    TRANSMISSION_ALLOCATES void write(std::vector<char> bs) override;
     bool availableForReading() override;
 
   private:
     const char* host;
     uint16_t port;
     WiFiClient client;
-    InterruptSafeRingBuffer<char, maxBufferSize> ring;
+    WiFiClientSocket socket;
+    SocketReceiver<WiFiClientSocket, maxBufferSize> receiver;
+    SocketTransmitter<WiFiClientSocket, maxWriteBufferSize> transmitter;
     bool connected;
-
-    void fillRingBuffer();
+    bool no_delay;
+    uint32_t read_timeout_ms;
 };
 
 #endif //TRANSMISSION_CONNECTIONWIFITCP_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef TRANSMISSION_WIFICLIENTSOCKET_H
+#define TRANSMISSION_WIFICLIENTSOCKET_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+
+// The Socket side of socket_receiver.h and socket_transmitter.h over a
+// WiFiClient. Waits sleep in lwIP's select() on the client's descriptor, so
+// a blocked read or write wakes as soon as it can go on instead of on the
+// next 1 ms tick.
+class WiFiClientSocket
+{
+  public:
+    explicit WiFiClientSocket(WiFiClient& client) : client(client) {}
+
+    int available() {
+      return client.available();
+    }
+
+    int read(uint8_t* data, size_t size) {
+      return client.read(data, size);
+    }
+
+    bool connected() {
+      return client.connected();
+    }
+
+    uint32_t millis() {
+      return ::millis();
+    }
+
+    void wait(uint32_t timeout_ms) {
+      select(timeout_ms, false);
+    }
+
+    // WiFiClient::write() retries until lwIP has taken everything, which
+    // would stall poll() and every read behind a full send buffer. Hand
+    // lwIP what it takes now instead; the transmitter keeps the rest.
+    size_t write(const uint8_t* data, size_t size) {
+      int fd = client.fd();
+      if (fd < 0) {
+        return 0;
+      }
+
+      ssize_t n = lwip_send(fd, data, size, MSG_DONTWAIT);
+      if (n >= 0) {
+        return n;
+      }
+
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        // As WiFiClient::write() does, so connected() reports it
+        client.stop();
+      }
+      return 0;
+    }
+
+    void waitWritable(uint32_t timeout_ms) {
+      select(timeout_ms, true);
+    }
+
+  private:
+    WiFiClient& client;
+
+    void select(uint32_t timeout_ms, bool writable) {
+      int fd = client.fd();
+      if (fd < 0) {
+        delay(1);
+        return;
+      }
+
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(fd, &set);
+
+      struct timeval timeout;
+      timeout.tv_sec = timeout_ms / 1000;
+      timeout.tv_usec = (timeout_ms % 1000) * 1000;
+      lwip_select(fd + 1, writable ? nullptr : &set, writable ? &set : nullptr, nullptr, &timeout);
+    }
+};
+
+#endif //TRANSMISSION_WIFICLIENTSOCKET_H
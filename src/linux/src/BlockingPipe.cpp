@@ -0,0 +1,221 @@
+#include "BlockingPipe.h"
+
+static std::chrono::steady_clock::time_point deadlineFor(std::chrono::nanoseconds timeout)
+{
+    if (timeout == BlockingPipeEnd::forever) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+// Wait on cv until predicate holds or the deadline passes
+template<typename Predicate>
+static bool waitUntil(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                      std::chrono::steady_clock::time_point deadline, Predicate predicate)
+{
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+        cv.wait(lock, predicate);
+        return true;
+    }
+
+    return cv.wait_until(lock, deadline, predicate);
+}
+
+// BlockingPipeChannel implementation
+size_t BlockingPipeChannel::write(const char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    size_t total = 0;
+    auto deadline = deadlineFor(timeout);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (total < length && !closed) {
+        size_t n = ring.put(data + total, length - total);
+        if (n > 0) {
+            total += n;
+            readable.notify_one();
+            continue;
+        }
+
+        if (timeout.count() == 0) {
+            break;
+        }
+
+        if (!waitUntil(writable, lock, deadline, [this] { return closed || !ring.full(); })) {
+            break; // Timed out with the ring still full
+        }
+    }
+
+    return total;
+}
+
+size_t BlockingPipeChannel::read(char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    if (length == 0) {
+        return 0;
+    }
+
+    auto deadline = deadlineFor(timeout);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (ring.empty() && timeout.count() != 0) {
+        waitUntil(readable, lock, deadline, [this] { return closed || !ring.empty(); });
+    }
+
+    size_t n = ring.get(data, length);
+    if (n > 0) {
+        writable.notify_one();
+    }
+
+    return n;
+}
+
+size_t BlockingPipeChannel::available()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ring.count();
+}
+
+size_t BlockingPipeChannel::space()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ring.free();
+}
+
+void BlockingPipeChannel::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+
+    readable.notify_all();
+    writable.notify_all();
+}
+
+bool BlockingPipeChannel::isClosed()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed;
+}
+
+// BlockingPipeEnd implementation
+constexpr std::chrono::nanoseconds BlockingPipeEnd::forever;
+
+BlockingPipeEnd::BlockingPipeEnd(BlockingPipeChannel& read_channel, BlockingPipeChannel& write_channel)
+    : read_channel(read_channel), write_channel(write_channel)
+{
+}
+
+int BlockingPipeEnd::tryReadOne()
+{
+    char c;
+    if (read_channel.read(&c, 1, std::chrono::nanoseconds::zero()) == 1) {
+        return static_cast<unsigned char>(c);
+    }
+    return -1;
+}
+
+char BlockingPipeEnd::readOne()
+{
+    char c = 0;
+    readOne(c, forever);
+    return c; // 0 if the pipe was closed
+}
+
+bool BlockingPipeEnd::readOne(char& c, std::chrono::nanoseconds timeout)
+{
+    return read_channel.read(&c, 1, timeout) == 1;
+}
+
+std::vector<char> BlockingPipeEnd::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+
+    size_t total = 0;
+    while (total < results.size()) {
+        size_t n = read_channel.read(results.data() + total, results.size() - total, forever);
+        if (n == 0) {
+            break; // Closed
+        }
+        total += n;
+    }
+
+    results.resize(total);
+    return results;
+}
+
+std::vector<char> BlockingPipeEnd::read(int size, std::chrono::nanoseconds timeout)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    results.resize(read(results.data(), results.size(), timeout));
+    return results;
+}
+
+size_t BlockingPipeEnd::read(char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    return read_channel.read(data, length, timeout);
+}
+
+void BlockingPipeEnd::write(std::vector<char> bs)
+{
+    write_channel.write(bs.data(), bs.size(), forever);
+}
+
+size_t BlockingPipeEnd::write(const char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    return write_channel.write(data, length, timeout);
+}
+
+bool BlockingPipeEnd::availableForReading()
+{
+    return read_channel.available() > 0;
+}
+
+size_t BlockingPipeEnd::available()
+{
+    return read_channel.available();
+}
+
+size_t BlockingPipeEnd::writeSpace()
+{
+    return write_channel.space();
+}
+
+void BlockingPipeEnd::close()
+{
+    read_channel.close();
+    write_channel.close();
+}
+
+bool BlockingPipeEnd::isClosed()
+{
+    return read_channel.isClosed();
+}
+
+// BlockingPipe implementation
+BlockingPipe::BlockingPipe()
+    : end_a(std::make_unique<BlockingPipeEnd>(channel_b_to_a, channel_a_to_b)),
+      end_b(std::make_unique<BlockingPipeEnd>(channel_a_to_b, channel_b_to_a))
+{
+}
+
+BlockingPipeEnd& BlockingPipe::getEndA()
+{
+    return *end_a;
+}
+
+BlockingPipeEnd& BlockingPipe::getEndB()
+{
+    return *end_b;
+}
@@ -0,0 +1,97 @@
+#ifndef _BLOCKING_PIPE_H_
+#define _BLOCKING_PIPE_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+// One direction of a BlockingPipe. Readers and writers sleep on condition
+// variables instead of polling, and are woken as soon as the other side
+// makes progress or the pipe is closed.
+class BlockingPipeChannel
+{
+    public:
+        static const int bufferSize = TRANSMISSION_PIPE_SIZE;
+
+        // Copy up to length bytes in, waiting at most timeout for room.
+        // Returns the number of bytes accepted, which is short on timeout or close.
+        size_t write(const char* data, size_t length, std::chrono::nanoseconds timeout);
+
+        // Wait at most timeout for at least one byte, then copy out up to
+        // length bytes. Returns 0 on timeout or once closed and drained.
+        size_t read(char* data, size_t length, std::chrono::nanoseconds timeout);
+
+        size_t available();
+        size_t space();
+        void close();
+        bool isClosed();
+
+    private:
+        InterruptSafeRingBuffer<char, bufferSize> ring;
+        std::mutex mutex;
+        std::condition_variable readable;
+        std::condition_variable writable;
+        bool closed = false;
+};
+
+class BlockingPipeEnd : public Connection
+{
+    public:
+        static constexpr std::chrono::nanoseconds forever = std::chrono::nanoseconds::max();
+
+        BlockingPipeEnd(BlockingPipeChannel& read_channel, BlockingPipeChannel& write_channel);
+
+        using Connection::write;
+
+        // Connection interface. readOne() and read(size) block until the
+        // requested bytes arrive or the pipe is closed; write() blocks until
+        // every byte has been accepted or the pipe is closed.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        // Timed variants. A zero timeout never blocks.
+        bool readOne(char& c, std::chrono::nanoseconds timeout);
+        std::vector<char> read(int size, std::chrono::nanoseconds timeout);
+        size_t read(char* data, size_t length, std::chrono::nanoseconds timeout);
+        size_t write(const char* data, size_t length, std::chrono::nanoseconds timeout);
+
+        size_t available();
+        size_t writeSpace();
+
+        // Close both directions, waking every blocked reader and writer
+        void close();
+        bool isClosed();
+
+    private:
+        BlockingPipeChannel& read_channel;
+        BlockingPipeChannel& write_channel;
+};
+
+class BlockingPipe
+{
+    public:
+        BlockingPipe();
+
+        BlockingPipeEnd& getEndA();
+        BlockingPipeEnd& getEndB();
+
+        BlockingPipe(const BlockingPipe&) = delete;
+        BlockingPipe& operator=(const BlockingPipe&) = delete;
+
+    private:
+        BlockingPipeChannel channel_a_to_b;
+        BlockingPipeChannel channel_b_to_a;
+
+        std::unique_ptr<BlockingPipeEnd> end_a;
+        std::unique_ptr<BlockingPipeEnd> end_b;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "CaptureConnection.h"
+
+CaptureConnection::CaptureConnection(Connection& inner, CaptureFile& capture)
+    : inner(inner), capture(capture)
+{
+}
+
+int CaptureConnection::tryReadOne()
+{
+    int b = inner.tryReadOne();
+    if (b >= 0) {
+        char c = static_cast<char>(b);
+        capture.append(CaptureFile::Direction::rx, &c, 1);
+    }
+    return b;
+}
+
+char CaptureConnection::readOne()
+{
+    // The wrapped readOne() returns 0 for a NUL and for no data alike, so
+    // it would record bytes that never arrived
+    int b = tryReadOne();
+    return b < 0 ? 0 : static_cast<char>(b);
+}
+
+std::vector<char> CaptureConnection::read(int size)
+{
+    std::vector<char> results = inner.read(size);
+    capture.append(CaptureFile::Direction::rx, results.data(), results.size());
+    return results;
+}
+
+void CaptureConnection::write(std::vector<char> bs)
+{
+    capture.append(CaptureFile::Direction::tx, bs.data(), bs.size());
+    inner.write(std::move(bs));
+}
+
+bool CaptureConnection::availableForReading()
+{
+    return inner.availableForReading();
+}
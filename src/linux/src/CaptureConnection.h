@@ -0,0 +1,30 @@
+#ifndef _CAPTURE_CONNECTION_H_
+#define _CAPTURE_CONNECTION_H_
+
+#include <Connection.h>
+#include "CaptureFile.h"
+
+// Connection decorator that records every chunk read from or written to the
+// wrapped connection. Bytes pass through unchanged.
+class CaptureConnection : public Connection
+{
+    public:
+        CaptureConnection(Connection& inner, CaptureFile& capture);
+
+        using Connection::write;
+
+        // Connection interface. readOne() never waits, whatever the wrapped
+        // connection does: it returns 0, and records nothing, when no byte
+        // has arrived.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+    private:
+        Connection& inner;
+        CaptureFile& capture;
+};
+
+#endif
@@ -0,0 +1,294 @@
+#include "CaptureFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <errno.h>
+
+static uint64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t realtimeNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+CaptureFile::CaptureFile(const std::string& path)
+    : path(path), fd(-1), writable(false), map(nullptr), map_size(0), used(0),
+      read_offset(0), start_steady_ns(0)
+{
+}
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+bool CaptureFile::openForWriting()
+{
+    close();
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open capture " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    writable = true;
+    if (!remap(initialMapSize)) {
+        close();
+        return false;
+    }
+
+    FileHeader header = {};
+    header.magic = magic;
+    header.version = version;
+    header.start_realtime_ns = realtimeNowNs();
+    header.used = sizeof(FileHeader);
+    memcpy(map, &header, sizeof(header));
+
+    used = sizeof(FileHeader);
+    start_steady_ns = steadyNowNs();
+
+    return true;
+}
+
+bool CaptureFile::openForReading()
+{
+    close();
+
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open capture " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        std::cerr << "Capture " << path << " is too short" << std::endl;
+        close();
+        return false;
+    }
+
+    writable = false;
+    if (!remap(static_cast<size_t>(st.st_size))) {
+        close();
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(&header, map, sizeof(header));
+    if (header.magic != magic || header.version != version) {
+        std::cerr << "Capture " << path << " has an unknown format" << std::endl;
+        close();
+        return false;
+    }
+
+    used = header.used <= map_size ? header.used : map_size;
+    read_offset = sizeof(FileHeader);
+
+    return true;
+}
+
+void CaptureFile::close()
+{
+    if (map) {
+        if (writable) {
+            syncHeader();
+        }
+        munmap(map, map_size);
+        map = nullptr;
+        map_size = 0;
+    }
+
+    if (fd >= 0) {
+        // Drop the unused tail of the last growth step
+        if (writable && ftruncate(fd, used) != 0) {
+            std::cerr << "Failed to truncate capture: " << strerror(errno) << std::endl;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+
+    writable = false;
+    used = 0;
+    read_offset = 0;
+}
+
+bool CaptureFile::remap(size_t new_size)
+{
+    if (map) {
+        munmap(map, map_size);
+        map = nullptr;
+        map_size = 0;
+    }
+
+    if (writable && ftruncate(fd, new_size) != 0) {
+        std::cerr << "Failed to grow capture: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* mapped = mmap(nullptr, new_size, prot, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map capture: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    map = static_cast<char*>(mapped);
+    map_size = new_size;
+    return true;
+}
+
+void CaptureFile::syncHeader()
+{
+    uint64_t used_bytes = used;
+    memcpy(map + offsetof(FileHeader, used), &used_bytes, sizeof(used_bytes));
+}
+
+bool CaptureFile::append(Direction direction, const char* data, size_t length)
+{
+    if (length == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(append_mutex);
+
+    if (!writable || !map) {
+        return false;
+    }
+
+    size_t needed = used + sizeof(RecordHeader) + length;
+    if (needed > map_size) {
+        size_t new_size = map_size;
+        while (new_size < needed) {
+            new_size *= 2;
+        }
+        if (!remap(new_size)) {
+            return false;
+        }
+    }
+
+    RecordHeader record = {};
+    record.timestamp_ns = steadyNowNs() - start_steady_ns;
+    record.length = static_cast<uint32_t>(length);
+    record.direction = static_cast<uint8_t>(direction);
+
+    memcpy(map + used, &record, sizeof(record));
+    memcpy(map + used + sizeof(record), data, length);
+    used = needed;
+
+    // Publish the new length last so a reader of a crashed capture never
+    // sees a half-written record
+    syncHeader();
+
+    return true;
+}
+
+bool CaptureFile::next(Record& record)
+{
+    if (!map || read_offset + sizeof(RecordHeader) > used) {
+        return false;
+    }
+
+    RecordHeader header;
+    memcpy(&header, map + read_offset, sizeof(header));
+
+    size_t payload_offset = read_offset + sizeof(RecordHeader);
+    if (payload_offset + header.length > used) {
+        return false; // Truncated record
+    }
+
+    record.timestamp_ns = header.timestamp_ns;
+    record.direction = static_cast<Direction>(header.direction);
+    record.data = map + payload_offset;
+    record.length = header.length;
+
+    read_offset = payload_offset + header.length;
+    return true;
+}
+
+void CaptureFile::rewind()
+{
+    read_offset = sizeof(FileHeader);
+}
+
+uint64_t CaptureFile::startTimeNs() const
+{
+    if (!map) {
+        return 0;
+    }
+
+    uint64_t start;
+    memcpy(&start, map + offsetof(FileHeader, start_realtime_ns), sizeof(start));
+    return start;
+}
+
+size_t CaptureFile::size() const
+{
+    return used;
+}
+
+bool CaptureFile::exportPcap(const std::string& pcap_path)
+{
+    if (!map) {
+        return false;
+    }
+
+    FILE* out = fopen(pcap_path.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Failed to open " << pcap_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct {
+        uint32_t magic_number;
+        uint16_t version_major;
+        uint16_t version_minor;
+        int32_t thiszone;
+        uint32_t sigfigs;
+        uint32_t snaplen;
+        uint32_t network;
+    } global_header = {0xa1b23c4d, 2, 4, 0, 0, pcapSnapLength, 147}; // Nanosecond pcap, LINKTYPE_USER0
+
+    fwrite(&global_header, sizeof(global_header), 1, out);
+
+    uint64_t start = startTimeNs();
+    size_t saved_offset = read_offset;
+    rewind();
+
+    Record record;
+    while (next(record)) {
+        uint64_t ts = start + record.timestamp_ns;
+
+        // The direction byte leads each packet's data
+        uint64_t original = static_cast<uint64_t>(record.length) + 1;
+        uint32_t included = original < pcapSnapLength ? static_cast<uint32_t>(original) : pcapSnapLength;
+        uint32_t packet_header[4] = {
+            static_cast<uint32_t>(ts / 1000000000ULL),
+            static_cast<uint32_t>(ts % 1000000000ULL),
+            included,
+            static_cast<uint32_t>(original < UINT32_MAX ? original : UINT32_MAX)
+        };
+        uint8_t direction = static_cast<uint8_t>(record.direction);
+
+        fwrite(packet_header, sizeof(packet_header), 1, out);
+        fwrite(&direction, 1, 1, out);
+        fwrite(record.data, 1, included - 1, out);
+    }
+
+    read_offset = saved_offset;
+
+    bool ok = ferror(out) == 0;
+    fclose(out);
+    return ok;
+}
@@ -0,0 +1,91 @@
+#ifndef _CAPTURE_FILE_H_
+#define _CAPTURE_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Append-only, memory-mapped log of timestamped RX/TX chunks.
+//
+// Layout: a fixed header followed by records, each a RecordHeader and its
+// payload. The header keeps the number of bytes in use, so a capture that
+// was never closed cleanly can still be read up to the last whole record.
+class CaptureFile
+{
+    public:
+        enum class Direction : uint8_t {
+            rx = 0,
+            tx = 1
+        };
+
+        struct Record {
+            uint64_t timestamp_ns; // Nanoseconds since the capture started
+            Direction direction;
+            const char* data;      // Points into the mapping, valid until close()
+            uint32_t length;
+        };
+
+        static constexpr uint32_t magic = 0x50435854; // "TXCP"
+        static constexpr uint32_t version = 1;
+
+        explicit CaptureFile(const std::string& path);
+        ~CaptureFile();
+
+        CaptureFile(const CaptureFile&) = delete;
+        CaptureFile& operator=(const CaptureFile&) = delete;
+
+        bool openForWriting();
+        bool openForReading();
+        void close();
+
+        // Writer interface, safe to call from several threads
+        bool append(Direction direction, const char* data, size_t length);
+
+        // Reader interface
+        bool next(Record& record);
+        void rewind();
+
+        // Write the capture as a pcap file with LINKTYPE_USER0. Each packet
+        // is one record, prefixed by a single direction byte (0 = RX, 1 = TX).
+        bool exportPcap(const std::string& pcap_path);
+
+        uint64_t startTimeNs() const;
+        size_t size() const;
+
+    private:
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t start_realtime_ns;
+            uint64_t used;
+        };
+
+        struct RecordHeader {
+            uint64_t timestamp_ns;
+            uint32_t length;
+            uint8_t direction;
+            uint8_t reserved[3];
+        };
+
+        static const size_t initialMapSize = 1 << 20;
+
+        // pcap readers reject packets longer than the header's snaplen, so
+        // longer records are cut to it; orig_len keeps the true size
+        static const uint32_t pcapSnapLength = 0x40000;
+
+        std::string path;
+        int fd;
+        bool writable;
+        char* map;
+        size_t map_size;
+        size_t used;
+        size_t read_offset;
+        uint64_t start_steady_ns;
+        std::mutex append_mutex;
+
+        bool remap(size_t new_size);
+        void syncHeader();
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "CaptureReplayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+static uint64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CaptureReplayer::CaptureReplayer(CaptureFile& capture, PipeEnd& sink,
+                                 CaptureFile::Direction direction, double speed)
+    : capture(capture), sink(sink), direction(direction), speed(speed), pending(),
+      has_pending(false), pending_offset(0), done(false), started(false), start_ns(0),
+      bytes_replayed(0)
+{
+    capture.rewind();
+}
+
+void CaptureReplayer::setSpeed(double new_speed)
+{
+    speed = new_speed;
+}
+
+void CaptureReplayer::restart()
+{
+    capture.rewind();
+    has_pending = false;
+    pending_offset = 0;
+    done = false;
+    started = false;
+    bytes_replayed = 0;
+}
+
+bool CaptureReplayer::finished() const
+{
+    return done;
+}
+
+uint64_t CaptureReplayer::bytesReplayed() const
+{
+    return bytes_replayed;
+}
+
+bool CaptureReplayer::loadNext()
+{
+    CaptureFile::Record record;
+    while (capture.next(record)) {
+        if (record.direction == direction && record.length > 0) {
+            pending = record;
+            pending_offset = 0;
+            has_pending = true;
+            return true;
+        }
+    }
+
+    done = true;
+    return false;
+}
+
+uint64_t CaptureReplayer::elapsedNs() const
+{
+    return steadyNowNs() - start_ns;
+}
+
+bool CaptureReplayer::poll()
+{
+    if (done) {
+        return false;
+    }
+
+    if (!started) {
+        start_ns = steadyNowNs();
+        started = true;
+    }
+
+    while (has_pending || loadNext()) {
+        if (speed > 0.0) {
+            uint64_t due_ns = static_cast<uint64_t>(pending.timestamp_ns / speed);
+            if (due_ns > elapsedNs()) {
+                return true; // Not due yet
+            }
+        }
+
+        // PipeEnd::write drops whatever does not fit, so only offer what will
+        size_t space = sink.writeSpace();
+        if (space == 0) {
+            return true;
+        }
+
+        size_t remaining = pending.length - pending_offset;
+        size_t n = std::min(space, remaining);
+        const char* begin = pending.data + pending_offset;
+        sink.write(std::vector<char>(begin, begin + n));
+
+        pending_offset += static_cast<uint32_t>(n);
+        bytes_replayed += n;
+
+        if (pending_offset < pending.length) {
+            return true; // Pipe full, resume this chunk next time
+        }
+
+        has_pending = false;
+    }
+
+    return false;
+}
+
+void CaptureReplayer::run()
+{
+    while (poll()) {
+        if (has_pending && speed > 0.0) {
+            uint64_t due_ns = static_cast<uint64_t>(pending.timestamp_ns / speed);
+            uint64_t now_ns = elapsedNs();
+            if (due_ns > now_ns) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(due_ns - now_ns));
+                continue;
+            }
+        }
+
+        // Waiting on the reader to make room
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef _CAPTURE_REPLAYER_H_
+#define _CAPTURE_REPLAYER_H_
+
+#include <Pipe.h>
+#include "CaptureFile.h"
+
+#include <cstdint>
+
+// Feeds the chunks of one direction of a capture into a PipeEnd, so the
+// code under test can read them from the other end as if they came off the
+// original device.
+class CaptureReplayer
+{
+    public:
+        static constexpr double asFastAsPossible = 0.0;
+        static constexpr double originalSpeed = 1.0;
+
+        // speed scales the recorded timing: 1.0 replays at the original pace,
+        // 10.0 ten times faster, asFastAsPossible ignores timestamps entirely.
+        CaptureReplayer(CaptureFile& capture, PipeEnd& sink,
+                        CaptureFile::Direction direction = CaptureFile::Direction::rx,
+                        double speed = originalSpeed);
+
+        void setSpeed(double speed);
+
+        // Push whatever is due into the pipe without blocking. Chunks that do
+        // not fit are resumed on the next call. Returns false once the whole
+        // capture has been delivered.
+        bool poll();
+
+        // Replay the whole capture, waiting for timestamps and pipe space.
+        // The reader must drain the other end from another thread.
+        void run();
+
+        void restart();
+        bool finished() const;
+        uint64_t bytesReplayed() const;
+
+    private:
+        CaptureFile& capture;
+        PipeEnd& sink;
+        CaptureFile::Direction direction;
+        double speed;
+
+        CaptureFile::Record pending;
+        bool has_pending;
+        uint32_t pending_offset;
+        bool done;
+        bool started;
+        uint64_t start_ns;
+        uint64_t bytes_replayed;
+
+        bool loadNext();
+        uint64_t elapsedNs() const;
+};
+
+#endif
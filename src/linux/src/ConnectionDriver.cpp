@@ -0,0 +1,112 @@
+#include "ConnectionDriver.h"
+
+#include <algorithm>
+#include <iostream>
+
+ConnectionDriver::ConnectionDriver(Backend preferred)
+    : preferred(preferred), active(Backend::epoll)
+{
+}
+
+ConnectionDriver::~ConnectionDriver()
+{
+    end();
+}
+
+bool ConnectionDriver::begin()
+{
+    if (preferred == Backend::ioUring && IoUringLoop::available() && uring.begin()) {
+        active = Backend::ioUring;
+        return true;
+    }
+
+    if (preferred == Backend::ioUring) {
+        std::cerr << "io_uring unavailable, falling back to epoll" << std::endl;
+    }
+
+    active = Backend::epoll;
+    return epoll.begin();
+}
+
+void ConnectionDriver::end()
+{
+    // Connections cancel their operations against the loop, so go first
+    connections.clear();
+
+    uring.end();
+    epoll.end();
+}
+
+ConnectionDriver::Backend ConnectionDriver::backend() const
+{
+    return active;
+}
+
+Connection* ConnectionDriver::attach(int fd, Callback on_read, Callback on_close)
+{
+    if (active == Backend::ioUring) {
+        auto connection = std::make_unique<IoUringConnection>(uring, fd);
+        if (on_read) {
+            connection->setReadCallback([on_read](IoUringConnection& c) { on_read(c); });
+        }
+        if (on_close) {
+            connection->setCloseCallback([on_close](IoUringConnection& c) { on_close(c); });
+        }
+        if (!connection->begin()) {
+            return nullptr;
+        }
+
+        connections.push_back(std::move(connection));
+        return connections.back().get();
+    }
+
+    auto connection = std::make_unique<FdConnection>(epoll, fd);
+    if (on_read) {
+        connection->setReadCallback([on_read](FdConnection& c) { on_read(c); });
+    }
+    if (on_close) {
+        connection->setCloseCallback([on_close](FdConnection& c) { on_close(c); });
+    }
+    if (!connection->begin()) {
+        return nullptr;
+    }
+
+    connections.push_back(std::move(connection));
+    return connections.back().get();
+}
+
+void ConnectionDriver::detach(Connection* connection)
+{
+    auto it = std::find_if(connections.begin(), connections.end(),
+                           [connection](const std::unique_ptr<Connection>& c) { return c.get() == connection; });
+    if (it != connections.end()) {
+        connections.erase(it);
+    }
+}
+
+int ConnectionDriver::runOnce(int timeout_ms)
+{
+    if (active == Backend::ioUring) {
+        return uring.runOnce(timeout_ms);
+    }
+
+    return epoll.runOnce(timeout_ms);
+}
+
+void ConnectionDriver::run()
+{
+    if (active == Backend::ioUring) {
+        uring.run();
+    } else {
+        epoll.run();
+    }
+}
+
+void ConnectionDriver::stop()
+{
+    if (active == Backend::ioUring) {
+        uring.stop();
+    } else {
+        epoll.stop();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef _CONNECTION_DRIVER_H_
+#define _CONNECTION_DRIVER_H_
+
+#include <Connection.h>
+#include "EventLoop.h"
+#include "FdConnection.h"
+#include "IoUringLoop.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Runs many fd connections on one thread with io_uring when the kernel
+// allows it, otherwise with EventLoop and FdConnection. Callers see plain
+// Connections either way.
+class ConnectionDriver
+{
+    public:
+        enum class Backend { ioUring, epoll };
+
+        using Callback = std::function<void(Connection&)>;
+
+        explicit ConnectionDriver(Backend preferred = Backend::ioUring);
+        ~ConnectionDriver();
+
+        ConnectionDriver(const ConnectionDriver&) = delete;
+        ConnectionDriver& operator=(const ConnectionDriver&) = delete;
+
+        bool begin();
+        void end();
+        Backend backend() const;
+
+        // Takes ownership of fd. The returned Connection stays valid until
+        // detach() or end(), both of which must run on the loop thread or
+        // after the loop has stopped.
+        Connection* attach(int fd, Callback on_read, Callback on_close = nullptr);
+        void detach(Connection* connection);
+
+        int runOnce(int timeout_ms = -1);
+        void run();
+        void stop();
+
+    private:
+        Backend preferred;
+        Backend active;
+        IoUringLoop uring;
+        EventLoop epoll;
+        std::vector<std::unique_ptr<Connection>> connections;
+};
+
+#endif
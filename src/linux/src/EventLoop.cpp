@@ -0,0 +1,315 @@
+#include "EventLoop.h"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <errno.h>
+
+EventLoop::EventLoop()
+    : epoll_fd(-1), wake_fd(-1), timer_fd(-1), stop_requested(false), loop_thread(std::thread::id()),
+      next_timer_id(1)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    end();
+}
+
+bool EventLoop::begin()
+{
+    stop_requested.store(false);
+
+    if (epoll_fd >= 0) {
+        return true; // Already started
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (epoll_fd < 0 || wake_fd < 0 || timer_fd < 0) {
+        std::cerr << "Failed to create event loop: " << strerror(errno) << std::endl;
+        end();
+        return false;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    event.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event);
+
+    return true;
+}
+
+void EventLoop::end()
+{
+    for (int* fd : {&timer_fd, &wake_fd, &epoll_fd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    handlers.clear();
+    tasks.clear();
+    timers.clear();
+    deadlines.clear();
+}
+
+bool EventLoop::add(int fd, uint32_t events, Handler handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handlers[fd] = std::make_shared<Handler>(std::move(handler));
+    }
+
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        std::cerr << "Failed to watch fd " << fd << ": " << strerror(errno) << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        handlers.erase(fd);
+        return false;
+    }
+
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events)
+{
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::remove(int fd)
+{
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    handlers.erase(fd);
+}
+
+EventLoop::TimerId EventLoop::addTimer(std::chrono::nanoseconds delay, Task task,
+                                       std::chrono::nanoseconds interval)
+{
+    TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        id = next_timer_id++;
+
+        Timer timer;
+        timer.deadline = std::chrono::steady_clock::now() + delay;
+        timer.interval = interval;
+        timer.task = std::make_shared<Task>(std::move(task));
+
+        deadlines.emplace(timer.deadline, id);
+        timers.emplace(id, std::move(timer));
+
+        armTimerFd();
+    }
+
+    return id;
+}
+
+void EventLoop::cancelTimer(TimerId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = timers.find(id);
+    if (it == timers.end()) {
+        return;
+    }
+
+    auto range = deadlines.equal_range(it->second.deadline);
+    for (auto d = range.first; d != range.second; ++d) {
+        if (d->second == id) {
+            deadlines.erase(d);
+            break;
+        }
+    }
+
+    timers.erase(it);
+    armTimerFd();
+}
+
+// Caller holds mutex
+void EventLoop::armTimerFd()
+{
+    struct itimerspec spec = {};
+
+    if (!deadlines.empty()) {
+        auto delay = deadlines.begin()->first - std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+        if (ns < 1) {
+            ns = 1; // Zero would disarm the timer
+        }
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+    }
+
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+void EventLoop::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    wake();
+}
+
+void EventLoop::wake()
+{
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "Failed to wake event loop: " << strerror(errno) << std::endl;
+    }
+}
+
+void EventLoop::stop()
+{
+    stop_requested.store(true);
+    wake();
+}
+
+bool EventLoop::inLoopThread() const
+{
+    return loop_thread.load() == std::this_thread::get_id();
+}
+
+void EventLoop::run()
+{
+    // Checked before every wait, so a stop() from before run() started is
+    // seen instead of lost
+    while (!stop_requested.load()) {
+        if (runOnce(-1) < 0) {
+            break;
+        }
+    }
+}
+
+int EventLoop::runOnce(int timeout_ms)
+{
+    loop_thread.store(std::this_thread::get_id());
+
+    struct epoll_event events[maxEvents];
+    int ready = epoll_wait(epoll_fd, events, maxEvents, timeout_ms);
+
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        std::cerr << "epoll error: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    int dispatched = 0;
+    for (int i = 0; i < ready; i++) {
+        int fd = events[i].data.fd;
+
+        if (fd == wake_fd) {
+            uint64_t count;
+            if (read(wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                std::cerr << "Failed to reset wakeup: " << strerror(errno) << std::endl;
+            }
+            continue;
+        }
+
+        if (fd == timer_fd) {
+            uint64_t expirations;
+            if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+                std::cerr << "Failed to read timer: " << strerror(errno) << std::endl;
+            }
+            runTimers();
+            continue;
+        }
+
+        // Look the handler up per event: an earlier handler in this batch
+        // may have removed it
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = handlers.find(fd);
+            if (it != handlers.end()) {
+                handler = it->second;
+            }
+        }
+
+        if (handler) {
+            (*handler)(events[i].events);
+            dispatched++;
+        }
+    }
+
+    runTasks();
+
+    return dispatched;
+}
+
+void EventLoop::runTasks()
+{
+    std::vector<Task> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(tasks);
+    }
+
+    for (Task& task : pending) {
+        task();
+    }
+}
+
+void EventLoop::runTimers()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    while (true) {
+        std::shared_ptr<Task> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (deadlines.empty() || deadlines.begin()->first > now) {
+                armTimerFd();
+                return;
+            }
+
+            TimerId id = deadlines.begin()->second;
+            deadlines.erase(deadlines.begin());
+
+            auto it = timers.find(id);
+            if (it == timers.end()) {
+                continue;
+            }
+
+            task = it->second.task;
+
+            if (it->second.interval.count() > 0) {
+                it->second.deadline += it->second.interval;
+                if (it->second.deadline <= now) {
+                    it->second.deadline = now + it->second.interval; // Don't try to catch up
+                }
+                deadlines.emplace(it->second.deadline, id);
+            } else {
+                timers.erase(it);
+            }
+        }
+
+        (*task)();
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef _EVENT_LOOP_H_
+#define _EVENT_LOOP_H_
+
+#include <sys/epoll.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// epoll reactor that lets one thread drive many file descriptors. Handlers,
+// timers and posted tasks all run on the thread that calls run(). add(),
+// remove(), post(), addTimer(), cancelTimer() and stop() may be called from
+// any thread; post() and stop() wake a sleeping loop through an eventfd.
+class EventLoop
+{
+    public:
+        using Handler = std::function<void(uint32_t events)>;
+        using Task = std::function<void()>;
+        using TimerId = uint64_t;
+
+        static const int maxEvents = 64;
+
+        EventLoop();
+        ~EventLoop();
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        bool begin();
+        void end();
+
+        // events are EPOLLIN/EPOLLOUT/..., plus EPOLLET for edge-triggered mode
+        bool add(int fd, uint32_t events, Handler handler);
+        bool modify(int fd, uint32_t events);
+        void remove(int fd);
+
+        // One-shot when interval is zero, otherwise repeating
+        TimerId addTimer(std::chrono::nanoseconds delay, Task task,
+                         std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero());
+        void cancelTimer(TimerId id);
+
+        // Run task on the loop thread, waking the loop if it is asleep
+        void post(Task task);
+
+        // Dispatch until stop() is called. A stop() that lands before run()
+        // starts still counts; begin() clears it.
+        void run();
+
+        // Wait at most timeout_ms (-1 forever) and dispatch one batch.
+        // Returns the number of fd events dispatched.
+        int runOnce(int timeout_ms = -1);
+
+        void stop();
+        bool inLoopThread() const;
+
+    private:
+        struct Timer {
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::nanoseconds interval;
+            std::shared_ptr<Task> task;
+        };
+
+        int epoll_fd;
+        int wake_fd;
+        int timer_fd;
+        std::atomic<bool> stop_requested;
+        std::atomic<std::thread::id> loop_thread;
+
+        std::mutex mutex;
+        std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+        std::vector<Task> tasks;
+        std::map<TimerId, Timer> timers;
+        std::multimap<std::chrono::steady_clock::time_point, TimerId> deadlines;
+        TimerId next_timer_id;
+
+        void wake();
+        void runTasks();
+        void runTimers();
+        void armTimerFd();
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "FdConnection.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <errno.h>
+
+FdConnection::FdConnection(EventLoop& loop, int fd, bool edge_triggered)
+    : loop(loop), file_descriptor(fd), edge_triggered(edge_triggered), is_tty(isatty(fd) == 1),
+      open(false), rx_stalled(false), tx_scheduled(false)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+FdConnection::~FdConnection()
+{
+    end();
+
+    if (file_descriptor >= 0) {
+        close(file_descriptor);
+        file_descriptor = -1;
+    }
+}
+
+bool FdConnection::begin()
+{
+    if (open.load()) {
+        return true;
+    }
+
+    uint32_t events = EPOLLIN | EPOLLRDHUP;
+    if (edge_triggered) {
+        // Edge-triggered: register everything once, the loop reports changes
+        events |= EPOLLOUT | EPOLLET;
+    }
+
+    if (!loop.add(file_descriptor, events, [this](uint32_t ready) { handleEvents(ready); })) {
+        return false;
+    }
+
+    open.store(true);
+    return true;
+}
+
+void FdConnection::end()
+{
+    if (!open.exchange(false)) {
+        return;
+    }
+
+    loop.remove(file_descriptor);
+}
+
+bool FdConnection::isOpen() const
+{
+    return open.load();
+}
+
+int FdConnection::fd() const
+{
+    return file_descriptor;
+}
+
+void FdConnection::setReadCallback(Callback callback)
+{
+    read_callback = std::move(callback);
+}
+
+void FdConnection::setCloseCallback(Callback callback)
+{
+    close_callback = std::move(callback);
+}
+
+void FdConnection::setWriteCallback(Callback callback)
+{
+    write_callback = std::move(callback);
+}
+
+void FdConnection::handleEvents(uint32_t events)
+{
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        readIntoRing();
+    }
+
+    if (open.load() && (events & EPOLLOUT)) {
+        flushTx();
+    }
+
+    if (open.load() && (events & (EPOLLHUP | EPOLLERR))) {
+        hangUp();
+    }
+}
+
+void FdConnection::readIntoRing()
+{
+    size_t total = 0;
+    bool hung_up = false;
+
+    while (true) {
+        char* span;
+        size_t space = rx_ring.writeSpan(span);
+        if (space == 0) {
+            // Leave the rest in the kernel until the reader makes room
+            rx_stalled.store(true);
+            updateInterest();
+            break;
+        }
+
+        ssize_t n = ::read(file_descriptor, span, space);
+        if (n > 0) {
+            rx_ring.commit(n);
+            total += n;
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // A tty with VMIN 0 reads 0 when empty; it reports hangup as EIO
+        if (n == 0 && is_tty) {
+            break;
+        }
+
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            hung_up = true;
+        }
+        break;
+    }
+
+    if (total > 0 && read_callback) {
+        read_callback(*this);
+    }
+
+    if (hung_up && open.load()) {
+        hangUp();
+    }
+}
+
+void FdConnection::flushTx()
+{
+    tx_scheduled.store(false);
+
+    size_t total = 0;
+    while (true) {
+        const char* span;
+        size_t length = tx_ring.readSpan(span);
+        if (length == 0) {
+            break;
+        }
+
+        ssize_t n = ::write(file_descriptor, span, length);
+        if (n > 0) {
+            tx_ring.consume(n);
+            total += n;
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break; // Resume on EPOLLOUT
+        }
+
+        std::cerr << "Write error on fd " << file_descriptor << ": " << strerror(errno) << std::endl;
+        hangUp();
+        return;
+    }
+
+    updateInterest();
+
+    if (total > 0 && write_callback) {
+        write_callback(*this);
+    }
+}
+
+// Level-triggered mode has to stop asking for events it cannot act on,
+// or epoll would report them in a tight loop
+void FdConnection::updateInterest()
+{
+    if (edge_triggered || !open.load()) {
+        return;
+    }
+
+    bool want_write = !tx_ring.empty();
+    bool want_read = !rx_stalled.load();
+
+    uint32_t events = 0;
+    if (want_read) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (want_write) {
+        events |= EPOLLOUT;
+    }
+
+    loop.modify(file_descriptor, events);
+}
+
+void FdConnection::hangUp()
+{
+    end();
+
+    if (close_callback) {
+        close_callback(*this);
+    }
+}
+
+size_t FdConnection::tryWrite(const char* data, size_t length)
+{
+    size_t accepted = tx_ring.put(data, length);
+
+    if (accepted > 0) {
+        if (loop.inLoopThread()) {
+            flushTx();
+        } else if (!tx_scheduled.exchange(true)) {
+            loop.post([this] { flushTx(); });
+        }
+    }
+
+    return accepted;
+}
+
+void FdConnection::resumeRx()
+{
+    if (!rx_stalled.exchange(false)) {
+        return;
+    }
+
+    // The fd may still hold data that never got an edge of its own
+    if (loop.inLoopThread()) {
+        readIntoRing();
+        updateInterest();
+    } else {
+        loop.post([this] {
+            readIntoRing();
+            updateInterest();
+        });
+    }
+}
+
+int FdConnection::tryReadOne()
+{
+    char c;
+    if (!rx_ring.get(c)) {
+        return -1;
+    }
+
+    resumeRx();
+    return static_cast<unsigned char>(c);
+}
+
+char FdConnection::readOne()
+{
+    char c;
+    if (!rx_ring.get(c)) {
+        return 0; // Non-blocking, return 0 if no data
+    }
+
+    resumeRx();
+    return c;
+}
+
+std::vector<char> FdConnection::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    results.resize(rx_ring.get(results.data(), results.size()));
+
+    if (!results.empty()) {
+        resumeRx();
+    }
+
+    return results;
+}
+
+void FdConnection::write(std::vector<char> bs)
+{
+    size_t accepted = tryWrite(bs.data(), bs.size());
+    if (accepted < bs.size()) {
+        std::cerr << "TX ring full on fd " << file_descriptor << ", dropped "
+                  << bs.size() - accepted << " bytes" << std::endl;
+    }
+}
+
+bool FdConnection::availableForReading()
+{
+    return rx_ring.available();
+}
+
+size_t FdConnection::available() const
+{
+    return rx_ring.count();
+}
+
+size_t FdConnection::writeSpace() const
+{
+    return tx_ring.free();
+}
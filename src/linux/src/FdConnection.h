@@ -0,0 +1,92 @@
+#ifndef _FD_CONNECTION_H_
+#define _FD_CONNECTION_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+#include "EventLoop.h"
+
+#include <atomic>
+#include <functional>
+
+// Default for read(), beside the ring size in TransmissionConfig.h; define
+// it for the library and its callers alike to change it.
+#ifndef TRANSMISSION_FD_READ_SIZE
+#define TRANSMISSION_FD_READ_SIZE 1024
+#endif
+
+// Connection over any nonblocking file descriptor (serial port, socket,
+// pipe) driven by a shared EventLoop instead of a thread of its own. The
+// loop fills the RX ring on readability and drains the TX ring on
+// writability. Reads and writes must come from a single thread, either
+// loop callbacks or one other thread, and the connection must be
+// destroyed on the loop thread or after the loop has stopped.
+class FdConnection : public Connection
+{
+    public:
+        static const int maxBufferSize = TRANSMISSION_FD_BUFFER_SIZE;
+        static const int maxReadSize = TRANSMISSION_FD_READ_SIZE;
+
+        using Callback = std::function<void(FdConnection&)>;
+
+        // Takes ownership of fd and switches it to nonblocking mode
+        FdConnection(EventLoop& loop, int fd, bool edge_triggered = true);
+        ~FdConnection();
+
+        FdConnection(const FdConnection&) = delete;
+        FdConnection& operator=(const FdConnection&) = delete;
+
+        bool begin();
+        void end();
+        bool isOpen() const;
+        int fd() const;
+
+        // Run on the loop thread after new bytes land in the RX ring, and
+        // when the peer hangs up
+        void setReadCallback(Callback callback);
+        void setCloseCallback(Callback callback);
+        // Run on the loop thread after bytes leave the TX ring, so a
+        // producer held back by writeSpace() knows when to continue
+        void setWriteCallback(Callback callback);
+
+        // Queue as much as fits and return the count accepted
+        size_t tryWrite(const char* data, size_t length);
+
+        using Connection::write;
+
+        // Connection interface. Nonblocking: read() returns what is buffered
+        // and write() drops whatever does not fit in the TX ring.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        size_t available() const;
+        size_t writeSpace() const;
+
+    private:
+        EventLoop& loop;
+        int file_descriptor;
+        bool edge_triggered;
+        bool is_tty;
+        std::atomic<bool> open;
+        std::atomic<bool> rx_stalled;   // RX ring filled before the fd ran dry
+        std::atomic<bool> tx_scheduled; // A flush is already posted to the loop
+
+        InterruptSafeRingBuffer<char, maxBufferSize> rx_ring;
+        InterruptSafeRingBuffer<char, maxBufferSize> tx_ring;
+
+        Callback read_callback;
+        Callback close_callback;
+        Callback write_callback;
+
+        void handleEvents(uint32_t events);
+        void readIntoRing();
+        void resumeRx();
+        void flushTx();
+        void updateInterest();
+        void hangUp();
+};
+
+#endif
@@ -0,0 +1,1024 @@
+#include "IoUringLoop.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// Special user_data values; real operations carry an Op pointer
+static const uint64_t wakeUserData = 1;
+static const uint64_t timeoutUserData = 2;
+
+// Buffer group of the loop's provided buffer pool
+static const uint16_t bufferGroup = 0;
+
+static_assert((IoUringLoop::poolBuffers & (IoUringLoop::poolBuffers - 1)) == 0 &&
+              IoUringLoop::poolBuffers <= 32768, "Pool buffer count must be a power of 2, at most 32768");
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// The mapped submission and completion queues. No liburing dependency: the
+// raw interface is small enough to drive directly.
+struct IoUringLoop::Rings
+{
+    int fd = -1;
+
+    void* sq_map = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    size_t cq_map_size = 0;
+    struct io_uring_sqe* sqes = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned sqe_tail = 0;      // Handed out by nextSqe(), published by submit()
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    struct io_uring_cqe* cqes = nullptr;
+
+    unsigned to_submit = 0;
+    struct __kernel_timespec timeout = {};
+
+    // Provided buffer ring (kernel 5.19+) that multishot recvs pick from.
+    // Indexed as a plain array: in C++ the flexible array member of
+    // io_uring_buf_ring lands 8 bytes off in older uapi headers, and the
+    // kernel overlays the ring tail on the first entry's resv anyway.
+    struct io_uring_buf* buf_ring = static_cast<struct io_uring_buf*>(MAP_FAILED);
+    size_t buf_ring_size = 0;
+    char* buf_memory = nullptr;
+    uint16_t buf_tail = 0;
+    bool buffers = false;
+
+    bool open(unsigned entries)
+    {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        fd = ioUringSetup(entries, &params);
+        if (fd < 0) {
+            return false;
+        }
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            return false;
+        }
+
+        if (single_mmap) {
+            cq_map = sq_map;
+        } else {
+            cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) {
+                return false;
+            }
+        }
+
+        sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes = static_cast<struct io_uring_sqe*>(
+            mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sqe_tail = *sq_tail;
+
+        char* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return true;
+    }
+
+    // Registers the pool; false leaves every read a plain IORING_OP_READ
+    bool openBuffers()
+    {
+        buf_ring_size = IoUringLoop::poolBuffers * sizeof(struct io_uring_buf);
+        buf_ring = static_cast<struct io_uring_buf*>(
+            mmap(nullptr, buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buf_ring == MAP_FAILED) {
+            return false;
+        }
+
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring);
+        reg.ring_entries = IoUringLoop::poolBuffers;
+        reg.bgid = bufferGroup;
+
+        if (ioUringRegister(fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            munmap(buf_ring, buf_ring_size);
+            buf_ring = static_cast<struct io_uring_buf*>(MAP_FAILED);
+            return false;
+        }
+
+        buf_memory = new char[static_cast<size_t>(IoUringLoop::poolBuffers) * IoUringLoop::poolBufferSize];
+        for (unsigned bid = 0; bid < IoUringLoop::poolBuffers; bid++) {
+            provide(static_cast<uint16_t>(bid));
+        }
+
+        buffers = true;
+        return true;
+    }
+
+    char* buffer(uint16_t bid)
+    {
+        return buf_memory + static_cast<size_t>(bid) * IoUringLoop::poolBufferSize;
+    }
+
+    // Hands a pool buffer (back) to the kernel
+    void provide(uint16_t bid)
+    {
+        struct io_uring_buf* buf = &buf_ring[buf_tail & (IoUringLoop::poolBuffers - 1)];
+        buf->addr = reinterpret_cast<uint64_t>(buffer(bid));
+        buf->len = IoUringLoop::poolBufferSize;
+        buf->bid = bid;
+
+        buf_tail++;
+        __atomic_store_n(&buf_ring[0].resv, buf_tail, __ATOMIC_RELEASE);
+    }
+
+    void close()
+    {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+            sqes = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+        }
+        if (cq_map != MAP_FAILED && cq_map != sq_map) {
+            munmap(cq_map, cq_map_size);
+        }
+        cq_map = MAP_FAILED;
+        if (sq_map != MAP_FAILED) {
+            munmap(sq_map, sq_map_size);
+            sq_map = MAP_FAILED;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+
+        // Only once the ring is gone does the kernel let go of the pool
+        if (buf_ring != MAP_FAILED) {
+            munmap(buf_ring, buf_ring_size);
+            buf_ring = static_cast<struct io_uring_buf*>(MAP_FAILED);
+        }
+        delete[] buf_memory;
+        buf_memory = nullptr;
+        buffers = false;
+    }
+
+    // Returns a zeroed SQE, submitting queued ones first if the queue is
+    // full. The kernel does not see it until the next submit(), by which
+    // time the caller has filled it in.
+    struct io_uring_sqe* nextSqe()
+    {
+        if (sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+            submit(0);
+            if (sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+                return nullptr;
+            }
+        }
+
+        unsigned index = sqe_tail & sq_mask;
+        struct io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+
+        sqe_tail++;
+        to_submit++;
+        return sqe;
+    }
+
+    int submit(unsigned min_complete)
+    {
+        unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        if (to_submit == 0 && min_complete == 0) {
+            return 0;
+        }
+
+        // Publish the filled SQEs
+        __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+
+        int submitted = ioUringEnter(fd, to_submit, min_complete, flags);
+        if (submitted < 0) {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        to_submit -= std::min<unsigned>(to_submit, submitted);
+        return submitted;
+    }
+};
+
+// IoUringConnection implementation
+IoUringConnection::IoUringConnection(IoUringLoop& loop, int fd)
+    : loop(loop), file_descriptor(fd), is_socket(false), open(false), closing(false), write_requested(false),
+      read_op{this, OpKind::read, false}, write_op{this, OpKind::write, false}, read_multishot(false),
+      has_parked(false), eof_pending(false), notifying(false), renotify(false)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    }
+
+    // Multishot recv only works on sockets
+    struct stat st;
+    is_socket = fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+IoUringConnection::~IoUringConnection()
+{
+    end();
+
+    if (file_descriptor >= 0) {
+        close(file_descriptor);
+        file_descriptor = -1;
+    }
+}
+
+bool IoUringConnection::begin()
+{
+    if (open.load()) {
+        return true;
+    }
+
+    open.store(true);
+    closing = false;
+    eof_pending = false;
+
+    // Posted from the loop thread, directly or through its wakeup
+    resume();
+    return true;
+}
+
+void IoUringConnection::end()
+{
+    open.store(false);
+
+    // Returns once the kernel holds no operation on this connection's rings
+    loop.cancel(*this);
+}
+
+bool IoUringConnection::isOpen() const
+{
+    return open.load();
+}
+
+int IoUringConnection::fd() const
+{
+    return file_descriptor;
+}
+
+void IoUringConnection::setReadCallback(Callback callback)
+{
+    read_callback = std::move(callback);
+}
+
+void IoUringConnection::setCloseCallback(Callback callback)
+{
+    close_callback = std::move(callback);
+}
+
+void IoUringConnection::resume()
+{
+    if (loop.inLoopThread()) {
+        // Also moves parked pool buffers into the ring now there is room
+        loop.postRead(*this);
+        if (!write_op.in_flight) {
+            loop.postWrite(*this);
+        }
+    } else if (!write_requested.exchange(true)) {
+        loop.requestWrite(*this);
+    }
+}
+
+size_t IoUringConnection::tryWrite(const char* data, size_t length)
+{
+    size_t accepted = tx_ring.put(data, length);
+    if (accepted > 0 && open.load()) {
+        resume();
+    }
+    return accepted;
+}
+
+int IoUringConnection::tryReadOne()
+{
+    char c;
+    if (!rx_ring.get(c)) {
+        // The loop may have parked a buffer just before this drained the ring
+        if (has_parked.load() && open.load()) {
+            resume();
+        }
+        return -1;
+    }
+
+    if ((!read_op.in_flight || has_parked.load()) && open.load()) {
+        resume();
+    }
+    return static_cast<unsigned char>(c);
+}
+
+char IoUringConnection::readOne()
+{
+    int c = tryReadOne();
+    return c < 0 ? 0 : static_cast<char>(c); // Non-blocking, return 0 if no data
+}
+
+std::vector<char> IoUringConnection::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    results.resize(rx_ring.get(results.data(), results.size()));
+
+    // A full ring parks the read, or the received pool buffers; restart
+    // or move them now that there is room
+    if ((!results.empty() || has_parked.load()) && (!read_op.in_flight || has_parked.load()) && open.load()) {
+        resume();
+    }
+
+    return results;
+}
+
+void IoUringConnection::write(std::vector<char> bs)
+{
+    size_t accepted = tryWrite(bs.data(), bs.size());
+    if (accepted < bs.size()) {
+        std::cerr << "TX ring full on fd " << file_descriptor << ", dropped "
+                  << bs.size() - accepted << " bytes" << std::endl;
+    }
+}
+
+bool IoUringConnection::availableForReading()
+{
+    return rx_ring.available();
+}
+
+size_t IoUringConnection::available() const
+{
+    return rx_ring.count();
+}
+
+size_t IoUringConnection::writeSpace() const
+{
+    return tx_ring.free();
+}
+
+// IoUringLoop implementation
+IoUringLoop::IoUringLoop()
+    : rings(nullptr), wake_fd(-1), wake_value(0), wake_posted(false), stop_requested(false),
+      loop_thread(std::thread::id()), dispatching(false)
+{
+}
+
+IoUringLoop::~IoUringLoop()
+{
+    end();
+}
+
+bool IoUringLoop::available()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = ioUringSetup(2, &params);
+    if (fd < 0) {
+        return false;
+    }
+
+    close(fd);
+    return true;
+}
+
+bool IoUringLoop::providedBuffers() const
+{
+    return rings && rings->buffers;
+}
+
+bool IoUringLoop::begin(unsigned entries)
+{
+    stop_requested.store(false);
+
+    if (rings) {
+        return true;
+    }
+
+    rings = new Rings();
+    if (!rings->open(entries)) {
+        std::cerr << "io_uring unavailable: " << strerror(errno) << std::endl;
+        end();
+        return false;
+    }
+
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+        end();
+        return false;
+    }
+
+    // Probe for provided buffer rings; without them sockets read like
+    // every other descriptor
+    rings->openBuffers();
+
+    return true;
+}
+
+void IoUringLoop::end()
+{
+    if (rings) {
+        rings->close();
+        delete rings;
+        rings = nullptr;
+    }
+
+    if (wake_fd >= 0) {
+        close(wake_fd);
+        wake_fd = -1;
+    }
+
+    wake_posted = false;
+}
+
+void IoUringLoop::postRead(IoUringConnection& connection)
+{
+    if (connection.closing) {
+        return;
+    }
+
+    // Bytes received while the ring was full go in first, in order
+    if (!connection.parked.empty()) {
+        if (drainParked(connection) > 0) {
+            notifyRead(connection);
+        }
+        if (connection.closing || !connection.parked.empty()) {
+            return; // Still no room
+        }
+        if (connection.eof_pending) {
+            hangUp(connection);
+            return;
+        }
+    }
+
+    if (connection.read_op.in_flight) {
+        return;
+    }
+
+    if (connection.is_socket && rings->buffers) {
+        postRecv(connection);
+    } else {
+        postPlainRead(connection);
+    }
+}
+
+void IoUringLoop::postPlainRead(IoUringConnection& connection)
+{
+    char* span;
+    size_t space = connection.rx_ring.writeSpan(span);
+    if (space == 0) {
+        return; // Parked until the reader makes room
+    }
+
+    struct io_uring_sqe* sqe = rings->nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = connection.file_descriptor;
+    sqe->addr = reinterpret_cast<uint64_t>(span);
+    sqe->len = static_cast<uint32_t>(space);
+    sqe->off = static_cast<uint64_t>(-1); // Current position, for pipes and ttys
+    sqe->user_data = reinterpret_cast<uint64_t>(&connection.read_op);
+
+    connection.read_op.in_flight = true;
+    connection.read_multishot = false;
+}
+
+// One SQE that keeps completing, each time into a pool buffer of the
+// kernel's choosing, until it fails, is cancelled or the pool runs dry
+void IoUringLoop::postRecv(IoUringConnection& connection)
+{
+    struct io_uring_sqe* sqe = rings->nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = connection.file_descriptor;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = bufferGroup;
+    sqe->user_data = reinterpret_cast<uint64_t>(&connection.read_op);
+
+    connection.read_op.in_flight = true;
+    connection.read_multishot = true;
+}
+
+void IoUringLoop::postWrite(IoUringConnection& connection)
+{
+    if (connection.write_op.in_flight || connection.closing) {
+        return;
+    }
+
+    const char* span;
+    size_t length = connection.tx_ring.readSpan(span);
+    if (length == 0) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = rings->nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = connection.file_descriptor;
+    sqe->addr = reinterpret_cast<uint64_t>(span);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->user_data = reinterpret_cast<uint64_t>(&connection.write_op);
+
+    connection.write_op.in_flight = true;
+}
+
+void IoUringLoop::postCancel(IoUringConnection::Op& op)
+{
+    if (!op.in_flight) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = rings->nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&op);
+    sqe->user_data = 0; // Completion ignored
+}
+
+void IoUringLoop::postWake()
+{
+    if (wake_posted) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = rings->nextSqe();
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+    sqe->len = sizeof(wake_value);
+    sqe->user_data = wakeUserData;
+
+    wake_posted = true;
+}
+
+void IoUringLoop::requestWrite(IoUringConnection& connection)
+{
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending_writes.push_back(&connection);
+    }
+
+    wake();
+}
+
+void IoUringLoop::wake()
+{
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0) {
+        std::cerr << "Failed to wake io_uring loop: " << strerror(errno) << std::endl;
+    }
+}
+
+void IoUringLoop::cancel(IoUringConnection& connection)
+{
+    std::future<void> done;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending_writes.erase(std::remove(pending_writes.begin(), pending_writes.end(), &connection),
+                             pending_writes.end());
+
+        // Only the thread in run() may touch the rings while it is there
+        if (dispatching && !inLoopThread()) {
+            Cancel cancel{&connection, std::promise<void>()};
+            done = cancel.done.get_future();
+            pending_cancels.push_back(std::move(cancel));
+        }
+    }
+
+    if (done.valid()) {
+        wake();
+        done.wait();
+        return;
+    }
+
+    // On the loop thread, or with nobody else driving the rings
+    connection.closing = true;
+    if (!rings) {
+        connection.read_op.in_flight = false;
+        connection.write_op.in_flight = false;
+        connection.parked.clear();
+        connection.has_parked.store(false);
+        return;
+    }
+
+    postCancel(connection.read_op);
+    postCancel(connection.write_op);
+
+    // The kernel may still write into the rings; wait until it lets go
+    while (connection.read_op.in_flight || connection.write_op.in_flight) {
+        if (runOnce(-1) < 0) {
+            break;
+        }
+    }
+
+    releaseParked(connection);
+}
+
+void IoUringLoop::startCancel(Cancel cancel)
+{
+    IoUringConnection& connection = *cancel.connection;
+    connection.closing = true;
+    postCancel(connection.read_op);
+    postCancel(connection.write_op);
+    cancelling.push_back(std::move(cancel));
+}
+
+// Lets go of the callers whose connections have nothing left in flight
+void IoUringLoop::finishCancels()
+{
+    for (auto it = cancelling.begin(); it != cancelling.end();) {
+        IoUringConnection& connection = *it->connection;
+        if (connection.read_op.in_flight || connection.write_op.in_flight) {
+            ++it;
+            continue;
+        }
+
+        releaseParked(connection);
+
+        // The connection may be gone as soon as this returns
+        it->done.set_value();
+        it = cancelling.erase(it);
+    }
+}
+
+void IoUringLoop::complete(uint64_t user_data, int32_t result, uint32_t flags)
+{
+    if (user_data == 0 || user_data == timeoutUserData) {
+        return;
+    }
+
+    if (user_data == wakeUserData) {
+        wake_posted = false;
+        return;
+    }
+
+    IoUringConnection::Op* op = reinterpret_cast<IoUringConnection::Op*>(user_data);
+    IoUringConnection& connection = *op->connection;
+
+    // A multishot recv stays armed for as long as the kernel says so
+    if (!(flags & IORING_CQE_F_MORE)) {
+        op->in_flight = false;
+    }
+
+    if (op->kind == IoUringConnection::OpKind::read) {
+        completeRead(connection, result, flags);
+        return;
+    }
+
+    if (connection.closing) {
+        return;
+    }
+
+    if (result >= 0) {
+        connection.tx_ring.consume(result);
+        postWrite(connection);
+    } else if (result == -EAGAIN || result == -EINTR) {
+        postWrite(connection);
+    } else if (result != -ECANCELED) {
+        std::cerr << "Write error on fd " << connection.file_descriptor << ": " << strerror(-result) << std::endl;
+        hangUp(connection);
+    }
+}
+
+void IoUringLoop::completeRead(IoUringConnection& connection, int32_t result, uint32_t flags)
+{
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (connection.closing || result <= 0) {
+            rings->provide(bid);
+        } else {
+            receive(connection, bid, static_cast<uint32_t>(result));
+        }
+    } else if (connection.closing) {
+        return;
+    } else if (result > 0) {
+        connection.rx_ring.commit(result);
+        notifyRead(connection);
+    } else if (result == 0) {
+        // EOF; what is still parked is delivered first
+        if (connection.parked.empty()) {
+            hangUp(connection);
+        } else {
+            connection.eof_pending = true;
+        }
+        return;
+    } else if (result == -ENOBUFS) {
+        // The pool ran dry; read once straight into the ring instead
+        if (connection.parked.empty()) {
+            postPlainRead(connection);
+        }
+        return;
+    } else if (result == -EINVAL && connection.read_multishot) {
+        // A kernel with buffer rings but no multishot recv (before 6.0)
+        rings->buffers = false;
+    } else if (result != -EAGAIN && result != -EINTR && result != -ECANCELED) {
+        hangUp(connection); // Error
+        return;
+    }
+
+    if (!connection.closing && !connection.read_op.in_flight) {
+        postRead(connection);
+    }
+}
+
+// Copies a filled pool buffer into the RX ring, parking what does not fit
+void IoUringLoop::receive(IoUringConnection& connection, uint16_t bid, uint32_t length)
+{
+    uint32_t stored = 0;
+    if (connection.parked.empty()) {
+        stored = static_cast<uint32_t>(connection.rx_ring.put(rings->buffer(bid), length));
+    }
+
+    if (stored == length) {
+        rings->provide(bid);
+    } else {
+        connection.parked.push_back({bid, stored, length - stored});
+        connection.has_parked.store(true);
+
+        // A reader this far behind should not hold the whole pool; the recv
+        // is re-armed once it catches up
+        if (connection.parked.size() >= poolBuffers / 4 && connection.read_op.in_flight) {
+            postCancel(connection.read_op);
+        }
+    }
+
+    if (stored > 0) {
+        notifyRead(connection);
+    }
+}
+
+size_t IoUringLoop::drainParked(IoUringConnection& connection)
+{
+    size_t moved = 0;
+
+    while (!connection.parked.empty()) {
+        IoUringConnection::Parked& front = connection.parked.front();
+        size_t n = connection.rx_ring.put(rings->buffer(front.bid) + front.offset, front.length);
+        moved += n;
+        front.offset += n;
+        front.length -= n;
+
+        if (front.length > 0) {
+            break; // Ring full again
+        }
+
+        rings->provide(front.bid);
+        connection.parked.pop_front();
+    }
+
+    connection.has_parked.store(!connection.parked.empty());
+    return moved;
+}
+
+// Returns parked pool buffers unread, once the connection is done with
+void IoUringLoop::releaseParked(IoUringConnection& connection)
+{
+    for (const IoUringConnection::Parked& parked : connection.parked) {
+        rings->provide(parked.bid);
+    }
+    connection.parked.clear();
+    connection.has_parked.store(false);
+    connection.eof_pending = false;
+}
+
+// Runs the read callback, once more if bytes land while it is running
+void IoUringLoop::notifyRead(IoUringConnection& connection)
+{
+    if (!connection.read_callback) {
+        return;
+    }
+
+    if (connection.notifying) {
+        connection.renotify = true;
+        return;
+    }
+
+    connection.notifying = true;
+    do {
+        connection.renotify = false;
+        connection.read_callback(connection);
+    } while (connection.renotify && connection.rx_ring.available());
+    connection.notifying = false;
+}
+
+void IoUringLoop::hangUp(IoUringConnection& connection)
+{
+    if (!connection.open.exchange(false)) {
+        return;
+    }
+
+    connection.closing = true;
+    postCancel(connection.read_op);
+    postCancel(connection.write_op);
+    if (connection.close_callback) {
+        connection.close_callback(connection);
+    }
+}
+
+int IoUringLoop::runOnce(int timeout_ms)
+{
+    if (!rings) {
+        return -1;
+    }
+
+    loop_thread.store(std::this_thread::get_id());
+
+    // Cancels and writes requested from other threads
+    std::vector<IoUringConnection*> pending;
+    std::vector<Cancel> cancels;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending.swap(pending_writes);
+        cancels.swap(pending_cancels);
+    }
+    for (Cancel& cancel : cancels) {
+        startCancel(std::move(cancel));
+    }
+    finishCancels();
+
+    for (IoUringConnection* connection : pending) {
+        connection->write_requested.store(false);
+        postRead(*connection);
+        postWrite(*connection);
+    }
+
+    postWake();
+
+    unsigned min_complete = timeout_ms == 0 ? 0 : 1;
+    if (timeout_ms > 0) {
+        struct io_uring_sqe* sqe = rings->nextSqe();
+        if (sqe) {
+            rings->timeout.tv_sec = timeout_ms / 1000;
+            rings->timeout.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+            sqe->opcode = IORING_OP_TIMEOUT;
+            sqe->addr = reinterpret_cast<uint64_t>(&rings->timeout);
+            sqe->len = 1;
+            sqe->off = 1; // Also complete as soon as any other completion arrives
+            sqe->user_data = timeoutUserData;
+        }
+    }
+
+    // One syscall submits every queued read and write and waits
+    if (rings->submit(min_complete) < 0) {
+        std::cerr << "io_uring_enter error: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    int handled = 0;
+    while (true) {
+        unsigned head = *rings->cq_head;
+        if (head == __atomic_load_n(rings->cq_tail, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        struct io_uring_cqe cqe = rings->cqes[head & rings->cq_mask];
+
+        // Release the slot before the handler runs, which may re-enter
+        __atomic_store_n(rings->cq_head, head + 1, __ATOMIC_RELEASE);
+
+        complete(cqe.user_data, cqe.res, cqe.flags);
+        if (cqe.user_data != timeoutUserData && cqe.user_data != wakeUserData && cqe.user_data != 0) {
+            handled++;
+        }
+    }
+
+    finishCancels();
+
+    // Reads and writes posted by the handlers go out on the next enter
+    return handled;
+}
+
+void IoUringLoop::run()
+{
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        dispatching = true;
+    }
+
+    // Checked before every wait, so a stop() from before run() started is
+    // seen instead of lost
+    bool failed = false;
+    while (!stop_requested.load()) {
+        if (runOnce(-1) < 0) {
+            failed = true;
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        dispatching = false;
+    }
+
+    // Cancels handed over before that still have callers waiting on them
+    while (!failed) {
+        int timeout_ms;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            if (pending_cancels.empty() && cancelling.empty()) {
+                break;
+            }
+            // Only wait when there is a completion to wait for
+            timeout_ms = cancelling.empty() ? 0 : -1;
+        }
+
+        if (runOnce(timeout_ms) < 0) {
+            failed = true;
+        }
+    }
+
+    // The rings are unusable; do not leave anyone blocked in end()
+    if (failed) {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        for (Cancel& cancel : pending_cancels) {
+            cancelling.push_back(std::move(cancel));
+        }
+        pending_cancels.clear();
+        for (Cancel& cancel : cancelling) {
+            cancel.done.set_value();
+        }
+        cancelling.clear();
+    }
+}
+
+void IoUringLoop::stop()
+{
+    stop_requested.store(true);
+    wake();
+}
+
+bool IoUringLoop::inLoopThread() const
+{
+    return loop_thread.load() == std::this_thread::get_id();
+}
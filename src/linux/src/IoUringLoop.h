@@ -0,0 +1,212 @@
+#ifndef _IO_URING_LOOP_H_
+#define _IO_URING_LOOP_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class IoUringLoop;
+
+// The loop's provided buffer pool: sockets receive into these buffers with
+// one multishot recv each, instead of re-arming a read per chunk. A power
+// of two.
+#ifndef TRANSMISSION_URING_POOL_BUFFERS
+#define TRANSMISSION_URING_POOL_BUFFERS 64
+#endif
+
+#ifndef TRANSMISSION_URING_POOL_BUFFER_SIZE
+#define TRANSMISSION_URING_POOL_BUFFER_SIZE 4096
+#endif
+
+// Connection whose reads and writes are io_uring operations, so moving a
+// chunk costs no syscall of its own. A socket keeps one multishot recv
+// armed on the loop's provided buffers and each completion is copied into
+// its RX ring; other descriptors (ttys, pipes), or a kernel without
+// multishot recv, get a plain read posted straight into the free span of
+// the RX ring. Writes go out directly from the TX ring. At most one read
+// and one write are in flight per connection.
+class IoUringConnection : public Connection
+{
+    public:
+        static const int maxBufferSize = TRANSMISSION_FD_BUFFER_SIZE;
+
+        using Callback = std::function<void(IoUringConnection&)>;
+
+        // Takes ownership of fd and switches it to blocking mode; io_uring
+        // arms its own poll, while O_NONBLOCK would make it return -EAGAIN
+        IoUringConnection(IoUringLoop& loop, int fd);
+        ~IoUringConnection();
+
+        IoUringConnection(const IoUringConnection&) = delete;
+        IoUringConnection& operator=(const IoUringConnection&) = delete;
+
+        bool begin();
+        void end();
+        bool isOpen() const;
+        int fd() const;
+
+        // Run on the loop thread after new bytes land in the RX ring, and
+        // when the peer hangs up
+        void setReadCallback(Callback callback);
+        void setCloseCallback(Callback callback);
+
+        // Queue as much as fits and return the count accepted
+        size_t tryWrite(const char* data, size_t length);
+
+        using Connection::write;
+
+        // Connection interface. Nonblocking, like FdConnection.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        size_t available() const;
+        size_t writeSpace() const;
+
+    private:
+        friend class IoUringLoop;
+
+        enum class OpKind : uint8_t { read, write };
+
+        struct Op {
+            IoUringConnection* connection;
+            OpKind kind;
+            bool in_flight;
+        };
+
+        // Part of a pool buffer that found the RX ring full
+        struct Parked {
+            uint16_t bid;
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        IoUringLoop& loop;
+        int file_descriptor;
+        bool is_socket;
+        std::atomic<bool> open;
+        bool closing;
+        std::atomic<bool> write_requested;
+
+        Op read_op;
+        Op write_op;
+        bool read_multishot;            // read_op is a multishot recv
+
+        // Loop thread only, bar has_parked: oldest first, and ahead of
+        // anything received after them
+        std::deque<Parked> parked;
+        std::atomic<bool> has_parked;
+        bool eof_pending;               // Hang up once parked drains
+        bool notifying;
+        bool renotify;
+
+        InterruptSafeRingBuffer<char, maxBufferSize> rx_ring;
+        InterruptSafeRingBuffer<char, maxBufferSize> tx_ring;
+
+        Callback read_callback;
+        Callback close_callback;
+
+        void resume();
+};
+
+// io_uring driver for many IoUringConnections on one thread. Submissions
+// from every connection are batched into a single io_uring_enter per loop
+// iteration. begin() fails when the kernel has no io_uring (or it is
+// disabled), so callers can fall back to EventLoop; see ConnectionDriver.
+class IoUringLoop
+{
+    public:
+        IoUringLoop();
+        ~IoUringLoop();
+
+        IoUringLoop(const IoUringLoop&) = delete;
+        IoUringLoop& operator=(const IoUringLoop&) = delete;
+
+        static const unsigned poolBuffers = TRANSMISSION_URING_POOL_BUFFERS;
+        static const unsigned poolBufferSize = TRANSMISSION_URING_POOL_BUFFER_SIZE;
+
+        static bool available();
+
+        // Whether sockets receive through multishot recv into the
+        // provided buffer pool; false before begin() and on kernels
+        // without them, where every read is a plain IORING_OP_READ
+        bool providedBuffers() const;
+
+        bool begin(unsigned entries = 256);
+        void end();
+
+        // Wait at most timeout_ms (-1 forever) for completions and handle
+        // them. Returns the number of completions handled, or -1 on error.
+        int runOnce(int timeout_ms = -1);
+
+        // Dispatch until stop() is called. A stop() that lands before run()
+        // starts still counts; begin() clears it. While run() is going,
+        // connections may be ended or destroyed from any thread: the cancel
+        // is handed to this thread and the caller waits for it.
+        void run();
+
+        // Safe from any thread
+        void stop();
+        bool inLoopThread() const;
+
+    private:
+        friend class IoUringConnection;
+
+        struct Rings;
+
+        // A connection whose in-flight operations are being cancelled, and
+        // the caller of end() waiting for the kernel to let go of them
+        struct Cancel {
+            IoUringConnection* connection;
+            std::promise<void> done;
+        };
+
+        Rings* rings;
+        int wake_fd;
+        uint64_t wake_value;
+        bool wake_posted;
+        std::atomic<bool> stop_requested;
+        std::atomic<std::thread::id> loop_thread;
+
+        // Connections that asked for a write or a cancel from another
+        // thread, and whether run() is there to take them
+        std::mutex pending_mutex;
+        std::vector<IoUringConnection*> pending_writes;
+        std::vector<Cancel> pending_cancels;
+        bool dispatching;
+
+        // Loop thread only
+        std::vector<Cancel> cancelling;
+
+        void postRead(IoUringConnection& connection);
+        void postPlainRead(IoUringConnection& connection);
+        void postRecv(IoUringConnection& connection);
+        void postWrite(IoUringConnection& connection);
+        void postCancel(IoUringConnection::Op& op);
+        void postWake();
+        void requestWrite(IoUringConnection& connection);
+        void cancel(IoUringConnection& connection);
+        void startCancel(Cancel cancel);
+        void finishCancels();
+        void complete(uint64_t user_data, int32_t result, uint32_t flags);
+        void completeRead(IoUringConnection& connection, int32_t result, uint32_t flags);
+        void receive(IoUringConnection& connection, uint16_t bid, uint32_t length);
+        size_t drainParked(IoUringConnection& connection);
+        void releaseParked(IoUringConnection& connection);
+        void notifyRead(IoUringConnection& connection);
+        void hangUp(IoUringConnection& connection);
+        void wake();
+};
+
+#endif
@@ -0,0 +1,624 @@
+#include "ReliableConnectionLinux.h"
+
+// termios2 lives in the kernel headers, which clash with <termios.h>, so
+// this file talks to the tty with ioctls only
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <iostream>
+#include <cstring>
+#include <errno.h>
+
+ReliableConnectionLinux::ReliableConnectionLinux(const std::string& device_path, const SerialConfig& config)
+    : device_path(device_path), config(config), serial_fd(-1), epoll_fd(-1), wake_fd(-1),
+      running(false), xonXoffEnabled(false), paused(false), buffer_full(false)
+{
+}
+
+ReliableConnectionLinux::~ReliableConnectionLinux()
+{
+    end();
+}
+
+void ReliableConnectionLinux::begin()
+{
+    if (running.load()) {
+        return; // Already started
+    }
+
+    int fd = openSerialPort(device_path, config);
+    if (fd < 0) {
+        return;
+    }
+
+    begin(fd);
+}
+
+void ReliableConnectionLinux::begin(int fd)
+{
+    if (running.load()) {
+        close(fd);
+        return; // Already started
+    }
+
+    // Reap an I/O thread that stopped on a hangup
+    end();
+
+    // The I/O thread relies on nonblocking reads and writes
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    serial_fd = fd;
+
+    if (realtime.lock_memory) {
+        RealtimeThread::lockMemory();
+    }
+
+    if (realtime.low_latency) {
+        RealtimeThread::setSerialLowLatency(serial_fd, true);
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        std::cerr << "Failed to create epoll/eventfd: " << strerror(errno) << std::endl;
+        closeDescriptors();
+        return;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = serial_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, serial_fd, &event);
+
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    tx_idle = true;
+    tx_offset = 0;
+    tx_length = 0;
+    write_interest = false;
+
+    // Start the I/O thread
+    running.store(true);
+    io_thread = std::thread(&ReliableConnectionLinux::ioThreadFunction, this);
+
+    // Send initial XON if flow control is enabled
+    if (xonXoffEnabled.load()) {
+        sendFlowControlChar(XON);
+    }
+
+    std::cout << "Serial connection established on " << device_path << std::endl;
+}
+
+void ReliableConnectionLinux::end()
+{
+    // The I/O thread may already have stopped on its own, on a hangup or
+    // read error, and still need reaping
+    if (!running.load() && !io_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex);
+        running.store(false);
+    }
+    tx_space.notify_all();
+
+    // Wake the I/O thread out of epoll_wait right away
+    wake();
+
+    if (io_thread.joinable()) {
+        io_thread.join();
+    }
+
+    closeDescriptors();
+}
+
+bool ReliableConnectionLinux::isOpen() const
+{
+    return running.load();
+}
+
+void ReliableConnectionLinux::closeDescriptors()
+{
+    if (wake_fd >= 0) {
+        close(wake_fd);
+        wake_fd = -1;
+    }
+
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+
+    if (serial_fd >= 0) {
+        close(serial_fd);
+        serial_fd = -1;
+    }
+}
+
+int ReliableConnectionLinux::openSerialPort(const std::string& device_path, const SerialConfig& config)
+{
+    if (!config.valid()) {
+        std::cerr << "Invalid serial configuration for " << device_path << std::endl;
+        return -1;
+    }
+
+    int fd = open(device_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << device_path << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    if (!configureSerialPort(fd, config)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Baud rate, framing and RTS/CTS; leaves the raw mode and XON/XOFF bits alone
+static void applyLineSettings(struct termios2& tty, const SerialConfig& config)
+{
+    // Arbitrary baud rate
+    tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tty.c_ispeed = config.baud_rate;
+    tty.c_ospeed = config.baud_rate;
+
+    tty.c_cflag &= ~CSIZE;
+    switch (config.data_bits) {
+        case 5: tty.c_cflag |= CS5; break;
+        case 6: tty.c_cflag |= CS6; break;
+        case 7: tty.c_cflag |= CS7; break;
+        default: tty.c_cflag |= CS8; break;
+    }
+
+    if (config.stop_bits == 2) {
+        tty.c_cflag |= CSTOPB;
+    } else {
+        tty.c_cflag &= ~CSTOPB;
+    }
+
+    tty.c_cflag &= ~(PARENB | PARODD);
+    if (config.parity == SerialConfig::Parity::even) {
+        tty.c_cflag |= PARENB;
+    } else if (config.parity == SerialConfig::Parity::odd) {
+        tty.c_cflag |= PARENB | PARODD;
+    }
+
+    if (config.hardware_flow_control) {
+        tty.c_cflag |= CRTSCTS;
+    } else {
+        tty.c_cflag &= ~CRTSCTS;
+    }
+}
+
+bool ReliableConnectionLinux::configureSerialPort(int serial_fd, const SerialConfig& config)
+{
+    struct termios2 tty;
+
+    if (ioctl(serial_fd, TCGETS2, &tty) != 0) {
+        std::cerr << "Error getting terminal attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    applyLineSettings(tty, config);
+    tty.c_cflag |= CREAD | CLOCAL; // Enable reading and ignore modem control lines
+
+    // Raw input mode
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Disable software flow control initially
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
+
+    // Raw output mode
+    tty.c_oflag &= ~OPOST;
+
+    // No canonical processing
+    tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+
+    // Return whatever is there; epoll does the waiting
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+
+    if (ioctl(serial_fd, TCSETS2, &tty) != 0) {
+        std::cerr << "Error setting terminal attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Flush any existing data
+    ioctl(serial_fd, TCFLSH, TCIOFLUSH);
+
+    return true;
+}
+
+bool ReliableConnectionLinux::setConfig(const SerialConfig& new_config)
+{
+    if (!new_config.valid()) {
+        std::cerr << "Invalid serial configuration for " << device_path << std::endl;
+        return false;
+    }
+
+    config = new_config;
+
+    if (serial_fd < 0) {
+        return true;
+    }
+
+    struct termios2 tty;
+    if (ioctl(serial_fd, TCGETS2, &tty) != 0) {
+        return false;
+    }
+
+    applyLineSettings(tty, config);
+
+    if (ioctl(serial_fd, TCSETS2, &tty) != 0) {
+        std::cerr << "Error setting serial configuration (" << config.baud_rate << " baud): " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool ReliableConnectionLinux::setBaudRate(uint32_t baud_rate)
+{
+    SerialConfig new_config = config;
+    new_config.baud_rate = baud_rate;
+    return setConfig(new_config);
+}
+
+void ReliableConnectionLinux::ioThreadFunction()
+{
+    struct epoll_event events[2];
+
+    if (realtime.priority > 0 || realtime.cpu >= 0) {
+        RealtimeThread::configureCurrentThread(realtime);
+    }
+
+    // Busy polling asks epoll without sleeping, so the port, queued writes
+    // and end() are all still noticed in the same place
+    int timeout = realtime.busy_poll ? 0 : -1;
+
+    while (running.load()) {
+        int ready = epoll_wait(epoll_fd, events, 2, timeout);
+
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll error: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int e = 0; e < ready; e++) {
+            if (events[e].data.fd == wake_fd) {
+                // write() queued bytes, or end() is stopping us
+                uint64_t count;
+                if (::read(wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                    std::cerr << "Failed to reset wakeup: " << strerror(errno) << std::endl;
+                }
+                drainTx();
+                continue;
+            }
+
+            if (events[e].events & EPOLLIN) {
+                if (!drainRx()) {
+                    stopIo();
+                    return;
+                }
+            }
+
+            if (events[e].events & EPOLLOUT) {
+                drainTx();
+            }
+
+            if (events[e].events & (EPOLLHUP | EPOLLERR)) {
+                std::cerr << "Serial device " << device_path << " hung up" << std::endl;
+                stopIo();
+                return;
+            }
+        }
+    }
+
+    // Best effort to get out whatever write() queued before end()
+    drainTx();
+    stopIo();
+}
+
+// Every way out of the I/O thread goes through here, so a write() waiting
+// for ring space or a flush() waiting for idle sees it gone and returns
+void ReliableConnectionLinux::stopIo()
+{
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex);
+        running.store(false);
+        tx_idle = true;
+    }
+    tx_space.notify_all();
+}
+
+bool ReliableConnectionLinux::drainRx()
+{
+    char buffer[maxReadSize];
+
+    // Drain everything the driver has buffered
+    while (true) {
+        ssize_t bytes_read = ::read(serial_fd, buffer, sizeof(buffer));
+
+        if (bytes_read > 0) {
+            if (debug_mode) {
+                std::cout << "Raw serial (" << bytes_read << " bytes)" << std::endl;
+            }
+
+            size_t stored = ring.put(buffer, static_cast<size_t>(bytes_read));
+            if (stored < static_cast<size_t>(bytes_read)) {
+                buffer_full.store(true);
+                std::cerr << "Ring buffer full! Dropping data." << std::endl;
+            }
+
+            // Check if we need to send XOFF
+            if (!paused.load() && xonXoffEnabled.load() && ring.shouldSendXOFF()) {
+                sendFlowControlChar(XOFF);
+                paused.store(true);
+            }
+            continue;
+        }
+
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            std::cerr << "Read error: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+void ReliableConnectionLinux::drainTx()
+{
+    while (true) {
+        if (tx_offset == tx_length) {
+            {
+                std::lock_guard<std::mutex> lock(tx_mutex);
+                tx_length = tx_ring.get(tx_buffer, sizeof(tx_buffer));
+                tx_offset = 0;
+                if (tx_length == 0) {
+                    tx_idle = true;
+                }
+            }
+            tx_space.notify_all();
+
+            if (tx_length == 0) {
+                setWriteInterest(false);
+                return;
+            }
+        }
+
+        ssize_t written;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            written = ::write(serial_fd, tx_buffer + tx_offset, tx_length - tx_offset);
+        }
+
+        if (written >= 0) {
+            tx_offset += written;
+            continue;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Driver queue full: come back on EPOLLOUT
+            setWriteInterest(true);
+            return;
+        }
+
+        std::cerr << "Write error: " << strerror(errno) << std::endl;
+        tx_offset = tx_length;
+    }
+}
+
+void ReliableConnectionLinux::setWriteInterest(bool enable)
+{
+    if (enable == write_interest) {
+        return;
+    }
+
+    struct epoll_event event = {};
+    event.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.fd = serial_fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &event) == 0) {
+        write_interest = enable;
+    }
+}
+
+bool ReliableConnectionLinux::setSoftwareFlowControl(bool enable)
+{
+    struct termios2 tty;
+    if (ioctl(serial_fd, TCGETS2, &tty) != 0) {
+        return false;
+    }
+
+    if (enable) {
+        tty.c_iflag |= (IXON | IXOFF);
+    } else {
+        tty.c_iflag &= ~(IXON | IXOFF);
+    }
+
+    return ioctl(serial_fd, TCSETS2, &tty) == 0;
+}
+
+void ReliableConnectionLinux::enableXonXoff()
+{
+    xonXoffEnabled.store(true);
+
+    if (serial_fd >= 0) {
+        setSoftwareFlowControl(true);
+    }
+}
+
+void ReliableConnectionLinux::disableXonXoff()
+{
+    xonXoffEnabled.store(false);
+
+    if (serial_fd >= 0) {
+        setSoftwareFlowControl(false);
+    }
+}
+
+void ReliableConnectionLinux::sendFlowControlChar(char c)
+{
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (serial_fd >= 0 && !writeAll(&c, 1)) {
+        std::cerr << "Failed to send flow control character: " << strerror(errno) << std::endl;
+    }
+}
+
+void ReliableConnectionLinux::resumeIfDrained()
+{
+    if (paused.load() && xonXoffEnabled.load() && ring.shouldSendXON()) {
+        sendFlowControlChar(XON);
+        paused.store(false);
+    }
+}
+
+int ReliableConnectionLinux::tryReadOne()
+{
+    char c;
+    if (ring.get(c)) {
+        return static_cast<unsigned char>(c);
+    }
+    return -1;
+}
+
+char ReliableConnectionLinux::readOne()
+{
+    char c;
+    if (ring.get(c)) {
+        return c;
+    }
+    return 0; // Non-blocking, return 0 if no data
+}
+
+std::vector<char> ReliableConnectionLinux::read()
+{
+    return read(maxReadSize);
+}
+
+std::vector<char> ReliableConnectionLinux::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    results.resize(ring.get(results.data(), results.size()));
+
+    resumeIfDrained();
+
+    return results;
+}
+
+bool ReliableConnectionLinux::writeAll(const char* data, size_t length)
+{
+    size_t total_written = 0;
+    while (total_written < length) {
+        ssize_t written = ::write(serial_fd, data + total_written, length - total_written);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Sleep until the driver has room rather than spinning
+                struct pollfd pfd = {serial_fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+
+            return false;
+        }
+
+        total_written += written;
+    }
+
+    return true;
+}
+
+void ReliableConnectionLinux::write(std::vector<char> bs)
+{
+    if (bs.empty() || serial_fd < 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(tx_mutex);
+
+    size_t queued = 0;
+    while (queued < bs.size() && running.load()) {
+        size_t n = tx_ring.put(bs.data() + queued, bs.size() - queued);
+        if (n > 0) {
+            queued += n;
+
+            // The I/O thread only needs a nudge when it has gone idle
+            if (tx_idle) {
+                tx_idle = false;
+                wake();
+            }
+            continue;
+        }
+
+        // TX ring full: wait for the I/O thread to make room
+        tx_space.wait(lock, [this] { return !tx_ring.full() || !running.load(); });
+    }
+}
+
+void ReliableConnectionLinux::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        tx_space.wait(lock, [this] { return tx_idle || !running.load(); });
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (serial_fd >= 0) {
+        ioctl(serial_fd, TCSBRK, 1); // tcdrain()
+    }
+}
+
+void ReliableConnectionLinux::wake()
+{
+    uint64_t one = 1;
+    if (::write(wake_fd, &one, sizeof(one)) < 0) {
+        std::cerr << "Failed to wake I/O thread: " << strerror(errno) << std::endl;
+    }
+}
+
+void ReliableConnectionLinux::setRealtime(const RealtimeOptions& options)
+{
+    realtime = options;
+}
+
+void ReliableConnectionLinux::setDebugMode(bool enable)
+{
+    debug_mode = enable;
+}
+
+bool ReliableConnectionLinux::availableForReading()
+{
+    return ring.available();
+}
@@ -0,0 +1,131 @@
+#ifndef _RELIABLE_CONNECTION_LINUX_H_
+#define _RELIABLE_CONNECTION_LINUX_H_
+
+#include <Connection.h>
+#include <ring_buffer.h>
+#include <RealtimeThread.h>
+#include <SerialConfig.h>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// Ring and read sizes, overridable with -D for the whole build (library
+// and callers alike, e.g. add_compile_definitions). Rings must be powers
+// of two.
+#ifndef TRANSMISSION_SERIAL_BUFFER_SIZE
+#define TRANSMISSION_SERIAL_BUFFER_SIZE 4096
+#endif
+
+#ifndef TRANSMISSION_SERIAL_READ_SIZE
+#define TRANSMISSION_SERIAL_READ_SIZE 1024
+#endif
+
+// Linux serial backend. Same thread-plus-ring design as
+// ReliableConnectionMacOS, but a single I/O thread sleeps in epoll on the
+// port and an eventfd, so it wakes on the first byte, drains queued writes
+// as soon as the driver has room, and end() returns immediately. Baud rates
+// are set with termios2/BOTHER, so any rate the UART supports works, not
+// just the Bxxx constants. Framing and RTS/CTS come from SerialConfig; its
+// FIFO threshold and idle timeout are left to the kernel driver.
+//
+// setRealtime() opts the I/O thread into SCHED_FIFO, CPU pinning, locked
+// memory, the driver's low latency mode and busy polling, for control
+// loops that need RX latency under 100 us.
+class ReliableConnectionLinux : public Connection
+{
+    public:
+        static const char XON  = 0x11;
+        static const char XOFF = 0x13;
+
+        static const int maxBufferSize = TRANSMISSION_SERIAL_BUFFER_SIZE;
+        static const int maxReadSize = TRANSMISSION_SERIAL_READ_SIZE;
+
+        ReliableConnectionLinux(const std::string& device_path = "/dev/ttyUSB0", const SerialConfig& config = SerialConfig());
+        ~ReliableConnectionLinux();
+
+        // Open and configure a port without starting a thread, for callers
+        // that drive it from an EventLoop. Returns -1 on failure.
+        static int openSerialPort(const std::string& device_path, const SerialConfig& config = SerialConfig());
+
+        void begin();
+        // Start on a port that is already open and configured, such as one
+        // handed over with UnixSocketConnection::sendDescriptor(); takes
+        // ownership of fd and skips the open and termios setup
+        void begin(int fd);
+        void end();
+        bool isOpen() const;
+        void enableXonXoff();
+        void disableXonXoff();
+        void setDebugMode(bool enable);
+
+        // Applied by the next begin()
+        void setRealtime(const RealtimeOptions& options);
+
+        // Take effect immediately if the port is open
+        bool setConfig(const SerialConfig& config);
+        bool setBaudRate(uint32_t baud_rate);
+
+        // Block until every queued byte has been written and has left the UART
+        void flush();
+
+        using Connection::write;
+
+        // Connection interface
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        // Queues the bytes for the I/O thread and returns; blocks only
+        // while the TX ring is full
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        // Convenience method (not in base interface)
+        std::vector<char> read();
+
+    private:
+        bool debug_mode = false;
+        std::string device_path;
+        SerialConfig config;
+        int serial_fd;
+        int epoll_fd;
+        int wake_fd;
+        std::thread io_thread;
+        std::atomic<bool> running;
+        std::atomic<bool> xonXoffEnabled;
+        std::atomic<bool> paused;
+        std::atomic<bool> buffer_full;
+        std::mutex write_mutex;
+        RealtimeOptions realtime;
+
+        FlowControlRingBuffer<char, maxBufferSize> ring;
+
+        // TX queue, filled by write() and drained by the I/O thread
+        InterruptSafeRingBuffer<char, maxBufferSize> tx_ring;
+        std::mutex tx_mutex;
+        std::condition_variable tx_space;   // Ring has room, or went idle
+        bool tx_idle = true;                // I/O thread has nothing left to send
+
+        // Owned by the I/O thread
+        char tx_buffer[maxReadSize];
+        size_t tx_offset = 0;
+        size_t tx_length = 0;
+        bool write_interest = false;
+
+        void ioThreadFunction();
+        void stopIo();
+        bool drainRx();
+        void drainTx();
+        void setWriteInterest(bool enable);
+        void wake();
+        static bool configureSerialPort(int serial_fd, const SerialConfig& config);
+        bool setSoftwareFlowControl(bool enable);
+        void sendFlowControlChar(char c);
+        void resumeIfDrained();
+        bool writeAll(const char* data, size_t length);
+        void closeDescriptors();
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "SerialShare.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+SerialShare::SerialShare(EventLoop& loop, int serial_fd, const std::string& socket_path)
+    : loop(loop), socket_path(socket_path), listen_fd(-1), serial(loop, serial_fd),
+      next_client(0), dropped_bytes(0), arbitrating(false), rearbitrate(false)
+{
+}
+
+SerialShare::~SerialShare()
+{
+    end();
+}
+
+bool SerialShare::begin(int backlog)
+{
+    if (listen_fd >= 0) {
+        return true;
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Unix socket path too long: " << socket_path << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Replace a socket file left behind by a previous run
+    unlink(socket_path.c_str());
+
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, backlog) != 0) {
+        std::cerr << "Failed to listen on " << socket_path << ": " << strerror(errno) << std::endl;
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    serial.setReadCallback([this](FdConnection&) { fanOut(); });
+    serial.setWriteCallback([this](FdConnection&) { arbitrate(); });
+    serial.setCloseCallback([this](FdConnection&) {
+        std::cerr << "Serial port closed, disconnecting clients of " << this->socket_path << std::endl;
+        loop.post([this] { clients.clear(); });
+    });
+
+    if (!serial.begin() || !loop.add(listen_fd, EPOLLIN, [this](uint32_t) { acceptClients(); })) {
+        end();
+        return false;
+    }
+
+    return true;
+}
+
+void SerialShare::end()
+{
+    clients.clear();
+    serial.end();
+
+    if (listen_fd >= 0) {
+        loop.remove(listen_fd);
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path.c_str());
+    }
+}
+
+bool SerialShare::isOpen() const
+{
+    return serial.isOpen();
+}
+
+const std::string& SerialShare::socketPath() const
+{
+    return socket_path;
+}
+
+size_t SerialShare::clientCount() const
+{
+    return clients.size();
+}
+
+uint64_t SerialShare::droppedBytes() const
+{
+    return dropped_bytes;
+}
+
+void SerialShare::acceptClients()
+{
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "accept() failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        if (!serial.isOpen()) {
+            close(fd);
+            continue;
+        }
+
+        auto client = std::make_unique<Client>();
+        client->connection = std::make_unique<FdConnection>(loop, fd);
+        client->connection->setReadCallback([this](FdConnection&) { arbitrate(); });
+        client->connection->setCloseCallback([this](FdConnection& closed) {
+            // Still inside the connection's own callback; free it afterwards
+            FdConnection* raw = &closed;
+            loop.post([this, raw] { removeClient(raw); });
+        });
+
+        if (client->connection->begin()) {
+            clients.push_back(std::move(client));
+        }
+    }
+}
+
+void SerialShare::removeClient(FdConnection* connection)
+{
+    auto it = std::find_if(clients.begin(), clients.end(),
+                           [connection](const std::unique_ptr<Client>& c) { return c->connection.get() == connection; });
+    if (it == clients.end()) {
+        return;
+    }
+
+    if ((*it)->dropped > 0) {
+        std::cerr << "Client on " << socket_path << " missed " << (*it)->dropped << " bytes" << std::endl;
+    }
+
+    clients.erase(it);
+    next_client = 0;
+}
+
+void SerialShare::fanOut()
+{
+    while (true) {
+        std::vector<char> bytes = serial.read(FdConnection::maxReadSize);
+        if (bytes.empty()) {
+            break;
+        }
+
+        for (auto& client : clients) {
+            size_t accepted = client->connection->tryWrite(bytes.data(), bytes.size());
+            if (accepted < bytes.size()) {
+                client->dropped += bytes.size() - accepted;
+                dropped_bytes += bytes.size() - accepted;
+            }
+        }
+    }
+}
+
+// Round-robin over client queues while the port has room. Reentrant calls
+// (a write to the port can drain and call back) just ask for another pass.
+void SerialShare::arbitrate()
+{
+    if (arbitrating) {
+        rearbitrate = true;
+        return;
+    }
+
+    arbitrating = true;
+
+    do {
+        rearbitrate = false;
+
+        bool progress = true;
+        while (progress && !clients.empty() && serial.isOpen()) {
+            progress = false;
+
+            for (size_t turn = 0; turn < clients.size(); turn++) {
+                size_t space = serial.writeSpace();
+                if (space == 0) {
+                    break;
+                }
+
+                Client& client = *clients[next_client % clients.size()];
+                next_client = (next_client + 1) % clients.size();
+
+                std::vector<char> bytes = client.connection->read(static_cast<int>(std::min(space, quantum)));
+                if (!bytes.empty()) {
+                    serial.tryWrite(bytes.data(), bytes.size());
+                    progress = true;
+                }
+            }
+        }
+    } while (rearbitrate);
+
+    arbitrating = false;
+}
@@ -0,0 +1,65 @@
+#ifndef _SERIAL_SHARE_H_
+#define _SERIAL_SHARE_H_
+
+#include "EventLoop.h"
+#include "FdConnection.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Shares one serial port with any number of local clients on a Unix stream
+// socket, so monitoring tools and the main application can use the device
+// at the same time. Every byte read from the port is copied to every
+// client. Bytes from clients are queued per client and written to the port
+// round-robin, at most `quantum` bytes per client per turn, so one busy
+// client cannot starve the others. A client that stops reading loses RX
+// bytes (counted in droppedBytes()) instead of stalling everyone else; a
+// client that writes faster than the port drains is held back through its
+// socket.
+class SerialShare
+{
+    public:
+        static constexpr size_t quantum = 256;
+
+        // Takes ownership of serial_fd, an open and configured port
+        SerialShare(EventLoop& loop, int serial_fd, const std::string& socket_path);
+        ~SerialShare();
+
+        SerialShare(const SerialShare&) = delete;
+        SerialShare& operator=(const SerialShare&) = delete;
+
+        bool begin(int backlog = 16);
+        void end();
+
+        // False once the port hangs up (e.g. the USB adapter was unplugged)
+        bool isOpen() const;
+
+        const std::string& socketPath() const;
+        size_t clientCount() const;
+        uint64_t droppedBytes() const;
+
+    private:
+        struct Client {
+            std::unique_ptr<FdConnection> connection;
+            uint64_t dropped = 0;
+        };
+
+        EventLoop& loop;
+        std::string socket_path;
+        int listen_fd;
+        FdConnection serial;
+        std::vector<std::unique_ptr<Client>> clients;
+        size_t next_client;
+        uint64_t dropped_bytes;
+        bool arbitrating;
+        bool rearbitrate;
+
+        void acceptClients();
+        void removeClient(FdConnection* connection);
+        void fanOut();
+        void arbitrate();
+};
+
+#endif
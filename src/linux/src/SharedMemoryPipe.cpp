@@ -0,0 +1,339 @@
+#include "SharedMemoryPipe.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <errno.h>
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "futex words must be plain 32-bit integers in shared memory");
+
+// Shared (not FUTEX_PRIVATE) operations, since the waiter may be in another process
+static void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+    struct timespec ts;
+    struct timespec* tsp = nullptr;
+
+    if (timeout != SharedMemoryPipeEnd::forever) {
+        ts.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(timeout).count();
+        ts.tv_nsec = (timeout - std::chrono::seconds(ts.tv_sec)).count();
+        tsp = &ts;
+    }
+
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, tsp, nullptr, 0);
+}
+
+static void futexWakeAll(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// Sleep until seq moves away from the value sampled before the caller found
+// the ring unusable. The waiting counter lets the other side skip the wake
+// syscall entirely when nobody is asleep.
+static void waitForChange(std::atomic<uint32_t>& seq, uint32_t sampled, std::atomic<uint32_t>& waiting,
+                          std::chrono::nanoseconds timeout)
+{
+    waiting.fetch_add(1);
+    futexWait(seq, sampled, timeout);
+    waiting.fetch_sub(1);
+}
+
+static void signalChange(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting)
+{
+    seq.fetch_add(1);
+    if (waiting.load() > 0) {
+        futexWakeAll(seq);
+    }
+}
+
+// SharedMemoryPipeEnd implementation
+constexpr std::chrono::nanoseconds SharedMemoryPipeEnd::forever;
+
+SharedMemoryPipeEnd::SharedMemoryPipeEnd(SharedMemoryPipeChannel& read_channel,
+                                         SharedMemoryPipeChannel& write_channel,
+                                         std::atomic<uint32_t>& closed)
+    : read_channel(read_channel), write_channel(write_channel), closed(closed)
+{
+}
+
+size_t SharedMemoryPipeEnd::read(char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    if (length == 0) {
+        return 0;
+    }
+
+    auto deadline = std::chrono::steady_clock::now();
+    if (timeout != forever) {
+        deadline += timeout;
+    }
+
+    while (true) {
+        uint32_t seq = read_channel.data_seq.load();
+
+        size_t n = read_channel.ring.get(data, length);
+        if (n > 0) {
+            signalChange(read_channel.space_seq, read_channel.writers_waiting);
+            return n;
+        }
+
+        if (closed.load() || timeout.count() == 0) {
+            return 0;
+        }
+
+        std::chrono::nanoseconds remaining = forever;
+        if (timeout != forever) {
+            remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining.count() <= 0) {
+                return 0;
+            }
+        }
+
+        waitForChange(read_channel.data_seq, seq, read_channel.readers_waiting, remaining);
+    }
+}
+
+size_t SharedMemoryPipeEnd::write(const char* data, size_t length, std::chrono::nanoseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now();
+    if (timeout != forever) {
+        deadline += timeout;
+    }
+
+    size_t total = 0;
+    while (total < length && !closed.load()) {
+        uint32_t seq = write_channel.space_seq.load();
+
+        size_t n = write_channel.ring.put(data + total, length - total);
+        if (n > 0) {
+            total += n;
+            signalChange(write_channel.data_seq, write_channel.readers_waiting);
+            continue;
+        }
+
+        if (timeout.count() == 0) {
+            break;
+        }
+
+        std::chrono::nanoseconds remaining = forever;
+        if (timeout != forever) {
+            remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining.count() <= 0) {
+                break;
+            }
+        }
+
+        waitForChange(write_channel.space_seq, seq, write_channel.writers_waiting, remaining);
+    }
+
+    return total;
+}
+
+int SharedMemoryPipeEnd::tryReadOne()
+{
+    char c;
+    if (read(&c, 1, std::chrono::nanoseconds::zero()) == 1) {
+        return static_cast<unsigned char>(c);
+    }
+    return -1;
+}
+
+char SharedMemoryPipeEnd::readOne()
+{
+    char c = 0;
+    read(&c, 1, forever);
+    return c; // 0 if the pipe was closed
+}
+
+std::vector<char> SharedMemoryPipeEnd::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+
+    size_t total = 0;
+    while (total < results.size()) {
+        size_t n = read(results.data() + total, results.size() - total, forever);
+        if (n == 0) {
+            break; // Closed
+        }
+        total += n;
+    }
+
+    results.resize(total);
+    return results;
+}
+
+void SharedMemoryPipeEnd::write(std::vector<char> bs)
+{
+    write(bs.data(), bs.size(), forever);
+}
+
+bool SharedMemoryPipeEnd::availableForReading()
+{
+    return read_channel.ring.available();
+}
+
+size_t SharedMemoryPipeEnd::available() const
+{
+    return read_channel.ring.count();
+}
+
+size_t SharedMemoryPipeEnd::writeSpace() const
+{
+    return write_channel.ring.free();
+}
+
+void SharedMemoryPipeEnd::close()
+{
+    closed.store(1);
+
+    // Move every seq word before waking, so a sleeper that sampled it just
+    // before the flag went up cannot go to sleep on the old value and miss
+    // the wake; then wake sleepers on both sides so they observe the flag
+    read_channel.data_seq.fetch_add(1);
+    read_channel.space_seq.fetch_add(1);
+    write_channel.data_seq.fetch_add(1);
+    write_channel.space_seq.fetch_add(1);
+
+    futexWakeAll(read_channel.data_seq);
+    futexWakeAll(read_channel.space_seq);
+    futexWakeAll(write_channel.data_seq);
+    futexWakeAll(write_channel.space_seq);
+}
+
+bool SharedMemoryPipeEnd::isClosed() const
+{
+    return closed.load() != 0;
+}
+
+// SharedMemoryPipe implementation
+SharedMemoryPipe::SharedMemoryPipe(const std::string& name)
+    : name(name.empty() || name[0] == '/' ? name : "/" + name), owner(false), segment(nullptr)
+{
+}
+
+SharedMemoryPipe::~SharedMemoryPipe()
+{
+    close();
+}
+
+bool SharedMemoryPipe::create()
+{
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(Segment)) != 0) {
+        std::cerr << "Failed to size shared memory " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    owner = true;
+    if (!map(fd)) {
+        shm_unlink(name.c_str());
+        owner = false;
+        return false;
+    }
+
+    new (segment) Segment();
+    segment->version = version;
+
+    // Publish the magic last so open() never attaches to a half-built segment
+    __atomic_store_n(&segment->magic, magic, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool SharedMemoryPipe::open()
+{
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "Failed to open shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    // A size other than ours is not a pipe, or one built with another
+    // TRANSMISSION_SHM_PIPE_SIZE
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != sizeof(Segment)) {
+        std::cerr << "Shared memory " << name << " is not a pipe of this size" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    if (!map(fd)) {
+        return false;
+    }
+
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != magic || segment->version != version) {
+        std::cerr << "Shared memory " << name << " has an unknown format" << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SharedMemoryPipe::map(int fd)
+{
+    void* mapped = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    segment = static_cast<Segment*>(mapped);
+    end_a = std::make_unique<SharedMemoryPipeEnd>(segment->b_to_a, segment->a_to_b, segment->closed);
+    end_b = std::make_unique<SharedMemoryPipeEnd>(segment->a_to_b, segment->b_to_a, segment->closed);
+
+    return true;
+}
+
+void SharedMemoryPipe::close()
+{
+    if (!segment) {
+        return;
+    }
+
+    end_a.reset();
+    end_b.reset();
+
+    munmap(segment, sizeof(Segment));
+    segment = nullptr;
+
+    if (owner) {
+        shm_unlink(name.c_str());
+        owner = false;
+    }
+}
+
+SharedMemoryPipeEnd& SharedMemoryPipe::getEndA()
+{
+    return *end_a;
+}
+
+SharedMemoryPipeEnd& SharedMemoryPipe::getEndB()
+{
+    return *end_b;
+}
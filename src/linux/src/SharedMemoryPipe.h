@@ -0,0 +1,109 @@
+#ifndef _SHARED_MEMORY_PIPE_H_
+#define _SHARED_MEMORY_PIPE_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// One direction of a SharedMemoryPipe, laid out inside the shared segment.
+// Sequence counters double as futex words so a sleeping reader or writer in
+// another process is woken without any syscall on the uncontended path.
+struct SharedMemoryPipeChannel
+{
+    static const int bufferSize = TRANSMISSION_SHM_PIPE_SIZE;
+
+    InterruptSafeRingBuffer<char, bufferSize> ring;
+    std::atomic<uint32_t> data_seq;       // Bumped after every write
+    std::atomic<uint32_t> space_seq;      // Bumped after every read
+    std::atomic<uint32_t> readers_waiting;
+    std::atomic<uint32_t> writers_waiting;
+};
+
+class SharedMemoryPipeEnd : public Connection
+{
+    public:
+        static constexpr std::chrono::nanoseconds forever = std::chrono::nanoseconds::max();
+
+        SharedMemoryPipeEnd(SharedMemoryPipeChannel& read_channel,
+                            SharedMemoryPipeChannel& write_channel,
+                            std::atomic<uint32_t>& closed);
+
+        using Connection::write;
+
+        // Connection interface. readOne() and read(size) block until the
+        // requested bytes arrive or the pipe is closed; write() blocks until
+        // every byte has been accepted or the pipe is closed.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        // Timed variants. A zero timeout never blocks.
+        size_t read(char* data, size_t length, std::chrono::nanoseconds timeout);
+        size_t write(const char* data, size_t length, std::chrono::nanoseconds timeout);
+
+        size_t available() const;
+        size_t writeSpace() const;
+
+        // Close the pipe for both processes, waking every blocked call
+        void close();
+        bool isClosed() const;
+
+    private:
+        SharedMemoryPipeChannel& read_channel;
+        SharedMemoryPipeChannel& write_channel;
+        std::atomic<uint32_t>& closed;
+};
+
+// Pipe whose two ring buffers live in a POSIX shared-memory segment, so two
+// processes exchange bytes with one copy in and one copy out and no syscalls
+// unless one side has to sleep.
+//
+// One process calls create(), the other open() with the same name; each then
+// uses a different end. The creator unlinks the segment when it closes.
+class SharedMemoryPipe
+{
+    public:
+        explicit SharedMemoryPipe(const std::string& name);
+        ~SharedMemoryPipe();
+
+        SharedMemoryPipe(const SharedMemoryPipe&) = delete;
+        SharedMemoryPipe& operator=(const SharedMemoryPipe&) = delete;
+
+        bool create();
+        bool open();
+        void close();
+
+        SharedMemoryPipeEnd& getEndA();
+        SharedMemoryPipeEnd& getEndB();
+
+    private:
+        struct Segment {
+            uint32_t magic;
+            uint32_t version;
+            std::atomic<uint32_t> closed;
+            SharedMemoryPipeChannel a_to_b;
+            SharedMemoryPipeChannel b_to_a;
+        };
+
+        static constexpr uint32_t magic = 0x50494d53; // "SMIP"
+        static constexpr uint32_t version = 1;
+
+        std::string name;
+        bool owner;
+        Segment* segment;
+
+        std::unique_ptr<SharedMemoryPipeEnd> end_a;
+        std::unique_ptr<SharedMemoryPipeEnd> end_b;
+
+        bool map(int fd);
+};
+
+#endif
@@ -0,0 +1,281 @@
+#include "TcpServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// How long a worker that cannot even shed a connection stops accepting
+static const std::chrono::milliseconds acceptPause(100);
+
+TcpServer::TcpServer(uint16_t port, const char* host, unsigned workers)
+    : host(host), bound_port(port), worker_count(workers), running(false), connection_count(0)
+{
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+TcpServer::~TcpServer()
+{
+    end();
+}
+
+void TcpServer::setConnectHandler(Handler handler)
+{
+    connect_handler = std::move(handler);
+}
+
+void TcpServer::setReadHandler(Handler handler)
+{
+    read_handler = std::move(handler);
+}
+
+void TcpServer::setCloseHandler(Handler handler)
+{
+    close_handler = std::move(handler);
+}
+
+int TcpServer::openListener(int backlog)
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(bound_port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid listen address: " << host << std::endl;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+        std::cerr << "Failed to set SO_REUSEPORT: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(fd, backlog) != 0) {
+        std::cerr << "Failed to listen on " << host << ":" << bound_port << ": " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    // With port 0 the first listener picks the port and the rest share it
+    socklen_t length = sizeof(address);
+    if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&address), &length) == 0) {
+        bound_port = ntohs(address.sin_port);
+    }
+
+    return fd;
+}
+
+bool TcpServer::begin(int backlog)
+{
+    if (running.load()) {
+        return true;
+    }
+
+    for (unsigned i = 0; i < worker_count; i++) {
+        auto worker = std::make_unique<Worker>();
+        if (!worker->loop.begin()) {
+            end();
+            return false;
+        }
+
+        worker->listen_fd = openListener(backlog);
+        if (worker->listen_fd < 0) {
+            end();
+            return false;
+        }
+
+        // Out of descriptors, accept() fails without taking the connection
+        // off the backlog, and the level-triggered listener fires again at
+        // once; this one is closed to make room to take and drop it
+        worker->reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+        Worker* raw = worker.get();
+        if (!worker->loop.add(worker->listen_fd, EPOLLIN, [this, raw](uint32_t) { acceptAll(*raw); })) {
+            end();
+            return false;
+        }
+
+        workers.push_back(std::move(worker));
+    }
+
+    running.store(true);
+
+    for (auto& worker : workers) {
+        Worker* raw = worker.get();
+        worker->thread = std::thread([raw] { raw->loop.run(); });
+    }
+
+    return true;
+}
+
+void TcpServer::end()
+{
+    running.store(false);
+
+    // A worker thread may not have reached run() yet; the loop keeps the
+    // stop for it, so the joins below cannot hang
+    for (auto& worker : workers) {
+        worker->loop.stop();
+    }
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+
+        // The loop has stopped, so its connections can go from this thread
+        connection_count -= worker->connections.size();
+        worker->connections.clear();
+
+        if (worker->listen_fd >= 0) {
+            worker->loop.remove(worker->listen_fd);
+            close(worker->listen_fd);
+            worker->listen_fd = -1;
+        }
+
+        if (worker->reserve_fd >= 0) {
+            close(worker->reserve_fd);
+            worker->reserve_fd = -1;
+        }
+
+        worker->loop.end();
+    }
+
+    workers.clear();
+}
+
+bool TcpServer::isRunning() const
+{
+    return running.load();
+}
+
+uint16_t TcpServer::port() const
+{
+    return bound_port;
+}
+
+unsigned TcpServer::workerCount() const
+{
+    return worker_count;
+}
+
+size_t TcpServer::connectionCount() const
+{
+    return connection_count.load();
+}
+
+void TcpServer::acceptAll(Worker& worker)
+{
+    while (true) {
+        int fd = accept4(worker.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE) {
+                std::cerr << "accept() failed: " << strerror(errno) << ", shedding connections" << std::endl;
+                while (shedOne(worker)) {
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    pauseAccepting(worker);
+                }
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "accept() failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        // Device traffic is small frames; don't let Nagle hold them back
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto connection = std::make_unique<FdConnection>(worker.loop, fd);
+        if (read_handler) {
+            connection->setReadCallback(read_handler);
+        }
+
+        Worker* raw = &worker;
+        connection->setCloseCallback([this, raw, fd](FdConnection& closed) {
+            if (close_handler) {
+                close_handler(closed);
+            }
+
+            // Still inside the connection's own callback; free it afterwards
+            raw->loop.post([this, raw, fd] {
+                if (raw->connections.erase(fd) > 0) {
+                    connection_count--;
+                }
+            });
+        });
+
+        FdConnection& added = *connection;
+        worker.connections[fd] = std::move(connection);
+        connection_count++;
+
+        if (connect_handler) {
+            connect_handler(added);
+        }
+
+        if (!added.begin()) {
+            worker.connections.erase(fd);
+            connection_count--;
+        }
+    }
+}
+
+// Accepts one connection into the reserve descriptor's slot and closes it,
+// so the peer sees a reset rather than a hang. Leaves errno from accept()
+// when it returns false.
+bool TcpServer::shedOne(Worker& worker)
+{
+    if (worker.reserve_fd >= 0) {
+        close(worker.reserve_fd);
+        worker.reserve_fd = -1;
+    }
+
+    int fd = accept4(worker.listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    int accept_errno = errno;
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    worker.reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    errno = accept_errno;
+    return fd >= 0;
+}
+
+// Without a reserve (ENFILE can take it too) stop polling the listener for
+// a while instead of spinning on it; the backlog waits in the kernel
+void TcpServer::pauseAccepting(Worker& worker)
+{
+    if (!worker.loop.modify(worker.listen_fd, 0)) {
+        return;
+    }
+
+    Worker* raw = &worker;
+    worker.loop.addTimer(acceptPause, [raw] {
+        if (raw->listen_fd >= 0) {
+            raw->loop.modify(raw->listen_fd, EPOLLIN);
+        }
+    });
+}
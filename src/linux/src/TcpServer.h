@@ -0,0 +1,75 @@
+#ifndef _TCP_SERVER_H_
+#define _TCP_SERVER_H_
+
+#include "EventLoop.h"
+#include "FdConnection.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Accepts and multiplexes thousands of device connections (for example
+// ESP32s running ReliableConnectionWiFiTcp). Each worker thread owns a
+// listening socket bound with SO_REUSEPORT, so the kernel spreads incoming
+// connections across workers without a shared accept lock, and an
+// EventLoop that drives all of its peers as FdConnections. Handlers run on
+// the worker that owns the connection.
+class TcpServer
+{
+    public:
+        using Handler = std::function<void(FdConnection&)>;
+
+        // workers == 0 uses one per hardware thread
+        TcpServer(uint16_t port, const char* host = "0.0.0.0", unsigned workers = 0);
+        ~TcpServer();
+
+        TcpServer(const TcpServer&) = delete;
+        TcpServer& operator=(const TcpServer&) = delete;
+
+        // Set before begin()
+        void setConnectHandler(Handler handler);
+        void setReadHandler(Handler handler);
+        void setCloseHandler(Handler handler);
+
+        bool begin(int backlog = 4096);
+        void end();
+        bool isRunning() const;
+
+        // The bound port, useful when constructed with port 0
+        uint16_t port() const;
+        unsigned workerCount() const;
+        size_t connectionCount() const;
+
+    private:
+        struct Worker {
+            EventLoop loop;
+            int listen_fd = -1;
+            int reserve_fd = -1;        // Given up to shed a peer at EMFILE
+            std::thread thread;
+            std::unordered_map<int, std::unique_ptr<FdConnection>> connections;
+        };
+
+        std::string host;
+        uint16_t bound_port;
+        unsigned worker_count;
+        std::atomic<bool> running;
+        std::atomic<size_t> connection_count;
+
+        Handler connect_handler;
+        Handler read_handler;
+        Handler close_handler;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        int openListener(int backlog);
+        void acceptAll(Worker& worker);
+        bool shedOne(Worker& worker);
+        void pauseAccepting(Worker& worker);
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef TRANSMISSION_TRANSMISSION_LINUX_H
+#define TRANSMISSION_TRANSMISSION_LINUX_H
+
+#include "CaptureFile.h"
+#include "CaptureConnection.h"
+#include "CaptureReplayer.h"
+#include "BlockingPipe.h"
+#include "SharedMemoryPipe.h"
+#include "ReliableConnectionLinux.h"
+#include "EventLoop.h"
+#include "FdConnection.h"
+#include "IoUringLoop.h"
+#include "ConnectionDriver.h"
+#include "TcpServer.h"
+#include "SerialShare.h"
+
+#endif //TRANSMISSION_TRANSMISSION_LINUX_H
@@ -1,5 +1,7 @@
 #include "ReliableConnectionMacOS.h"
 
+#include <IOKit/serial/ioss.h>
+#include <sys/ioctl.h>
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
@@ -8,8 +10,8 @@
 #include <cstring>
 #include <errno.h>
 
-ReliableConnectionMacOS::ReliableConnectionMacOS(const std::string& device_path)
-    : device_path(device_path), serial_fd(-1), running(false), xonXoffEnabled(false), 
+ReliableConnectionMacOS::ReliableConnectionMacOS(const std::string& device_path, const SerialConfig& config)
+    : device_path(device_path), config(config), serial_fd(-1), running(false), xonXoffEnabled(false), 
       paused(false), buffer_full(false)
 {
 }
@@ -38,9 +40,18 @@ void ReliableConnectionMacOS::begin()
         return;
     }
 
+    if (realtime.lock_memory) {
+        RealtimeThread::lockMemory();
+    }
+
+    if (realtime.low_latency) {
+        RealtimeThread::setSerialLowLatency(serial_fd, true);
+    }
+
     // Start the read thread
     running.store(true);
     read_thread = std::thread(&ReliableConnectionMacOS::readThreadFunction, this);
+    write_thread = std::thread(&ReliableConnectionMacOS::writeThreadFunction, this);
 
     // Send initial XON if flow control is enabled
     if (xonXoffEnabled.load()) {
@@ -56,12 +67,21 @@ void ReliableConnectionMacOS::end()
         return;
     }
 
-    running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex);
+        running.store(false);
+    }
+    tx_ready.notify_all();
+    tx_space.notify_all();
 
     if (read_thread.joinable()) {
         read_thread.join();
     }
 
+    if (write_thread.joinable()) {
+        write_thread.join();
+    }
+
     if (serial_fd >= 0) {
         close(serial_fd);
         serial_fd = -1;
@@ -70,6 +90,11 @@ void ReliableConnectionMacOS::end()
 
 bool ReliableConnectionMacOS::configureSerialPort()
 {
+    if (!config.valid()) {
+        std::cerr << "Invalid serial configuration for " << device_path << std::endl;
+        return false;
+    }
+
     struct termios tty;
     memset(&tty, 0, sizeof(tty));
 
@@ -78,16 +103,6 @@ bool ReliableConnectionMacOS::configureSerialPort()
         return false;
     }
 
-    // Set baud rate (115200)
-    cfsetospeed(&tty, B115200);
-    cfsetispeed(&tty, B115200);
-
-    // 8-bit characters, no parity, 1 stop bit
-    tty.c_cflag &= ~PARENB;  // No parity
-    tty.c_cflag &= ~CSTOPB;  // 1 stop bit
-    tty.c_cflag &= ~CSIZE;   // Clear size bits
-    tty.c_cflag |= CS8;      // 8 bits per byte
-    tty.c_cflag &= ~CRTSCTS; // Disable hardware flow control
     tty.c_cflag |= CREAD | CLOCAL; // Enable reading and ignore modem control lines
 
     // Raw input mode
@@ -109,28 +124,109 @@ bool ReliableConnectionMacOS::configureSerialPort()
         return false;
     }
 
+    if (!applyLineSettings()) {
+        return false;
+    }
+
     // Flush any existing data
     tcflush(serial_fd, TCIOFLUSH);
 
     return true;
 }
 
+bool ReliableConnectionMacOS::applyLineSettings()
+{
+    struct termios tty;
+    if (tcgetattr(serial_fd, &tty) != 0) {
+        std::cerr << "Error getting terminal attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    tty.c_cflag &= ~CSIZE;
+    switch (config.data_bits) {
+        case 5: tty.c_cflag |= CS5; break;
+        case 6: tty.c_cflag |= CS6; break;
+        case 7: tty.c_cflag |= CS7; break;
+        default: tty.c_cflag |= CS8; break;
+    }
+
+    if (config.stop_bits == 2) {
+        tty.c_cflag |= CSTOPB;
+    } else {
+        tty.c_cflag &= ~CSTOPB;
+    }
+
+    tty.c_cflag &= ~(PARENB | PARODD);
+    if (config.parity == SerialConfig::Parity::even) {
+        tty.c_cflag |= PARENB;
+    } else if (config.parity == SerialConfig::Parity::odd) {
+        tty.c_cflag |= PARENB | PARODD;
+    }
+
+    if (config.hardware_flow_control) {
+        tty.c_cflag |= CRTSCTS;
+    } else {
+        tty.c_cflag &= ~CRTSCTS;
+    }
+
+    if (tcsetattr(serial_fd, TCSANOW, &tty) != 0) {
+        std::cerr << "Error setting terminal attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // termios only takes the Bxxx constants; IOSSIOSPEED sets any rate the
+    // driver supports, and must come after tcsetattr(), which resets it
+    speed_t speed = config.baud_rate;
+    if (ioctl(serial_fd, IOSSIOSPEED, &speed) != 0) {
+        std::cerr << "Error setting baud rate " << config.baud_rate << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool ReliableConnectionMacOS::setConfig(const SerialConfig& new_config)
+{
+    if (!new_config.valid()) {
+        std::cerr << "Invalid serial configuration for " << device_path << std::endl;
+        return false;
+    }
+
+    config = new_config;
+
+    if (serial_fd < 0) {
+        return true;
+    }
+
+    return applyLineSettings();
+}
+
 void ReliableConnectionMacOS::readThreadFunction()
 {
-    char buffer[1024];  // INCREASED: Larger buffer for reading
+    char buffer[maxReadSize];
     fd_set read_fds;
     struct timeval timeout;
 
+    if (realtime.priority > 0 || realtime.cpu >= 0) {
+        RealtimeThread::configureCurrentThread(realtime);
+    }
+
     while (running.load()) {
-        FD_ZERO(&read_fds);
-        FD_SET(serial_fd, &read_fds);
-        
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 10000; // DECREASED: 10ms timeout for faster response
-
-        int result = select(serial_fd + 1, &read_fds, nullptr, nullptr, &timeout);
-        
-        if (result > 0 && FD_ISSET(serial_fd, &read_fds)) {
+        int result = 1;
+
+        // Busy polling goes straight to the nonblocking read; otherwise
+        // sleep in select() until the port is readable
+        if (!realtime.busy_poll) {
+            FD_ZERO(&read_fds);
+            FD_SET(serial_fd, &read_fds);
+
+            timeout.tv_sec = 0;
+            timeout.tv_usec = 10000; // DECREASED: 10ms timeout for faster response
+
+            result = select(serial_fd + 1, &read_fds, nullptr, nullptr, &timeout);
+        }
+
+        if (result > 0) {
             int bytes_read = ::read(serial_fd, buffer, sizeof(buffer));
             
             if (bytes_read > 0) {
@@ -233,44 +329,22 @@ char ReliableConnectionMacOS::readOne()
 std::vector<char> ReliableConnectionMacOS::read()
 {
     std::vector<char> results;
-    results.reserve(maxReadSize);
-
-    char c;
-    int count = 0;
-    
-    // IMPROVED: Try to read complete escape sequences
-    bool in_escape = false;
-    int escape_timeout = 0;
-    
-    while (count < maxReadSize) {
-        if (!ring.get(c)) {
-            // No more data available
-            if (in_escape && escape_timeout < 10) {
-                // We're in the middle of an escape sequence, wait a bit for more data
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
-                escape_timeout++;
-                continue;
-            }
-            break;
-        }
-        
-        results.push_back(c);
-        count++;
-        
-        // Track if we're in an escape sequence
-        if (c == 0x1B) {
-            in_escape = true;
-            escape_timeout = 0;
-        } else if (in_escape) {
-            // Check if this completes the escape sequence
-            if (c >= 0x40 && c <= 0x7E) {
-                // This is a final character for most escape sequences
-                in_escape = false;
-            } else if (count > 1 && results[count-2] == 0x1B && c == '\\') {
-                // ST (String Terminator) - ESC \
-                in_escape = false;
-            }
-        }
+    results.reserve(maxReadSize + EscapeTokenizer::maxSequenceLength);
+
+    auto append = [&results](EscapeTokenizer::Token, const char* data, size_t length) {
+        results.insert(results.end(), data, data + length);
+    };
+
+    // Keep escape sequences whole: one cut off at the end of this chunk is
+    // held by the tokenizer and completed by a later read()
+    char buffer[maxReadSize];
+    size_t count = ring.get(buffer, sizeof(buffer));
+    if (count > 0) {
+        escapes.feed(buffer, count, append);
+    } else if (escapes.pending()) {
+        // Nothing arrived since the last read(), so this is a lone ESC
+        // keypress or a cut-off sequence; pass it on rather than wait
+        escapes.flush(append);
     }
 
     // Check if we should resume flow control
@@ -289,7 +363,7 @@ std::vector<char> ReliableConnectionMacOS::read(int size)
 
     char c;
     int count = 0;
-    while (ring.get(c) && count < size) {
+    while (count < size && ring.get(c)) {
         results.push_back(c);
         count++;
     }
@@ -309,27 +383,102 @@ void ReliableConnectionMacOS::write(std::vector<char> bs)
         return;
     }
 
+    std::unique_lock<std::mutex> lock(tx_mutex);
+
+    size_t queued = 0;
+    while (queued < bs.size() && running.load()) {
+        size_t n = tx_ring.put(bs.data() + queued, bs.size() - queued);
+        if (n > 0) {
+            queued += n;
+            tx_ready.notify_one();
+            continue;
+        }
+
+        // TX ring full: wait for the write thread to make room
+        tx_space.wait(lock, [this] { return !tx_ring.full() || !running.load(); });
+    }
+}
+
+void ReliableConnectionMacOS::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        tx_space.wait(lock, [this] { return (tx_ring.empty() && tx_in_flight == 0) || !running.load(); });
+    }
+
     std::lock_guard<std::mutex> lock(write_mutex);
-    
-    size_t total_written = 0;
-    while (total_written < bs.size()) {
-        ssize_t written = ::write(serial_fd, bs.data() + total_written, bs.size() - total_written);
-        
-        if (written < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Would block, try again
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (serial_fd >= 0) {
+        tcdrain(serial_fd);
+    }
+}
+
+bool ReliableConnectionMacOS::waitWritable()
+{
+    fd_set write_fds;
+    FD_ZERO(&write_fds);
+    FD_SET(serial_fd, &write_fds);
+
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 10000; // Recheck running at least every 10ms
+
+    int result = select(serial_fd + 1, nullptr, &write_fds, nullptr, &timeout);
+    return result >= 0 || errno == EINTR;
+}
+
+void ReliableConnectionMacOS::writeThreadFunction()
+{
+    char buffer[maxReadSize];
+
+    while (true) {
+        size_t length;
+        {
+            std::unique_lock<std::mutex> lock(tx_mutex);
+            tx_ready.wait(lock, [this] { return !tx_ring.empty() || !running.load(); });
+
+            if (tx_ring.empty()) {
+                return; // Stopped with nothing left to send
+            }
+
+            length = tx_ring.get(buffer, sizeof(buffer));
+            tx_in_flight = length;
+        }
+        tx_space.notify_all();
+
+        size_t total_written = 0;
+        while (total_written < length) {
+            ssize_t written;
+            {
+                std::lock_guard<std::mutex> lock(write_mutex);
+                written = ::write(serial_fd, buffer + total_written, length - total_written);
+            }
+
+            if (written >= 0) {
+                total_written += written;
                 continue;
-            } else {
+            }
+
+            if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) && running.load() && waitWritable()) {
+                continue;
+            }
+
+            if (running.load()) {
                 std::cerr << "Write error: " << strerror(errno) << std::endl;
-                break;
             }
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(tx_mutex);
+            tx_in_flight = 0;
         }
-        
-        total_written += written;
+        tx_space.notify_all();
     }
+}
 
-    tcdrain(serial_fd);
+void ReliableConnectionMacOS::setRealtime(const RealtimeOptions& options)
+{
+    realtime = options;
 }
 
 void ReliableConnectionMacOS::setDebugMode(bool enable)
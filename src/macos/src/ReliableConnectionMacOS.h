@@ -3,10 +3,23 @@
 
 #include <Connection.h>
 #include <ring_buffer.h>
+#include <EscapeTokenizer.h>
+#include <RealtimeThread.h>
+#include <SerialConfig.h>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+
+// The same knobs as ReliableConnectionLinux
+#ifndef TRANSMISSION_SERIAL_BUFFER_SIZE
+#define TRANSMISSION_SERIAL_BUFFER_SIZE 4096
+#endif
+
+#ifndef TRANSMISSION_SERIAL_READ_SIZE
+#define TRANSMISSION_SERIAL_READ_SIZE 1024
+#endif
 
 class ReliableConnectionMacOS : public Connection
 {
@@ -14,10 +27,10 @@ class ReliableConnectionMacOS : public Connection
         static const char XON  = 0x11;
         static const char XOFF = 0x13;
 
-        static const int maxBufferSize = 4096;
-        static const int maxReadSize = 1024;
+        static const int maxBufferSize = TRANSMISSION_SERIAL_BUFFER_SIZE;
+        static const int maxReadSize = TRANSMISSION_SERIAL_READ_SIZE;
 
-        ReliableConnectionMacOS(const std::string& device_path = "/dev/tty.usbserial-0001");
+        ReliableConnectionMacOS(const std::string& device_path = "/dev/tty.usbserial-0001", const SerialConfig& config = SerialConfig());
         ~ReliableConnectionMacOS();
 
         void begin();
@@ -26,31 +39,60 @@ class ReliableConnectionMacOS : public Connection
         void disableXonXoff();
         void setDebugMode(bool enable);
 
+        // Takes effect immediately if the port is open. Rates without a
+        // Bxxx constant are set with IOSSIOSPEED; the FIFO threshold and
+        // idle timeout are left to the driver.
+        bool setConfig(const SerialConfig& config);
+
+        // Applied to the read thread by the next begin()
+        void setRealtime(const RealtimeOptions& options);
+
+        // Block until every queued byte has been written and has left the UART
+        void flush();
+
         // Connection interface
         int tryReadOne() override;
         char readOne() override;
         std::vector<char> read(int size) override;
+        // Queues the bytes for the write thread and returns; blocks only
+        // while the TX ring is full
         void write(std::vector<char> bs) override;
         bool availableForReading() override;
 
-        // Convenience method (not in base interface)
+        // Convenience method (not in base interface). Returns what has
+        // arrived, up to maxReadSize, without splitting escape sequences
+        // and without waiting for the rest of one.
         std::vector<char> read();
 
     private:
         bool debug_mode = false;
         std::string device_path;
+        SerialConfig config;
         int serial_fd;
         std::thread read_thread;
+        std::thread write_thread;
         std::atomic<bool> running;
         std::atomic<bool> xonXoffEnabled;
         std::atomic<bool> paused;
         std::atomic<bool> buffer_full;
         std::mutex write_mutex;
+        RealtimeOptions realtime;
 
         FlowControlRingBuffer<char, maxBufferSize> ring;
+        EscapeTokenizer escapes;
+
+        // TX queue, filled by write() and drained by the write thread
+        InterruptSafeRingBuffer<char, maxBufferSize> tx_ring;
+        std::mutex tx_mutex;
+        std::condition_variable tx_ready;   // Bytes queued or shutting down
+        std::condition_variable tx_space;   // Bytes sent, ring has room / may be empty
+        size_t tx_in_flight = 0;            // Taken from tx_ring, not yet written
 
         void readThreadFunction();
+        void writeThreadFunction();
+        bool waitWritable();
         bool configureSerialPort();
+        bool applyLineSettings();
         void sendFlowControlChar(char c);
 };
 
@@ -0,0 +1,136 @@
+#include "PosixSocket.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+#ifdef MSG_NOSIGNAL
+static const int sendFlags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+static const int sendFlags = MSG_DONTWAIT;
+#endif
+
+static void waitFor(int fd, short events, uint32_t timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+
+    int timeout = timeout_ms > static_cast<uint32_t>(INT_MAX) ? -1 : static_cast<int>(timeout_ms);
+    poll(&pfd, 1, timeout);
+}
+
+PosixSocket::PosixSocket(int fd)
+    : socket_fd(fd), closed(fd < 0)
+{
+}
+
+int PosixSocket::available()
+{
+    if (closed) {
+        return 0;
+    }
+
+    int pending = 0;
+    if (ioctl(socket_fd, FIONREAD, &pending) != 0) {
+        return 0;
+    }
+
+    return pending;
+}
+
+int PosixSocket::read(uint8_t* data, size_t size)
+{
+    if (closed) {
+        return 0;
+    }
+
+    while (true) {
+        ssize_t n = recv(socket_fd, data, size, MSG_DONTWAIT);
+        if (n > 0) {
+            return static_cast<int>(n);
+        }
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+
+        if (n < 0) {
+            std::cerr << "Socket read error: " << strerror(errno) << std::endl;
+        }
+
+        closed = true;
+        return 0;
+    }
+}
+
+bool PosixSocket::connected()
+{
+    if (closed) {
+        return false;
+    }
+
+    // A zero-length peek is the peer's FIN; anything else leaves it open
+    char c;
+    ssize_t n = recv(socket_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        closed = true;
+    }
+
+    return !closed;
+}
+
+uint32_t PosixSocket::millis()
+{
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void PosixSocket::wait(uint32_t timeout_ms)
+{
+    if (!closed) {
+        waitFor(socket_fd, POLLIN, timeout_ms);
+    }
+}
+
+size_t PosixSocket::write(const uint8_t* data, size_t size)
+{
+    if (closed) {
+        return 0;
+    }
+
+    while (true) {
+        ssize_t n = send(socket_fd, data, size, sendFlags);
+        if (n >= 0) {
+            return static_cast<size_t>(n);
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            std::cerr << "Socket write error: " << strerror(errno) << std::endl;
+            closed = true;
+        }
+
+        return 0;
+    }
+}
+
+void PosixSocket::waitWritable(uint32_t timeout_ms)
+{
+    if (!closed) {
+        waitFor(socket_fd, POLLOUT, timeout_ms);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef _POSIX_SOCKET_H_
+#define _POSIX_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The Socket side of socket_receiver.h and socket_transmitter.h over a
+// connected stream socket descriptor, so the paths the ESP32 runs over a
+// WiFiClient can run over a host TCP or Unix socket. Does not own the
+// descriptor.
+class PosixSocket
+{
+    public:
+        explicit PosixSocket(int fd);
+
+        int available();
+        int read(uint8_t* data, size_t size);
+        bool connected();
+        uint32_t millis();
+        void wait(uint32_t timeout_ms);
+
+        size_t write(const uint8_t* data, size_t size);
+        void waitWritable(uint32_t timeout_ms);
+
+    private:
+        int socket_fd;
+        bool closed;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "RealtimeThread.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <linux/serial.h>
+#elif defined(__APPLE__)
+#include <IOKit/serial/ioss.h>
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#endif
+
+bool RealtimeThread::configureCurrentThread(const RealtimeOptions& options)
+{
+    bool ok = true;
+
+    if (options.priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = std::min(std::max(options.priority, sched_get_priority_min(SCHED_FIFO)),
+                                        sched_get_priority_max(SCHED_FIFO));
+
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0) {
+            std::cerr << "Failed to set SCHED_FIFO priority " << param.sched_priority << ": " << strerror(result) << std::endl;
+            ok = false;
+        }
+    }
+
+    if (options.cpu >= 0) {
+#if defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options.cpu, &cpus);
+
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (result != 0) {
+            std::cerr << "Failed to pin thread to CPU " << options.cpu << ": " << strerror(result) << std::endl;
+            ok = false;
+        }
+#elif defined(__APPLE__)
+        // macOS has no hard pinning; an affinity tag only asks the scheduler
+        // to keep threads with different tags on different cores
+        thread_affinity_policy_data_t policy = {options.cpu + 1};
+        if (thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY,
+                              reinterpret_cast<thread_policy_t>(&policy), THREAD_AFFINITY_POLICY_COUNT) != KERN_SUCCESS) {
+            std::cerr << "Failed to set thread affinity tag " << policy.affinity_tag << std::endl;
+            ok = false;
+        }
+#else
+        std::cerr << "CPU pinning is not supported on this platform" << std::endl;
+        ok = false;
+#endif
+    }
+
+    return ok;
+}
+
+bool RealtimeThread::lockMemory()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "Failed to lock memory: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool RealtimeThread::setSerialLowLatency(int fd, bool enable)
+{
+#if defined(__linux__)
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+        std::cerr << "Failed to read serial settings: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (enable) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+    } else {
+        serial.flags &= ~ASYNC_LOW_LATENCY;
+    }
+
+    if (ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+        std::cerr << "Failed to set ASYNC_LOW_LATENCY: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+#elif defined(__APPLE__)
+    // Receive latency in microseconds before the driver hands data up
+    unsigned long latency = enable ? 1 : 0;
+    if (ioctl(fd, IOSSDATALAT, &latency) != 0) {
+        std::cerr << "Failed to set IOSSDATALAT: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+#else
+    (void)fd;
+    (void)enable;
+    std::cerr << "Serial low latency mode is not supported on this platform" << std::endl;
+    return false;
+#endif
+}
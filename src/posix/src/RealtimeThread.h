@@ -0,0 +1,47 @@
+#ifndef _REALTIME_THREAD_H_
+#define _REALTIME_THREAD_H_
+
+// Opt-in settings for a serial backend's I/O thread when a control loop
+// needs RX latency well under a millisecond. Everything defaults to off,
+// which leaves the thread as an ordinary time-shared one.
+//
+// Each setting is applied best effort: one the platform or the process's
+// privileges don't allow (SCHED_FIFO without CAP_SYS_NICE, affinity on
+// macOS, ASYNC_LOW_LATENCY on a pty) is reported on std::cerr and the
+// connection carries on without it.
+struct RealtimeOptions
+{
+    // SCHED_FIFO priority, clamped to the platform's range; 0 keeps the
+    // normal scheduler
+    int priority = 0;
+
+    // CPU to pin the thread to, or -1 to let it run anywhere. Pick an
+    // isolated core (isolcpus=, nohz_full=) when combining with busy_poll.
+    int cpu = -1;
+
+    // mlockall(MCL_CURRENT | MCL_FUTURE) so the thread never waits on a
+    // page fault; affects the whole process
+    bool lock_memory = false;
+
+    // ASYNC_LOW_LATENCY on Linux, IOSSDATALAT on macOS: ask the driver to
+    // push received bytes up at once instead of batching them on a timer
+    bool low_latency = false;
+
+    // Spin on nonblocking reads instead of sleeping until the port is
+    // readable. Trades a whole core for the wakeup latency.
+    bool busy_poll = false;
+};
+
+class RealtimeThread
+{
+    public:
+        // Apply priority and cpu to the calling thread
+        static bool configureCurrentThread(const RealtimeOptions& options);
+
+        static bool lockMemory();
+
+        // Set or clear the driver's low latency flag on an open serial port
+        static bool setSerialLowLatency(int fd, bool enable);
+};
+
+#endif
@@ -0,0 +1,343 @@
+#include "TcpConnection.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef MSG_NOSIGNAL
+static const int sendFlags = MSG_NOSIGNAL;
+#else
+static const int sendFlags = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+static bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+TcpConnection::TcpConnection(const char* host, uint16_t port)
+    : host(host), port(port), socket_fd(-1), connected(false),
+      no_delay(true), cork(false), receive_buffer_size(0)
+{
+}
+
+TcpConnection::TcpConnection(int fd)
+    : port(0), socket_fd(fd), connected(fd >= 0),
+      no_delay(true), cork(false), receive_buffer_size(0)
+{
+    if (socket_fd >= 0) {
+        setNonBlocking(socket_fd);
+        configureSocket();
+    }
+}
+
+TcpConnection::~TcpConnection()
+{
+    disconnect();
+}
+
+bool TcpConnection::connectToHost(unsigned long timeout_ms)
+{
+    disconnect();
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addresses = nullptr;
+    std::string service = std::to_string(port);
+    int status = getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+    if (status != 0) {
+        std::cerr << "Failed to resolve " << host << ": " << gai_strerror(status) << std::endl;
+        return false;
+    }
+
+    for (struct addrinfo* address = addresses; address; address = address->ai_next) {
+        socket_fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket_fd < 0) {
+            continue;
+        }
+
+        fcntl(socket_fd, F_SETFD, FD_CLOEXEC);
+        setNonBlocking(socket_fd);
+
+        // SO_RCVBUF must be in place before the handshake to affect window scaling
+        configureSocket();
+
+        if (::connect(socket_fd, address->ai_addr, address->ai_addrlen) == 0 ||
+            (errno == EINPROGRESS && waitFor(POLLOUT, static_cast<int>(timeout_ms)))) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error == 0) {
+                connected = true;
+                break;
+            }
+            errno = error;
+        }
+
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    freeaddrinfo(addresses);
+
+    if (!connected) {
+        std::cerr << "TCP connection to " << host << ":" << port << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void TcpConnection::disconnect()
+{
+    if (socket_fd >= 0) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    connected = false;
+}
+
+bool TcpConnection::isConnected()
+{
+    return connected;
+}
+
+int TcpConnection::fd() const
+{
+    return socket_fd;
+}
+
+bool TcpConnection::applyOption(int level, int option, int value, const char* name)
+{
+    if (socket_fd < 0) {
+        return true; // Applied on connect
+    }
+
+    if (setsockopt(socket_fd, level, option, &value, sizeof(value)) != 0) {
+        std::cerr << "Failed to set " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void TcpConnection::configureSocket()
+{
+#ifdef SO_NOSIGPIPE
+    applyOption(SOL_SOCKET, SO_NOSIGPIPE, 1, "SO_NOSIGPIPE");
+#endif
+
+    applyOption(IPPROTO_TCP, TCP_NODELAY, no_delay ? 1 : 0, "TCP_NODELAY");
+
+    if (cork) {
+        setCork(true);
+    }
+
+    if (receive_buffer_size > 0) {
+        applyOption(SOL_SOCKET, SO_RCVBUF, receive_buffer_size, "SO_RCVBUF");
+    }
+}
+
+bool TcpConnection::setNoDelay(bool enable)
+{
+    no_delay = enable;
+    return applyOption(IPPROTO_TCP, TCP_NODELAY, enable ? 1 : 0, "TCP_NODELAY");
+}
+
+bool TcpConnection::setCork(bool enable)
+{
+    cork = enable;
+
+#if defined(TCP_CORK)
+    return applyOption(IPPROTO_TCP, TCP_CORK, enable ? 1 : 0, "TCP_CORK");
+#elif defined(TCP_NOPUSH)
+    return applyOption(IPPROTO_TCP, TCP_NOPUSH, enable ? 1 : 0, "TCP_NOPUSH");
+#else
+    return false;
+#endif
+}
+
+bool TcpConnection::setReceiveBufferSize(int bytes)
+{
+    receive_buffer_size = bytes;
+    return applyOption(SOL_SOCKET, SO_RCVBUF, bytes, "SO_RCVBUF");
+}
+
+bool TcpConnection::waitFor(short events, int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = socket_fd;
+    pfd.events = events;
+    pfd.revents = 0;
+
+    while (true) {
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        return ready > 0;
+    }
+}
+
+void TcpConnection::fillRingBuffer()
+{
+    while (connected) {
+        char* span;
+        size_t space = ring.writeSpan(span);
+        if (space == 0) {
+            break; // Leave the rest in the kernel's receive buffer
+        }
+
+        ssize_t n = recv(socket_fd, span, space, 0);
+        if (n > 0) {
+            ring.commit(n);
+            if (static_cast<size_t>(n) < space) {
+                break; // Drained
+            }
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+
+        if (n < 0) {
+            std::cerr << "TCP read error: " << strerror(errno) << std::endl;
+        }
+
+        // Peer closed; whatever is already in the ring can still be read
+        connected = false;
+    }
+}
+
+int TcpConnection::tryReadOne()
+{
+    char c;
+    if (ring.get(c)) {
+        return static_cast<unsigned char>(c);
+    }
+
+    fillRingBuffer();
+
+    if (ring.get(c)) {
+        return static_cast<unsigned char>(c);
+    }
+
+    return -1;
+}
+
+char TcpConnection::readOne()
+{
+    char c;
+    while (true) {
+        if (ring.get(c)) {
+            return c;
+        }
+
+        fillRingBuffer();
+        if (ring.get(c)) {
+            return c;
+        }
+
+        if (!connected) {
+            std::cerr << "Connection lost in readOne()" << std::endl;
+            return 0;
+        }
+
+        waitFor(POLLIN, -1);
+    }
+}
+
+std::vector<char> TcpConnection::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    size_t filled = 0;
+
+    // Block until we have 'size' bytes
+    while (true) {
+        filled += ring.get(results.data() + filled, results.size() - filled);
+        if (filled == results.size()) {
+            break;
+        }
+
+        fillRingBuffer();
+        if (!ring.empty()) {
+            continue;
+        }
+
+        if (!connected) {
+            break;
+        }
+
+        waitFor(POLLIN, -1);
+    }
+
+    results.resize(filled);
+    return results;
+}
+
+void TcpConnection::write(std::vector<char> bs)
+{
+    if (!connected) {
+        std::cerr << "Not connected in write()" << std::endl;
+        return;
+    }
+
+    size_t total_written = 0;
+    while (total_written < bs.size()) {
+        ssize_t written = send(socket_fd, bs.data() + total_written, bs.size() - total_written, sendFlags);
+
+        if (written > 0) {
+            total_written += written;
+            continue;
+        }
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            waitFor(POLLOUT, -1);
+            continue;
+        }
+
+        std::cerr << "TCP write error: " << strerror(errno) << std::endl;
+        connected = false;
+        return;
+    }
+}
+
+bool TcpConnection::availableForReading()
+{
+    if (ring.empty()) {
+        fillRingBuffer();
+    }
+
+    return !ring.empty();
+}
+
+size_t TcpConnection::available() const
+{
+    return ring.count();
+}
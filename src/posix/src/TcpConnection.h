@@ -0,0 +1,77 @@
+#ifndef _TCP_CONNECTION_H_
+#define _TCP_CONNECTION_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+#include <cstdint>
+#include <string>
+
+class TcpListener;
+
+// Host-side counterpart of ReliableConnectionWiFiTcp with the same shape,
+// so servers can speak to ESP32 devices through the same Connection
+// interface. The socket is nonblocking; each refill moves everything the
+// kernel has buffered into the ring with bulk reads, and the blocking calls
+// wait in poll() rather than sleeping.
+class TcpConnection : public Connection
+{
+    public:
+        static const int maxBufferSize = TRANSMISSION_SOCKET_BUFFER_SIZE;
+        static const int maxReadSize = TRANSMISSION_SOCKET_READ_SIZE;
+
+        TcpConnection(const char* host, uint16_t port);
+        ~TcpConnection();
+
+        TcpConnection(const TcpConnection&) = delete;
+        TcpConnection& operator=(const TcpConnection&) = delete;
+
+        bool connectToHost(unsigned long timeout_ms = 10000);
+        void disconnect();
+        bool isConnected();
+        int fd() const;
+
+        // Socket tuning; take effect immediately when connected and are
+        // reapplied by connectToHost()
+        bool setNoDelay(bool enable);
+        // Hold back partial frames until uncorked (TCP_NOPUSH on BSDs)
+        bool setCork(bool enable);
+        bool setReceiveBufferSize(int bytes);
+
+        using Connection::write;
+
+        // Connection interface. readOne() and read() block until the bytes
+        // arrive or the peer disconnects, like ReliableConnectionWiFiTcp;
+        // write() blocks until the kernel has taken every byte.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        size_t available() const;
+
+    private:
+        friend class TcpListener;
+
+        // Wraps a socket accepted by TcpListener; takes ownership
+        explicit TcpConnection(int fd);
+
+        std::string host;
+        uint16_t port;
+        int socket_fd;
+        bool connected;
+
+        bool no_delay;
+        bool cork;
+        int receive_buffer_size;
+
+        InterruptSafeRingBuffer<char, maxBufferSize> ring;
+
+        void configureSocket();
+        bool applyOption(int level, int option, int value, const char* name);
+        void fillRingBuffer();
+        bool waitFor(short events, int timeout_ms);
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "TcpListener.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+TcpListener::TcpListener(uint16_t port, const char* host)
+    : host(host), bound_port(port), listen_fd(-1)
+{
+}
+
+TcpListener::~TcpListener()
+{
+    end();
+}
+
+bool TcpListener::begin(int backlog)
+{
+    if (listen_fd >= 0) {
+        return true;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(bound_port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid listen address: " << host << std::endl;
+        return false;
+    }
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    fcntl(listen_fd, F_SETFD, FD_CLOEXEC);
+    int flags = fcntl(listen_fd, F_GETFL, 0);
+    fcntl(listen_fd, F_SETFL, flags | O_NONBLOCK);
+
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, backlog) != 0) {
+        std::cerr << "Failed to listen on " << host << ":" << bound_port << ": " << strerror(errno) << std::endl;
+        end();
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    if (getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&address), &length) == 0) {
+        bound_port = ntohs(address.sin_port);
+    }
+
+    return true;
+}
+
+void TcpListener::end()
+{
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+bool TcpListener::isListening() const
+{
+    return listen_fd >= 0;
+}
+
+uint16_t TcpListener::port() const
+{
+    return bound_port;
+}
+
+int TcpListener::fd() const
+{
+    return listen_fd;
+}
+
+std::unique_ptr<TcpConnection> TcpListener::accept(int timeout_ms)
+{
+    if (listen_fd < 0) {
+        return nullptr;
+    }
+
+    while (true) {
+        int client_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (client_fd >= 0) {
+            fcntl(client_fd, F_SETFD, FD_CLOEXEC);
+            return std::unique_ptr<TcpConnection>(new TcpConnection(client_fd));
+        }
+
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            std::cerr << "accept() failed: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        if (timeout_ms == 0) {
+            return nullptr;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = listen_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready == 0) {
+            return nullptr;
+        }
+        if (ready < 0 && errno != EINTR) {
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef _TCP_LISTENER_H_
+#define _TCP_LISTENER_H_
+
+#include "TcpConnection.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Accepts TcpConnections on a nonblocking listening socket. Port 0 picks a
+// free port; port() reports the one actually bound.
+class TcpListener
+{
+    public:
+        TcpListener(uint16_t port, const char* host = "0.0.0.0");
+        ~TcpListener();
+
+        TcpListener(const TcpListener&) = delete;
+        TcpListener& operator=(const TcpListener&) = delete;
+
+        bool begin(int backlog = 128);
+        void end();
+        bool isListening() const;
+        uint16_t port() const;
+        int fd() const;
+
+        // Returns nullptr when nothing arrives within timeout_ms (0 polls,
+        // -1 waits forever)
+        std::unique_ptr<TcpConnection> accept(int timeout_ms = 0);
+
+    private:
+        std::string host;
+        uint16_t bound_port;
+        int listen_fd;
+};
+
+#endif
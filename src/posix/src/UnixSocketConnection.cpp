@@ -0,0 +1,676 @@
+#include "UnixSocketConnection.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef MSG_NOSIGNAL
+static const int sendFlags = MSG_NOSIGNAL;
+#else
+static const int sendFlags = 0;
+#endif
+
+#ifdef MSG_CMSG_CLOEXEC
+static const int receiveFlags = MSG_CMSG_CLOEXEC;
+#else
+static const int receiveFlags = 0;
+#endif
+
+static int socketType(UnixSocketConnection::Type type)
+{
+    return type == UnixSocketConnection::Type::seqpacket ? SOCK_SEQPACKET : SOCK_STREAM;
+}
+
+// macOS has no SOCK_SEQPACKET in AF_UNIX; say so instead of failing with
+// a bare EPROTONOSUPPORT
+static bool typeSupported(UnixSocketConnection::Type type)
+{
+#ifdef __APPLE__
+    if (type == UnixSocketConnection::Type::seqpacket) {
+        std::cerr << "Seqpacket Unix sockets are not supported on macOS" << std::endl;
+        return false;
+    }
+#else
+    (void)type;
+#endif
+    return true;
+}
+
+static void prepareSocket(int fd)
+{
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+static bool makeAddress(const std::string& path, struct sockaddr_un& address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Unix socket path too long: " << path << std::endl;
+        return false;
+    }
+
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+// UnixSocketConnection implementation
+UnixSocketConnection::UnixSocketConnection(const std::string& path, Type type)
+    : path(path), socket_type(type), socket_fd(-1), connected(false)
+{
+}
+
+UnixSocketConnection::UnixSocketConnection(int fd, Type type)
+    : socket_type(type), socket_fd(fd), connected(fd >= 0)
+{
+    if (socket_fd >= 0) {
+        prepareSocket(socket_fd);
+    }
+}
+
+UnixSocketConnection::~UnixSocketConnection()
+{
+    disconnect();
+}
+
+bool UnixSocketConnection::createPair(std::unique_ptr<UnixSocketConnection>& a,
+                                      std::unique_ptr<UnixSocketConnection>& b,
+                                      Type type)
+{
+    if (!typeSupported(type)) {
+        return false;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, socketType(type), 0, fds) != 0) {
+        std::cerr << "Failed to create socket pair: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    a.reset(new UnixSocketConnection(fds[0], type));
+    b.reset(new UnixSocketConnection(fds[1], type));
+    return true;
+}
+
+bool UnixSocketConnection::connectToPath()
+{
+    disconnect();
+
+    struct sockaddr_un address;
+    if (!typeSupported(socket_type) || !makeAddress(path, address)) {
+        return false;
+    }
+
+    socket_fd = socket(AF_UNIX, socketType(socket_type), 0);
+    if (socket_fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Local connects complete or fail immediately, so connect before
+    // switching to nonblocking mode
+    if (::connect(socket_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Failed to connect to " << path << ": " << strerror(errno) << std::endl;
+        close(socket_fd);
+        socket_fd = -1;
+        return false;
+    }
+
+    prepareSocket(socket_fd);
+    connected = true;
+    return true;
+}
+
+void UnixSocketConnection::disconnect()
+{
+    if (socket_fd >= 0) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+
+    // Descriptors nobody collected would otherwise leak
+    for (int fd : received_descriptors) {
+        close(fd);
+    }
+    received_descriptors.clear();
+    received_packets.clear();
+
+    connected = false;
+}
+
+bool UnixSocketConnection::isConnected()
+{
+    return connected;
+}
+
+int UnixSocketConnection::fd() const
+{
+    return socket_fd;
+}
+
+UnixSocketConnection::Type UnixSocketConnection::type() const
+{
+    return socket_type;
+}
+
+bool UnixSocketConnection::waitFor(short events, int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = socket_fd;
+    pfd.events = events;
+    pfd.revents = 0;
+
+    while (true) {
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        return ready > 0;
+    }
+}
+
+ssize_t UnixSocketConnection::receiveInto(char* buffer, size_t length, bool& carried_descriptors)
+{
+    carried_descriptors = false;
+
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = length;
+
+    union {
+        char buffer[CMSG_SPACE(maxDescriptorsPerMessage * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    while (true) {
+        ssize_t n = recvmsg(socket_fd, &message, receiveFlags);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return -1;
+        }
+
+        if (n <= 0) {
+            if (n < 0) {
+                std::cerr << "Unix socket read error: " << strerror(errno) << std::endl;
+            }
+            // Peer closed; whatever is already buffered can still be read
+            connected = false;
+            return -1;
+        }
+
+        for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* fds = reinterpret_cast<const int*>(CMSG_DATA(header));
+            for (size_t i = 0; i < count; i++) {
+                int received;
+                memcpy(&received, fds + i, sizeof(int));
+                fcntl(received, F_SETFD, FD_CLOEXEC);
+                received_descriptors.push_back(received);
+                carried_descriptors = true;
+            }
+        }
+
+        if (message.msg_flags & MSG_CTRUNC) {
+            std::cerr << "Dropped descriptors beyond " << maxDescriptorsPerMessage << " per message" << std::endl;
+        }
+
+        return n;
+    }
+}
+
+bool UnixSocketConnection::receivePacket()
+{
+    std::vector<char> packet(maxPacketSize);
+    bool carried_descriptors;
+
+    ssize_t n = receiveInto(packet.data(), packet.size(), carried_descriptors);
+    if (n < 0) {
+        return false;
+    }
+
+    // A descriptor's packet holds only its marker
+    if (!carried_descriptors) {
+        packet.resize(n);
+        received_packets.push_back(std::move(packet));
+    }
+
+    return true;
+}
+
+void UnixSocketConnection::fillRingBuffer()
+{
+    if (socket_type == Type::seqpacket) {
+        while (connected || !received_packets.empty()) {
+            while (!received_packets.empty() && received_packets.front().size() <= ring.free()) {
+                ring.put(received_packets.front().data(), received_packets.front().size());
+                received_packets.pop_front();
+            }
+
+            if (!received_packets.empty() || !connected || !receivePacket()) {
+                break;
+            }
+        }
+        return;
+    }
+
+    while (connected) {
+        char* span;
+        size_t space = ring.writeSpan(span);
+        if (space == 0) {
+            break; // Leave the rest in the kernel's receive buffer
+        }
+
+        bool carried_descriptors;
+        ssize_t n = receiveInto(span, space, carried_descriptors);
+        if (n < 0) {
+            break;
+        }
+
+        // The kernel ends a read at the message carrying descriptors, so
+        // its marker is the last byte
+        if (carried_descriptors) {
+            n--;
+        }
+
+        ring.commit(n);
+    }
+}
+
+bool UnixSocketConnection::sendAll(const char* data, size_t length)
+{
+    size_t total_written = 0;
+    while (total_written < length) {
+        ssize_t written = send(socket_fd, data + total_written, length - total_written, sendFlags);
+
+        if (written > 0) {
+            total_written += written;
+            continue;
+        }
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+            waitFor(POLLOUT, -1);
+            continue;
+        }
+
+        std::cerr << "Unix socket write error: " << strerror(errno) << std::endl;
+        connected = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool UnixSocketConnection::sendDescriptor(int fd)
+{
+    if (!connected) {
+        std::cerr << "Not connected in sendDescriptor()" << std::endl;
+        return false;
+    }
+
+    char marker = descriptorMarker;
+    struct iovec iov;
+    iov.iov_base = &marker;
+    iov.iov_len = 1;
+
+    union {
+        char buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+    while (true) {
+        ssize_t sent = sendmsg(socket_fd, &message, sendFlags);
+        if (sent == 1) {
+            return true;
+        }
+
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+            waitFor(POLLOUT, -1);
+            continue;
+        }
+
+        std::cerr << "Failed to send descriptor: " << strerror(errno) << std::endl;
+        return false;
+    }
+}
+
+int UnixSocketConnection::receiveDescriptor(int timeout_ms)
+{
+    while (received_descriptors.empty()) {
+        if (!connected) {
+            return -1;
+        }
+
+        bool received;
+        if (socket_type == Type::seqpacket) {
+            received = receivePacket();
+        } else if (ring.full()) {
+            // The bytes ahead of the descriptor have nowhere to go, and
+            // polling would report them ready forever
+            std::cerr << "RX ring full in receiveDescriptor(); read the bytes sent before the descriptor first"
+                      << std::endl;
+            return -1;
+        } else {
+            // Descriptors are picked up along with the bytes before them
+            size_t before = ring.count();
+            fillRingBuffer();
+            received = ring.count() != before;
+        }
+
+        if (!received && received_descriptors.empty() && connected) {
+            if (!waitFor(POLLIN, timeout_ms)) {
+                return -1;
+            }
+        }
+    }
+
+    int fd = received_descriptors.front();
+    received_descriptors.pop_front();
+    return fd;
+}
+
+bool UnixSocketConnection::sendMessage(const std::vector<char>& message)
+{
+    if (!connected) {
+        std::cerr << "Not connected in sendMessage()" << std::endl;
+        return false;
+    }
+
+    if (socket_type == Type::seqpacket && message.size() > static_cast<size_t>(maxPacketSize)) {
+        std::cerr << "Message of " << message.size() << " bytes exceeds maxPacketSize" << std::endl;
+        return false;
+    }
+
+    return sendAll(message.data(), message.size());
+}
+
+std::vector<char> UnixSocketConnection::receiveMessage(int timeout_ms)
+{
+    if (socket_type == Type::stream) {
+        std::vector<char> results;
+        if (ring.empty()) {
+            fillRingBuffer();
+        }
+        if (ring.empty() && connected && waitFor(POLLIN, timeout_ms)) {
+            fillRingBuffer();
+        }
+
+        results.resize(maxReadSize);
+        results.resize(ring.get(results.data(), results.size()));
+        return results;
+    }
+
+    while (received_packets.empty()) {
+        if (receivePacket()) {
+            continue;
+        }
+
+        if (!connected || !waitFor(POLLIN, timeout_ms)) {
+            return {};
+        }
+    }
+
+    std::vector<char> packet = std::move(received_packets.front());
+    received_packets.pop_front();
+    return packet;
+}
+
+int UnixSocketConnection::tryReadOne()
+{
+    char c;
+    if (ring.get(c)) {
+        return static_cast<unsigned char>(c);
+    }
+
+    fillRingBuffer();
+
+    if (ring.get(c)) {
+        return static_cast<unsigned char>(c);
+    }
+
+    return -1;
+}
+
+char UnixSocketConnection::readOne()
+{
+    char c;
+    while (true) {
+        if (ring.get(c)) {
+            return c;
+        }
+
+        fillRingBuffer();
+        if (ring.get(c)) {
+            return c;
+        }
+
+        if (!connected) {
+            std::cerr << "Connection lost in readOne()" << std::endl;
+            return 0;
+        }
+
+        waitFor(POLLIN, -1);
+    }
+}
+
+std::vector<char> UnixSocketConnection::read(int size)
+{
+    std::vector<char> results;
+    if (size <= 0) {
+        return results;
+    }
+
+    results.resize(size);
+    size_t filled = 0;
+
+    // Block until we have 'size' bytes
+    while (true) {
+        filled += ring.get(results.data() + filled, results.size() - filled);
+        if (filled == results.size()) {
+            break;
+        }
+
+        fillRingBuffer();
+        if (!ring.empty()) {
+            continue;
+        }
+
+        if (!connected) {
+            break;
+        }
+
+        waitFor(POLLIN, -1);
+    }
+
+    results.resize(filled);
+    return results;
+}
+
+void UnixSocketConnection::write(std::vector<char> bs)
+{
+    if (!connected) {
+        std::cerr << "Not connected in write()" << std::endl;
+        return;
+    }
+
+    if (socket_type == Type::stream) {
+        sendAll(bs.data(), bs.size());
+        return;
+    }
+
+    // One packet per write, split only when it exceeds the packet limit
+    for (size_t offset = 0; offset < bs.size(); offset += maxPacketSize) {
+        size_t length = std::min(bs.size() - offset, static_cast<size_t>(maxPacketSize));
+        if (!sendAll(bs.data() + offset, length)) {
+            return;
+        }
+    }
+}
+
+bool UnixSocketConnection::availableForReading()
+{
+    if (ring.empty()) {
+        fillRingBuffer();
+    }
+
+    return !ring.empty();
+}
+
+size_t UnixSocketConnection::available() const
+{
+    return ring.count();
+}
+
+// UnixSocketListener implementation
+UnixSocketListener::UnixSocketListener(const std::string& path, UnixSocketConnection::Type type)
+    : path(path), socket_type(type), listen_fd(-1)
+{
+}
+
+UnixSocketListener::~UnixSocketListener()
+{
+    end();
+}
+
+bool UnixSocketListener::begin(int backlog)
+{
+    if (listen_fd >= 0) {
+        return true;
+    }
+
+    struct sockaddr_un address;
+    if (!typeSupported(socket_type) || !makeAddress(path, address)) {
+        return false;
+    }
+
+    listen_fd = socket(AF_UNIX, socketType(socket_type), 0);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    prepareSocket(listen_fd);
+
+    // Replace a socket file left behind by a previous run
+    unlink(path.c_str());
+
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, backlog) != 0) {
+        std::cerr << "Failed to listen on " << path << ": " << strerror(errno) << std::endl;
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void UnixSocketListener::end()
+{
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(path.c_str());
+    }
+}
+
+bool UnixSocketListener::isListening() const
+{
+    return listen_fd >= 0;
+}
+
+int UnixSocketListener::fd() const
+{
+    return listen_fd;
+}
+
+std::unique_ptr<UnixSocketConnection> UnixSocketListener::accept(int timeout_ms)
+{
+    if (listen_fd < 0) {
+        return nullptr;
+    }
+
+    while (true) {
+        int client_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (client_fd >= 0) {
+            return std::unique_ptr<UnixSocketConnection>(new UnixSocketConnection(client_fd, socket_type));
+        }
+
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            std::cerr << "accept() failed: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        if (timeout_ms == 0) {
+            return nullptr;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = listen_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready == 0) {
+            return nullptr;
+        }
+        if (ready < 0 && errno != EINTR) {
+            return nullptr;
+        }
+    }
+}
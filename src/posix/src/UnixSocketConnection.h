@@ -0,0 +1,129 @@
+#ifndef _UNIX_SOCKET_CONNECTION_H_
+#define _UNIX_SOCKET_CONNECTION_H_
+
+#include <Connection.h>
+#include <TransmissionConfig.h>
+#include <ring_buffer.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+class UnixSocketListener;
+
+// Connection over a Unix domain socket, for local clients that would
+// otherwise go through loopback TCP. Stream sockets behave like
+// TcpConnection. Seqpacket sockets keep message boundaries: each write()
+// is one packet, and sendMessage()/receiveMessage() exchange whole packets.
+// Either type can pass open file descriptors with SCM_RIGHTS, so a
+// supervisor can open and configure a serial port once and hand it to a
+// worker that restarts without touching termios. macOS has no seqpacket
+// Unix sockets; there only the stream type can be opened.
+class UnixSocketConnection : public Connection
+{
+    public:
+        enum class Type { stream, seqpacket };
+
+        static const int maxBufferSize = TRANSMISSION_SOCKET_BUFFER_SIZE;
+        static const int maxReadSize = TRANSMISSION_SOCKET_READ_SIZE;
+        static const int maxPacketSize = 16384;
+        static const int maxDescriptorsPerMessage = 16;
+
+        UnixSocketConnection(const std::string& path, Type type = Type::stream);
+        ~UnixSocketConnection();
+
+        UnixSocketConnection(const UnixSocketConnection&) = delete;
+        UnixSocketConnection& operator=(const UnixSocketConnection&) = delete;
+
+        // A connected pair, e.g. to share with a child across fork()
+        static bool createPair(std::unique_ptr<UnixSocketConnection>& a,
+                               std::unique_ptr<UnixSocketConnection>& b,
+                               Type type = Type::stream);
+
+        bool connectToPath();
+        void disconnect();
+        bool isConnected();
+        int fd() const;
+        Type type() const;
+
+        // Send fd (which stays open here) along with a one-byte marker.
+        // Descriptors that arrive are queued in order and handed out by
+        // receiveDescriptor(), which waits at most timeout_ms (-1 forever)
+        // and returns -1 on timeout or hangup. The marker byte is consumed.
+        // On stream sockets a descriptor is picked up with the bytes sent
+        // before it, so it also returns -1 while the RX ring is full of
+        // them; read those first.
+        bool sendDescriptor(int fd);
+        int receiveDescriptor(int timeout_ms = -1);
+
+        // Whole packets on seqpacket sockets; on stream sockets they are
+        // plain write() and whatever has arrived, up to maxReadSize. Use
+        // either these or the byte interface on one connection, not both.
+        bool sendMessage(const std::vector<char>& message);
+        std::vector<char> receiveMessage(int timeout_ms = -1);
+
+        using Connection::write;
+
+        // Connection interface. readOne() and read() block until the bytes
+        // arrive or the peer disconnects; write() blocks until the kernel
+        // has taken every byte.
+        int tryReadOne() override;
+        char readOne() override;
+        std::vector<char> read(int size) override;
+        void write(std::vector<char> bs) override;
+        bool availableForReading() override;
+
+        size_t available() const;
+
+    private:
+        friend class UnixSocketListener;
+
+        // Wraps an accepted or paired socket; takes ownership
+        UnixSocketConnection(int fd, Type type);
+
+        static const char descriptorMarker = 0;
+
+        std::string path;
+        Type socket_type;
+        int socket_fd;
+        bool connected;
+
+        InterruptSafeRingBuffer<char, maxBufferSize> ring;
+        std::deque<int> received_descriptors;
+        std::deque<std::vector<char>> received_packets;
+
+        ssize_t receiveInto(char* buffer, size_t length, bool& carried_descriptors);
+        bool receivePacket();
+        void fillRingBuffer();
+        bool waitFor(short events, int timeout_ms);
+        bool sendAll(const char* data, size_t length);
+};
+
+// Accepts UnixSocketConnections on a filesystem path. A stale socket file
+// left by a previous run is replaced; end() removes it.
+class UnixSocketListener
+{
+    public:
+        UnixSocketListener(const std::string& path, UnixSocketConnection::Type type = UnixSocketConnection::Type::stream);
+        ~UnixSocketListener();
+
+        UnixSocketListener(const UnixSocketListener&) = delete;
+        UnixSocketListener& operator=(const UnixSocketListener&) = delete;
+
+        bool begin(int backlog = 128);
+        void end();
+        bool isListening() const;
+        int fd() const;
+
+        // Returns nullptr when nothing arrives within timeout_ms (0 polls,
+        // -1 waits forever)
+        std::unique_ptr<UnixSocketConnection> accept(int timeout_ms = 0);
+
+    private:
+        std::string path;
+        UnixSocketConnection::Type socket_type;
+        int listen_fd;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef TRANSMISSION_TRANSMISSION_POSIX_H
+#define TRANSMISSION_TRANSMISSION_POSIX_H
+
+#include "PosixSocket.h"
+#include "TcpConnection.h"
+#include "TcpListener.h"
+#include "UnixSocketConnection.h"
+#include "RealtimeThread.h"
+
+#endif //TRANSMISSION_TRANSMISSION_POSIX_H
@@ -29,13 +29,13 @@ void setup()
 
 void loop()
 {
-  std::vector<char> output = serial1->read();
+  auto output = serial1->read();
   if(!output.empty())
   {
     usb.write(output);
   }
 
-  std::vector<char> input = usb.read();
+  auto input = usb.read();
   if(!input.empty())
   {
     serial1->write(input);
@@ -1,46 +1,39 @@
 #ifndef _RELIABLE_CONNECTION_SERIAL1_H_
 #define _RELIABLE_CONNECTION_SERIAL1_H_
 
-#include <Connection.h>
+#include <UartConnection.h>
 
-#include <ring_buffer.h>
+#include "Rp2040Uart.h"
 
-class ReliableConnectionSerial1 : public Connection
+// Sizes for this build, overridable with -D (e.g. platformio.ini build_flags).
+// Rings must be powers of two; for other ports or several sizes at once,
+// use UartConnection<Rp2040Uart1, RX, TX, READ> directly.
+#ifndef TRANSMISSION_SERIAL1_RX_SIZE
+#define TRANSMISSION_SERIAL1_RX_SIZE 4096
+#endif
+
+#ifndef TRANSMISSION_SERIAL1_TX_SIZE
+#define TRANSMISSION_SERIAL1_TX_SIZE 1024
+#endif
+
+#ifndef TRANSMISSION_SERIAL1_READ_SIZE
+#define TRANSMISSION_SERIAL1_READ_SIZE 128
+#endif
+
+class ReliableConnectionSerial1 : public UartConnection<Rp2040Uart0, TRANSMISSION_SERIAL1_RX_SIZE, TRANSMISSION_SERIAL1_TX_SIZE, TRANSMISSION_SERIAL1_READ_SIZE>
 {
   public:
-    static const char XON  = 0x11;
-    static const char XOFF = 0x13;
-
-    static const int maxBufferSize = 4096;
-    static const int maxReadSize = 32;
+    static const int maxBufferSize = TRANSMISSION_SERIAL1_RX_SIZE;
+    static const int maxWriteBufferSize = TRANSMISSION_SERIAL1_TX_SIZE;
 
     static ReliableConnectionSerial1* instance;
 
     static ReliableConnectionSerial1* getInstance();
-    static void uart0_handler();
 
     ~ReliableConnectionSerial1() {}
 
-    void begin();
-				void enableXonXoff();
-    void disableXonXoff();
-
-    // Connection
-    int tryReadOne();
-    char readOne();
-    std::vector<char> read();
-    std::vector<char> read(int size);
-    void write(std::vector<char> bs);
-				bool availableForReading();
-    // end Connection
-
 	private:
-		bool xonXoffEnabled = false;
-		FlowControlRingBuffer<char, maxBufferSize> ring;
-		volatile bool paused = false;
-		volatile bool buffer_full = false;
-
 		ReliableConnectionSerial1();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,61 @@
+#include "Rp2040Uart.h"
+
+#include <Arduino.h>
+#include <hardware/irq.h>
+#include <hardware/gpio.h>
+
+template<int PORT>
+void Rp2040Uart<PORT>::begin(const SerialConfig& config, void (*isr)())
+{
+  const int first_pin = PORT == 0 ? 0 : 4;
+  const unsigned irq = PORT == 0 ? UART0_IRQ : UART1_IRQ;
+
+  uart_init(uart(), config.baud_rate);
+  gpio_set_function(config.tx_pin >= 0 ? config.tx_pin : first_pin, GPIO_FUNC_UART);
+  gpio_set_function(config.rx_pin >= 0 ? config.rx_pin : first_pin + 1, GPIO_FUNC_UART);
+
+  uart_parity_t parity = UART_PARITY_NONE;
+  if(config.parity == SerialConfig::Parity::even)
+  {
+    parity = UART_PARITY_EVEN;
+  }
+  else if(config.parity == SerialConfig::Parity::odd)
+  {
+    parity = UART_PARITY_ODD;
+  }
+  uart_set_format(uart(), config.data_bits, config.stop_bits, parity);
+
+  if(config.hardware_flow_control)
+  {
+    gpio_set_function(config.cts_pin >= 0 ? config.cts_pin : first_pin + 2, GPIO_FUNC_UART);
+    gpio_set_function(config.rts_pin >= 0 ? config.rts_pin : first_pin + 3, GPIO_FUNC_UART);
+  }
+  uart_set_hw_flow(uart(), config.hardware_flow_control, config.hardware_flow_control);
+
+  delay(10); // Wait for initialization to take
+
+  irq_set_priority(irq, 0xFF);
+  irq_set_exclusive_handler(irq, isr);
+  irq_set_enabled(irq, true);
+  uart_set_irq_enables(uart(), true, false);
+
+  // uart_set_irq_enables() resets the RX level, so set the levels after it
+  if(config.rx_fifo_threshold > 0)
+  {
+    // RXIFLSEL: 0 = 4 bytes, 1 = 8, 2 = 16, 3 = 24, 4 = 28
+    static const uint8_t levels[] = {4, 8, 16, 24, 28};
+    uint32_t level = 0;
+    while(level < 4 && levels[level + 1] <= config.rx_fifo_threshold)
+    {
+      level++;
+    }
+    hw_write_masked(&uart_get_hw(uart())->ifls, level << UART_UARTIFLS_RXIFLSEL_LSB, UART_UARTIFLS_RXIFLSEL_BITS);
+  }
+
+  // TXIFLSEL 0: interrupt when the TX FIFO drains to 4 of 32 bytes, so
+  // each refill moves 28
+  hw_write_masked(&uart_get_hw(uart())->ifls, 0 << UART_UARTIFLS_TXIFLSEL_LSB, UART_UARTIFLS_TXIFLSEL_BITS);
+}
+
+template struct Rp2040Uart<0>;
+template struct Rp2040Uart<1>;
@@ -0,0 +1,87 @@
+#ifndef _RP2040_UART_H_
+#define _RP2040_UART_H_
+
+#include <SerialConfig.h>
+
+#include <hardware/uart.h>
+#include <hardware/sync.h>
+
+// UartConnection policy for one of the RP2040's two PL011s, read straight
+// from the RX FIFO in its interrupt and, with a TX ring, refilled from it
+// once the TX FIFO drains to 4 bytes. Each PORT has its own IRQ, so
+//
+//   UartConnection<Rp2040Uart0, 4096, 1024> first;
+//   UartConnection<Rp2040Uart1, 4096, 1024> second;
+//
+// run side by side, each with its own rings and handler.
+template<int PORT>
+struct Rp2040Uart
+{
+  static_assert(PORT == 0 || PORT == 1, "The RP2040 has UART0 and UART1");
+
+  static const bool interruptDriven = true;
+
+  // Pins default to GP0-GP3 for UART0 and GP4-GP7 for UART1, in the order
+  // TX, RX, CTS, RTS. The RX FIFO threshold rounds down to one of the
+  // PL011's levels of 4, 8, 16, 24 or 28 bytes (4 unless set); its idle
+  // timeout is fixed at 32 bit times.
+  static void begin(const SerialConfig& config, void (*isr)());
+
+  static uart_inst_t* uart()
+  {
+    return PORT == 0 ? uart0 : uart1;
+  }
+
+  static bool readable()
+  {
+    return uart_is_readable(uart());
+  }
+
+  static char getc()
+  {
+    return static_cast<char>(uart_getc(uart()));
+  }
+
+  static bool writable()
+  {
+    return uart_is_writable(uart());
+  }
+
+  static void setTxInterrupt(bool enable)
+  {
+    if(enable)
+    {
+      hw_set_bits(&uart_get_hw(uart())->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+    else
+    {
+      hw_clear_bits(&uart_get_hw(uart())->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+  }
+
+  // The TX interrupt may take the last free slot between the check and the
+  // write, so those happen with interrupts off
+  static void putc(char c)
+  {
+    while(true)
+    {
+      while(!uart_is_writable(uart()))
+      {
+      }
+
+      uint32_t status = save_and_disable_interrupts();
+      if(uart_is_writable(uart()))
+      {
+        uart_get_hw(uart())->dr = static_cast<uint8_t>(c);
+        restore_interrupts(status);
+        return;
+      }
+      restore_interrupts(status);
+    }
+  }
+};
+
+using Rp2040Uart0 = Rp2040Uart<0>;
+using Rp2040Uart1 = Rp2040Uart<1>;
+
+#endif
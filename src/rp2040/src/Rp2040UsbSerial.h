@@ -0,0 +1,50 @@
+#ifndef _RP2040_USB_SERIAL_H_
+#define _RP2040_USB_SERIAL_H_
+
+#include <Arduino.h>
+
+// UsbCdcConnection policy over the core's TinyUSB Serial, whose flush()
+// hands a partial packet to the stack. USB NAKs the host while the core's
+// buffer is full, so nothing needs dropping.
+struct Rp2040UsbSerial
+{
+  static const bool backpressure = true;
+
+  static size_t buffered()
+  {
+    int n = Serial.available();
+    return n > 0 ? n : 0;
+  }
+
+  static size_t read(char* data, size_t size)
+  {
+    return Serial.readBytes(data, size);
+  }
+
+  static void putc(char c)
+  {
+    Serial.write(static_cast<uint8_t>(c));
+  }
+
+  static size_t write(const char* data, size_t size)
+  {
+    return Serial.write(reinterpret_cast<const uint8_t*>(data), size);
+  }
+
+  static void flush()
+  {
+    Serial.flush();
+  }
+
+  static uint32_t micros()
+  {
+    return ::micros();
+  }
+
+  static void idle()
+  {
+    yield();
+  }
+};
+
+#endif
@@ -1,48 +1,34 @@
 #ifndef RELIABLE_CONNECTION_SERIAL1_H_
 #define RELIABLE_CONNECTION_SERIAL1_H_
 
-#include <Connection.h>
-#include <ring_buffer.h>
-#include <Arduino.h>
+#include <UartConnection.h>
 
-class ReliableConnectionSerial1 : public Connection
+#include "TeensyUart.h"
+
+// Sizes for this build, overridable with -D (e.g. platformio.ini build_flags).
+// The ring must be a power of two; for other ports or several sizes at
+// once, use UartConnection<TeensyUart2, RX, 0, READ> directly.
+#ifndef TRANSMISSION_SERIAL1_RX_SIZE
+#define TRANSMISSION_SERIAL1_RX_SIZE 4096
+#endif
+
+#ifndef TRANSMISSION_SERIAL1_READ_SIZE
+#define TRANSMISSION_SERIAL1_READ_SIZE 128
+#endif
+
+class ReliableConnectionSerial1 : public UartConnection<TeensyUart1, TRANSMISSION_SERIAL1_RX_SIZE, 0, TRANSMISSION_SERIAL1_READ_SIZE>
 {
 	public:
-		static const char XON  = 0x11;
-		static const char XOFF = 0x13;
-
-		static const int maxBufferSize = 4096;
-		static const int maxReadSize = 32;
+		static const int maxBufferSize = TRANSMISSION_SERIAL1_RX_SIZE;
 
 		static ReliableConnectionSerial1* instance;
 
 		static ReliableConnectionSerial1* getInstance();
 
-		// Teensy 4.1 uses serialEvent1() for interrupt handling
-		static void serialEvent1();
-
 		~ReliableConnectionSerial1() {}
 
-		void begin();
-		void enableXonXoff();
-		void disableXonXoff();
-
-		// Connection interface
-		int tryReadOne();
-		char readOne();
-		std::vector<char> read();
-		std::vector<char> read(int size);
-		void write(std::vector<char> bs);
-		bool availableForReading();
-		// end Connection
-
 	private:
-		bool xonXoffEnabled = false;
-		FlowControlRingBuffer<char, maxBufferSize> ring;
-		volatile bool paused = false;
-		volatile bool buffer_full = false;
-
 		ReliableConnectionSerial1();
 };
 
-#endif
\ No newline at end of file
+#endif
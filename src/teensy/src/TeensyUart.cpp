@@ -0,0 +1,23 @@
+#include "TeensyUart.h"
+
+uint16_t teensySerialFormat(const SerialConfig& config) {
+    if (config.data_bits == 7 && config.stop_bits == 1) {
+        if (config.parity == SerialConfig::Parity::even) {
+            return SERIAL_7E1;
+        }
+        if (config.parity == SerialConfig::Parity::odd) {
+            return SERIAL_7O1;
+        }
+    }
+
+    if (config.data_bits == 8) {
+        if (config.parity == SerialConfig::Parity::none) {
+            return config.stop_bits == 2 ? SERIAL_8N2 : SERIAL_8N1;
+        }
+        if (config.stop_bits == 1) {
+            return config.parity == SerialConfig::Parity::even ? SERIAL_8E1 : SERIAL_8O1;
+        }
+    }
+
+    return SERIAL_8N1;
+}
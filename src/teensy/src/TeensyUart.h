@@ -0,0 +1,83 @@
+#ifndef TEENSY_UART_H_
+#define TEENSY_UART_H_
+
+#include <SerialConfig.h>
+#include <Arduino.h>
+
+// The core's format for a framing; framings Teensy has no format for (5 or
+// 6 data bits, 7 bits without parity, 2 stop bits with parity) fall back
+// to 8N1
+uint16_t teensySerialFormat(const SerialConfig& config);
+
+// UartConnection policy over one of Teensy's hardware serial ports. Its
+// core already buffers RX in its own interrupt, so the connection polls
+// that buffer instead of taking an interrupt of its own. TX likewise goes
+// through the core's interrupt-driven buffer, enlarged to 1 KiB in begin().
+//
+// Each port is its own policy, so connections on several run side by side:
+//
+//   UartConnection<TeensyUart1, 4096> first;
+//   UartConnection<TeensyUart2, 4096> second;
+//   UartConnection<TeensyUart<decltype(Serial7), Serial7>, 4096> seventh;
+template<typename Serial, Serial& port>
+struct TeensyUart
+{
+	static const bool interruptDriven = false;
+
+	// TX/RX pins of -1 keep the port's defaults. RTS and CTS need explicit
+	// pins.
+	static void begin(const SerialConfig& config, void (*)()) {
+		if (config.tx_pin >= 0) {
+			port.setTX(config.tx_pin);
+		}
+		if (config.rx_pin >= 0) {
+			port.setRX(config.rx_pin);
+		}
+
+		port.begin(config.baud_rate, teensySerialFormat(config));
+		port.addMemoryForWrite(tx_memory, sizeof(tx_memory));
+
+		if (config.hardware_flow_control) {
+			if (config.rts_pin >= 0) {
+				port.attachRts(config.rts_pin);
+			}
+			if (config.cts_pin >= 0) {
+				port.attachCts(config.cts_pin);
+			}
+		}
+
+		delay(10); // Wait for initialization to take
+
+		// Clear any pending data
+		while (port.available()) {
+			port.read();
+		}
+	}
+
+	static bool readable() {
+		return port.available() > 0;
+	}
+
+	static char getc() {
+		return static_cast<char>(port.read());
+	}
+
+	static void putc(char c) {
+		port.write(static_cast<uint8_t>(c));
+	}
+
+	static void write(const char* data, size_t size) {
+		port.write(reinterpret_cast<const uint8_t*>(data), size);
+	}
+
+private:
+	// Added to the core's own TX buffer, which its TX interrupt drains, so
+	// a write only blocks once this much is queued
+	static inline uint8_t tx_memory[1024];
+};
+
+using TeensyUart1 = TeensyUart<decltype(Serial1), Serial1>;
+using TeensyUart2 = TeensyUart<decltype(Serial2), Serial2>;
+using TeensyUart3 = TeensyUart<decltype(Serial3), Serial3>;
+
+#endif
@@ -0,0 +1,177 @@
+#include <catch2/catch_all.hpp>
+
+#include <UartConnection.h>
+#include <UsbCdcConnection.h>
+#include <static_vector.h>
+
+#include "SimulatedUart.h"
+#include "SimulatedUsbSerial.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Replaces the global allocator for the whole test binary, counting what
+// the current thread allocates while an AllocationTrap is alive. Only
+// library calls go inside a trap: the simulated hardware and the checks
+// allocate freely outside one.
+static thread_local bool trapping = false;
+static thread_local size_t trapped = 0;
+
+void* operator new(size_t size)
+{
+  if (trapping) {
+    trapped++;
+  }
+
+  void* block = std::malloc(size ? size : 1);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+// Inlined into a container, the free() looks to GCC 11+ like one of a
+// new'd block
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* block) noexcept
+{
+  std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+  std::free(block);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+struct AllocationTrap
+{
+  AllocationTrap()
+  {
+    trapped = 0;
+    trapping = true;
+  }
+
+  ~AllocationTrap()
+  {
+    trapping = false;
+  }
+
+  size_t count() const
+  {
+    return trapped;
+  }
+};
+
+using EchoUart = SimulatedUart<30, false>;
+using Usb = SimulatedUsbSerial;
+
+static std::string pattern(size_t length, int seed)
+{
+  std::string data;
+  for (size_t i = 0; i < length; i++) {
+    data += static_cast<char>(i * 11 + seed);
+  }
+  return data;
+}
+
+TEST_CASE("allocation trap catches a std::vector read", "[heap]")
+{
+  EchoUart::reset();
+  UartConnection<EchoUart, 256> connection;
+  connection.begin();
+  EchoUart::receive("hello");
+
+  size_t allocations;
+  {
+    AllocationTrap trap;
+    std::vector<char> got = connection.read(5);
+    allocations = trap.count();
+  }
+  CHECK(allocations > 0);
+}
+
+TEST_CASE("echo loop runs without the heap once begun", "[heap]")
+{
+  EchoUart::reset();
+  Usb::reset();
+  Usb::capacity = 1 << 16;
+
+  UartConnection<EchoUart, 256, 0, 64> serial;
+  UsbCdcConnection<Usb, 256, 64> usb;
+  serial.enableXonXoff();
+  usb.enableXonXoff();
+  serial.begin();
+  usb.begin();
+
+  // Room for everything the loop will write, so recording it does not grow
+  EchoUart::tx.reserve(1 << 16);
+  Usb::tx.reserve(1 << 16);
+  Usb::writes.reserve(1 << 12);
+
+  std::string to_usb;
+  std::string to_serial;
+  size_t allocations = 0;
+  for (int step = 0; step < 500; step++) {
+    std::string from_serial = pattern(step % 90, step);
+    std::string from_host = pattern(step % 70, step + 1);
+    EchoUart::receive(from_serial);
+    Usb::receive(from_host);
+    to_usb += from_serial;
+    to_serial += from_host;
+
+    // The echo-server sketch's loop, plus the span calls
+    AllocationTrap trap;
+    while (serial.availableForReading() || usb.availableForReading()) {
+      auto output = serial.read();
+      usb.write(output);
+
+      char buffer[32];
+      size_t n = usb.read(buffer, sizeof(buffer));
+      serial.write(buffer, n);
+
+      int c = usb.tryReadOne();
+      if (c >= 0) {
+        char byte = static_cast<char>(c);
+        serial.write(&byte, 1);
+      }
+    }
+    usb.poll();
+    allocations += trap.count();
+  }
+
+  {
+    AllocationTrap trap;
+    usb.flush();
+    serial.flush();
+    allocations += trap.count();
+  }
+
+  CHECK(allocations == 0);
+  CHECK(Usb::tx == std::string(1, usb.XON) + to_usb);
+  CHECK(EchoUart::tx == std::string(1, serial.XON) + to_serial);
+}
+
+TEST_CASE("static vector stops at its capacity", "[heap]")
+{
+  StaticVector<char, 4> bytes("ab", 2);
+  CHECK(bytes.size() == 2);
+  CHECK(bytes.append("cdef", 4) == 2);
+  CHECK(bytes.full());
+  CHECK_FALSE(bytes.push_back('g'));
+  CHECK(std::string(bytes.begin(), bytes.end()) == "abcd");
+  CHECK(bytes.resize(10) == 4);
+
+  // Still readable as a std::vector outside TRANSMISSION_NO_HEAP
+  std::vector<char> copy = bytes;
+  CHECK(copy.size() == 4);
+}
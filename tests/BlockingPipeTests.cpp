@@ -0,0 +1,75 @@
+#include <catch2/catch_all.hpp>
+
+#include <BlockingPipe.h>
+#include <Pipe.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// One slot of each ring stays empty to tell full from empty
+static const size_t pipeCapacity = TRANSMISSION_PIPE_SIZE - 1;
+
+TEST_CASE("pipe reports short writes when full", "[pipe]")
+{
+  Pipe pipe;
+
+  std::vector<char> big(TRANSMISSION_PIPE_SIZE + 1000, 'x');
+  size_t written = pipe.getEndA().tryWrite(big);
+
+  CHECK(written == pipeCapacity);
+  CHECK(pipe.getEndA().writeSpace() == 0);
+  CHECK(pipe.getEndB().read(static_cast<int>(big.size())).size() == pipeCapacity);
+}
+
+TEST_CASE("blocking pipe moves large writes across threads without loss", "[pipe]")
+{
+  BlockingPipe pipe;
+
+  std::vector<char> sent(1 << 20);
+  for (size_t i = 0; i < sent.size(); i++) {
+    sent[i] = static_cast<char>(i * 7);
+  }
+
+  std::thread producer([&] {
+    pipe.getEndA().write(sent);
+  });
+
+  std::vector<char> received = pipe.getEndB().read(static_cast<int>(sent.size()));
+  producer.join();
+
+  REQUIRE(received.size() == sent.size());
+  CHECK(received == sent);
+}
+
+TEST_CASE("blocking pipe timeouts return short counts", "[pipe]")
+{
+  BlockingPipe pipe;
+
+  char c;
+  auto start = std::chrono::steady_clock::now();
+  CHECK_FALSE(pipe.getEndB().readOne(c, 20ms));
+  CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+
+  std::vector<char> big(TRANSMISSION_PIPE_SIZE + 1000, 'y');
+  CHECK(pipe.getEndA().write(big.data(), big.size(), 10ms) == pipeCapacity);
+  CHECK(pipe.getEndA().write(big.data(), big.size(), 0ms) == 0);
+  CHECK(pipe.getEndB().read(100, 0ms).size() == 100);
+}
+
+TEST_CASE("closing a blocking pipe wakes a blocked reader", "[pipe]")
+{
+  BlockingPipe pipe;
+
+  std::thread closer([&] {
+    std::this_thread::sleep_for(10ms);
+    pipe.getEndA().close();
+  });
+
+  std::vector<char> received = pipe.getEndB().read(10);
+  closer.join();
+
+  CHECK(received.empty());
+  CHECK(pipe.getEndB().isClosed());
+}
@@ -0,0 +1,238 @@
+#include <catch2/catch_all.hpp>
+
+#include <CaptureConnection.h>
+#include <CaptureFile.h>
+#include <CaptureReplayer.h>
+#include <Pipe.h>
+
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// Unique per process and call, so parallel test runs don't share files
+static std::string tempPath(const std::string& name)
+{
+  static int count = 0;
+  std::string unique = "transmission-" + std::to_string(getpid()) + "-" + std::to_string(count++) + "-" + name;
+  return (std::filesystem::temp_directory_path() / unique).string();
+}
+
+TEST_CASE("capture records both directions", "[capture]")
+{
+  std::string path = tempPath("capture.txcp");
+
+  Pipe pipe;
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+
+  CaptureConnection connection(pipe.getEndA(), capture);
+
+  connection.write(std::string("hello"));
+  std::vector<char> echoed = pipe.getEndB().read(5);
+  pipe.getEndB().write(echoed);
+
+  std::vector<char> received = connection.read(5);
+  REQUIRE(std::string(received.begin(), received.end()) == "hello");
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+
+  CaptureFile::Record record;
+  REQUIRE(capture.next(record));
+  CHECK(record.direction == CaptureFile::Direction::tx);
+  CHECK(std::string(record.data, record.length) == "hello");
+
+  REQUIRE(capture.next(record));
+  CHECK(record.direction == CaptureFile::Direction::rx);
+  CHECK(std::string(record.data, record.length) == "hello");
+
+  CHECK_FALSE(capture.next(record));
+
+  std::string pcap_path = tempPath("capture.pcap");
+  REQUIRE(capture.exportPcap(pcap_path));
+  // Global header + two packets of (record header + direction byte + 5 bytes)
+  CHECK(std::filesystem::file_size(pcap_path) == 24 + 2 * (16 + 1 + 5));
+
+  capture.close();
+  std::remove(path.c_str());
+  std::remove(pcap_path.c_str());
+}
+
+TEST_CASE("capture readOne records only bytes that arrived", "[capture]")
+{
+  std::string path = tempPath("read-one.txcp");
+
+  Pipe pipe;
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+
+  CaptureConnection connection(pipe.getEndA(), capture);
+
+  // Nothing to read yet: no phantom NUL in the capture
+  CHECK(connection.readOne() == 0);
+  CHECK(connection.tryReadOne() == -1);
+
+  pipe.getEndB().write(std::vector<char>{'a', '\0'});
+  CHECK(connection.readOne() == 'a');
+  CHECK(connection.readOne() == 0);
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+  CaptureFile::Record record;
+  REQUIRE(capture.next(record));
+  CHECK(std::string(record.data, record.length) == "a");
+  REQUIRE(capture.next(record));
+  CHECK(std::string(record.data, record.length) == std::string(1, '\0'));
+  CHECK_FALSE(capture.next(record));
+
+  capture.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("capture export cuts records to the pcap snaplen", "[capture]")
+{
+  std::string path = tempPath("snaplen.txcp");
+
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+
+  std::vector<char> big(0x40000 + 100, 'b');
+  REQUIRE(capture.append(CaptureFile::Direction::rx, big.data(), big.size()));
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+  std::string pcap_path = tempPath("snaplen.pcap");
+  REQUIRE(capture.exportPcap(pcap_path));
+  capture.close();
+
+  // The packet holds snaplen bytes, direction byte included, but still
+  // reports its full length
+  CHECK(std::filesystem::file_size(pcap_path) == 24 + 16 + 0x40000);
+
+  FILE* in = fopen(pcap_path.c_str(), "rb");
+  REQUIRE(in);
+  uint32_t headers[6 + 4];
+  REQUIRE(fread(headers, sizeof(headers), 1, in) == 1);
+  fclose(in);
+  CHECK(headers[4] == 0x40000);
+  CHECK(headers[8] == 0x40000);
+  CHECK(headers[9] == big.size() + 1);
+
+  std::remove(path.c_str());
+  std::remove(pcap_path.c_str());
+}
+
+TEST_CASE("capture grows past its initial mapping", "[capture]")
+{
+  std::string path = tempPath("grow.txcp");
+
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+
+  std::vector<char> chunk(4000, 'x');
+  for (int i = 0; i < 1000; i++) {
+    REQUIRE(capture.append(CaptureFile::Direction::rx, chunk.data(), chunk.size()));
+  }
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+  int records = 0;
+  CaptureFile::Record record;
+  while (capture.next(record)) {
+    REQUIRE(record.length == chunk.size());
+    records++;
+  }
+  CHECK(records == 1000);
+
+  capture.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("replayer resumes chunks larger than the pipe", "[capture]")
+{
+  std::string path = tempPath("replay.txcp");
+
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+
+  std::vector<char> big(10000);
+  for (size_t i = 0; i < big.size(); i++) {
+    big[i] = static_cast<char>(i);
+  }
+  capture.append(CaptureFile::Direction::rx, big.data(), big.size());
+  capture.append(CaptureFile::Direction::tx, "ignored", 7);
+  capture.append(CaptureFile::Direction::rx, "tail", 4);
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+
+  Pipe pipe;
+  CaptureReplayer replayer(capture, pipe.getEndA(), CaptureFile::Direction::rx,
+                           CaptureReplayer::asFastAsPossible);
+
+  std::vector<char> received;
+  while (replayer.poll() || pipe.getEndB().availableForReading()) {
+    std::vector<char> part = pipe.getEndB().read(1024);
+    received.insert(received.end(), part.begin(), part.end());
+  }
+
+  REQUIRE(received.size() == big.size() + 4);
+  CHECK(std::equal(big.begin(), big.end(), received.begin()));
+  CHECK(std::string(received.end() - 4, received.end()) == "tail");
+  CHECK(replayer.bytesReplayed() == big.size() + 4);
+
+  capture.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("replayer keeps the recorded timing", "[capture]")
+{
+  std::string path = tempPath("timed.txcp");
+
+  CaptureFile capture(path);
+  REQUIRE(capture.openForWriting());
+  capture.append(CaptureFile::Direction::rx, "first", 5);
+  std::this_thread::sleep_for(100ms);
+  capture.append(CaptureFile::Direction::rx, "second", 6);
+  capture.close();
+
+  REQUIRE(capture.openForReading());
+
+  Pipe pipe;
+  CaptureReplayer replayer(capture, pipe.getEndA(), CaptureFile::Direction::rx,
+                           CaptureReplayer::originalSpeed);
+
+  // The first chunk is due at once, the second only after the recorded gap
+  auto start = std::chrono::steady_clock::now();
+  while (replayer.bytesReplayed() == 0 && std::chrono::steady_clock::now() - start < 50ms) {
+    CHECK(replayer.poll());
+  }
+  std::vector<char> part = pipe.getEndB().read(64);
+  CHECK(std::string(part.begin(), part.end()) == "first");
+  CHECK(replayer.bytesReplayed() == 5);
+
+  replayer.run();
+  CHECK(std::chrono::steady_clock::now() - start >= 100ms);
+  part = pipe.getEndB().read(64);
+  CHECK(std::string(part.begin(), part.end()) == "second");
+  CHECK(replayer.finished());
+
+  // Ten times faster: the gap shrinks to about 10 ms
+  replayer.restart();
+  replayer.setSpeed(10.0);
+  start = std::chrono::steady_clock::now();
+  replayer.run();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(elapsed >= 10ms);
+  CHECK(elapsed < 80ms);
+  part = pipe.getEndB().read(64);
+  CHECK(std::string(part.begin(), part.end()) == "firstsecond");
+
+  capture.close();
+  std::remove(path.c_str());
+}
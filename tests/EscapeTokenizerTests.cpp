@@ -0,0 +1,146 @@
+#include <catch2/catch_all.hpp>
+
+#include <EscapeTokenizer.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct Collected {
+  std::vector<std::pair<EscapeTokenizer::Token, std::string>> tokens;
+
+  void operator()(EscapeTokenizer::Token token, const char* data, size_t length)
+  {
+    // Merge adjacent text runs so results don't depend on chunking
+    if (token == EscapeTokenizer::Token::text && !tokens.empty() && tokens.back().first == token) {
+      tokens.back().second.append(data, length);
+    } else {
+      tokens.emplace_back(token, std::string(data, length));
+    }
+  }
+
+  std::string joined() const
+  {
+    std::string all;
+    for (auto& token : tokens) {
+      all += token.second;
+    }
+    return all;
+  }
+};
+
+static Collected tokenize(const std::string& input, size_t chunk)
+{
+  EscapeTokenizer tokenizer;
+  Collected collected;
+  for (size_t i = 0; i < input.size(); i += chunk) {
+    tokenizer.feed(input.data() + i, std::min(chunk, input.size() - i), collected);
+  }
+  return collected;
+}
+
+TEST_CASE("escape tokenizer separates text from whole sequences", "[escape]")
+{
+  std::string input = "plain \x1b[38;5;208mcolor\x1b[0m \x1b" "7\x1b(B\x1bOP\x1b]0;title\x07" "done";
+
+  Collected collected = tokenize(input, input.size());
+
+  std::vector<std::pair<EscapeTokenizer::Token, std::string>> expected = {
+    {EscapeTokenizer::Token::text, "plain "},
+    {EscapeTokenizer::Token::sequence, "\x1b[38;5;208m"},
+    {EscapeTokenizer::Token::text, "color"},
+    {EscapeTokenizer::Token::sequence, "\x1b[0m"},
+    {EscapeTokenizer::Token::text, " "},
+    {EscapeTokenizer::Token::sequence, "\x1b" "7"},
+    {EscapeTokenizer::Token::sequence, "\x1b(B"},
+    {EscapeTokenizer::Token::sequence, "\x1bOP"},
+    {EscapeTokenizer::Token::sequence, "\x1b]0;title\x07"},
+    {EscapeTokenizer::Token::text, "done"},
+  };
+  CHECK(collected.tokens == expected);
+}
+
+TEST_CASE("escape tokenizer gives the same tokens however the input is split", "[escape]")
+{
+  std::string input = "a\x1b[1;31mb\x1bP1$r0m\x1b\\c\x1b]2;t\x1b\\d\x1b[?25l";
+  Collected whole = tokenize(input, input.size());
+
+  for (size_t chunk = 1; chunk < input.size(); chunk++) {
+    Collected split = tokenize(input, chunk);
+    CHECK(split.tokens == whole.tokens);
+  }
+}
+
+TEST_CASE("escape tokenizer holds a partial sequence without waiting", "[escape]")
+{
+  EscapeTokenizer tokenizer;
+  Collected collected;
+
+  tokenizer.feed("key\x1b[1", 6, collected);
+  REQUIRE(collected.tokens.size() == 1);
+  CHECK(tokenizer.pending());
+  CHECK(tokenizer.pendingLength() == 3);
+
+  tokenizer.feed("5~", 2, collected);
+  REQUIRE(collected.tokens.size() == 2);
+  CHECK(collected.tokens[1].second == "\x1b[15~");
+  CHECK_FALSE(tokenizer.pending());
+
+  // A lone ESC keypress goes out when the caller decides nothing follows
+  tokenizer.feed("\x1b", 1, collected);
+  CHECK(collected.tokens.size() == 2);
+  tokenizer.flush(collected);
+  REQUIRE(collected.tokens.size() == 3);
+  CHECK(collected.tokens[2].first == EscapeTokenizer::Token::partialSequence);
+  CHECK(collected.tokens[2].second == "\x1b");
+  CHECK_FALSE(tokenizer.pending());
+}
+
+TEST_CASE("escape tokenizer never drops bytes", "[escape]")
+{
+  // Aborted CSI, CAN, ESC ESC, and an OSC longer than the sequence buffer
+  std::string title(3 * EscapeTokenizer::maxSequenceLength, 't');
+  std::string input = "x\x1b[12\x1b[m\x1b[3\x18y\x1b\x1bz\x1b]0;" + title + "\x1b\\end\x1b]1;a\x1bM";
+
+  for (size_t chunk : {size_t(1), size_t(7), input.size()}) {
+    Collected collected = tokenize(input, chunk);
+    CHECK(collected.joined() == input);
+  }
+
+  Collected collected = tokenize(input, input.size());
+  CHECK(collected.tokens[1].second == "\x1b[12");
+  CHECK(collected.tokens[2].second == "\x1b[m");
+  CHECK(collected.tokens[3].second == "\x1b[3\x18");
+}
+
+TEST_CASE("escape scan finds the first ESC at any offset", "[escape]")
+{
+  std::vector<char> data(200, 'a');
+  CHECK(EscapeTokenizer::findEscape(data.data(), data.size()) == data.size());
+
+  for (size_t at = 0; at < data.size(); at++) {
+    data[at] = 0x1B;
+    CHECK(EscapeTokenizer::findEscape(data.data(), data.size()) == at);
+    CHECK(EscapeTokenizer::findEscape(data.data() + 1, data.size() - 1) == (at == 0 ? data.size() - 1 : at - 1));
+    data[at] = 'a';
+  }
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("escape tokenizer throughput on terminal output", "[.][benchmark]")
+{
+  std::string screen;
+  while (screen.size() < (1 << 20)) {
+    screen += "\x1b[32mok\x1b[0m  build step finished, output written to disk without errors\r\n";
+  }
+
+  BENCHMARK("tokenize 1 MiB of colored terminal output")
+  {
+    EscapeTokenizer tokenizer;
+    size_t total = 0;
+    tokenizer.feed(screen.data(), screen.size(), [&](EscapeTokenizer::Token, const char*, size_t length) {
+      total += length;
+    });
+    return total;
+  };
+}
@@ -0,0 +1,162 @@
+#include <catch2/catch_all.hpp>
+
+#include <EventLoop.h>
+#include <FdConnection.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static void runFor(EventLoop& loop, std::chrono::milliseconds duration)
+{
+  auto deadline = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    loop.runOnce(1);
+  }
+}
+
+static void echoManyConnections(bool edge_triggered)
+{
+  EventLoop loop;
+  REQUIRE(loop.begin());
+
+  const int count = 64;
+  std::vector<std::unique_ptr<FdConnection>> connections;
+  std::vector<int> peers;
+
+  for (int i = 0; i < count; i++) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    peers.push_back(fds[1]);
+
+    auto connection = std::make_unique<FdConnection>(loop, fds[0], edge_triggered);
+    connection->setReadCallback([](FdConnection& c) {
+      c.write(c.read(FdConnection::maxReadSize));
+    });
+    REQUIRE(connection->begin());
+    connections.push_back(std::move(connection));
+  }
+
+  for (int i = 0; i < count; i++) {
+    std::string message = "connection " + std::to_string(i);
+    REQUIRE(::write(peers[i], message.data(), message.size()) == static_cast<ssize_t>(message.size()));
+  }
+
+  runFor(loop, 50ms);
+
+  for (int i = 0; i < count; i++) {
+    std::string expected = "connection " + std::to_string(i);
+    char buffer[64];
+    ssize_t n = ::read(peers[i], buffer, sizeof(buffer));
+    REQUIRE(n == static_cast<ssize_t>(expected.size()));
+    CHECK(std::string(buffer, n) == expected);
+    close(peers[i]);
+  }
+}
+
+TEST_CASE("event loop echoes on many connections from one thread", "[loop]")
+{
+  echoManyConnections(true);
+  echoManyConnections(false);
+}
+
+TEST_CASE("event loop resumes a stalled connection once it is read", "[loop]")
+{
+  for (bool edge_triggered : {true, false}) {
+    EventLoop loop;
+    REQUIRE(loop.begin());
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    FdConnection connection(loop, fds[0], edge_triggered);
+    REQUIRE(connection.begin());
+
+    // More than the RX ring holds, sent before anyone reads
+    std::vector<char> sent(3 * FdConnection::maxBufferSize);
+    for (size_t i = 0; i < sent.size(); i++) {
+      sent[i] = static_cast<char>(i);
+    }
+    REQUIRE(::write(fds[1], sent.data(), sent.size()) == static_cast<ssize_t>(sent.size()));
+
+    std::vector<char> received;
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (received.size() < sent.size() && std::chrono::steady_clock::now() < deadline) {
+      loop.runOnce(1);
+      std::vector<char> part = connection.read(1000);
+      received.insert(received.end(), part.begin(), part.end());
+    }
+
+    REQUIRE(received.size() == sent.size());
+    CHECK(received == sent);
+    close(fds[1]);
+  }
+}
+
+TEST_CASE("event loop timers fire, repeat and cancel", "[loop]")
+{
+  EventLoop loop;
+  REQUIRE(loop.begin());
+
+  int once = 0;
+  int repeating = 0;
+  int cancelled = 0;
+
+  loop.addTimer(5ms, [&] { once++; });
+  loop.addTimer(2ms, [&] { repeating++; }, 5ms);
+  EventLoop::TimerId id = loop.addTimer(5ms, [&] { cancelled++; });
+  loop.cancelTimer(id);
+
+  runFor(loop, 60ms);
+
+  CHECK(once == 1);
+  CHECK(repeating >= 5);
+  CHECK(cancelled == 0);
+}
+
+TEST_CASE("event loop runs posted tasks and stops from another thread", "[loop]")
+{
+  EventLoop loop;
+  REQUIRE(loop.begin());
+
+  std::atomic<bool> ran(false);
+  std::atomic<bool> on_loop_thread(false);
+
+  std::thread other([&] {
+    std::this_thread::sleep_for(10ms);
+    loop.post([&] {
+      ran.store(true);
+      on_loop_thread.store(loop.inLoopThread());
+    });
+    std::this_thread::sleep_for(10ms);
+    loop.stop();
+  });
+
+  loop.run();
+  other.join();
+
+  CHECK(ran.load());
+  CHECK(on_loop_thread.load());
+}
+
+TEST_CASE("event loop keeps a stop that comes before run", "[loop]")
+{
+  for (int round = 0; round < 100; round++) {
+    EventLoop loop;
+    REQUIRE(loop.begin());
+
+    std::thread t([&] { loop.run(); });
+    loop.stop();
+    t.join();
+  }
+
+  // Stopped outright before any thread runs it
+  EventLoop loop;
+  REQUIRE(loop.begin());
+  loop.stop();
+  loop.run();
+}
@@ -0,0 +1,214 @@
+#include <catch2/catch_all.hpp>
+
+#include <frame_receiver.h>
+
+#include "SimulatedUart.h"
+#include "SimulatedUsbSerial.h"
+
+#include <string>
+#include <vector>
+
+using BulkUart = SimulatedBufferedUart<40>;
+using FifoUart = SimulatedUart<41>;
+
+struct ClockedUart : SimulatedBufferedUart<42>
+{
+  static inline uint32_t now = 0;
+
+  static uint32_t micros()
+  {
+    return now;
+  }
+};
+
+template<typename Receiver>
+static std::vector<std::string> readAll(Receiver& receiver, std::vector<FrameDescriptor>* descriptors = nullptr)
+{
+  std::vector<std::string> frames;
+  char buffer[256];
+  receiver.drain(buffer, sizeof(buffer), [&](const FrameDescriptor& frame, const char* data, size_t size) {
+    frames.emplace_back(data, size);
+    if (descriptors) {
+      descriptors->push_back(frame);
+    }
+  });
+  return frames;
+}
+
+TEST_CASE("frame receiver queues a descriptor per frame from the interrupt", "[frame]")
+{
+  BulkUart::reset(16, 2);
+  FrameReceiver<BulkUart, 64, 8> receiver;
+  BulkUart::on_event = [&]() { receiver.service(); };
+
+  BulkUart::receive("first\nsecond\nthi");
+  BulkUart::idleFor(2);
+  CHECK(receiver.available() == 2);
+  CHECK(receiver.count() == 16);
+
+  // A frame completes only once its delimiter is in
+  BulkUart::receive("rd\n");
+  BulkUart::idleFor(2);
+
+  std::vector<FrameDescriptor> descriptors;
+  std::vector<std::string> frames = readAll(receiver, &descriptors);
+  std::vector<std::string> expected{"first\n", "second\n", "third\n"};
+  CHECK(frames == expected);
+  CHECK(descriptors[1].offset == 6);
+  CHECK(descriptors[2].length == 6);
+  CHECK_FALSE(descriptors[2].truncated);
+  CHECK(receiver.count() == 0);
+
+  // Frames keep their shape as the ring wraps
+  for (int round = 0; round < 20; round++) {
+    std::string line = "line " + std::to_string(round) + std::string(round % 9, '.') + "\n";
+    BulkUart::receive(line);
+    BulkUart::idleFor(2);
+
+    FrameDescriptor frame;
+    char buffer[64];
+    REQUIRE(receiver.read(frame, buffer, sizeof(buffer)));
+    CHECK(std::string(buffer, frame.length) == line);
+    CHECK_FALSE(receiver.read(frame, buffer, sizeof(buffer)));
+  }
+}
+
+TEST_CASE("frame receiver works over a FIFO policy and other delimiters", "[frame]")
+{
+  FifoUart::reset(4, 2);
+  FrameReceiver<FifoUart, 32, 4, '\0'> receiver;
+  FifoUart::on_event = [&]() { receiver.service(); };
+
+  FifoUart::receive(std::string("ab\0cd\0e", 7));
+  FifoUart::idleFor(2);
+
+  std::vector<std::string> frames = readAll(receiver);
+  std::vector<std::string> expected{std::string("ab\0", 3), std::string("cd\0", 3)};
+  CHECK(frames == expected);
+  CHECK(receiver.count() == 1);
+}
+
+TEST_CASE("frame receiver stamps each frame as its delimiter arrives", "[frame]")
+{
+  ClockedUart::reset(1, 1);
+  FrameReceiver<ClockedUart, 64, 8> receiver;
+  ClockedUart::on_event = [&]() { receiver.service(); };
+
+  ClockedUart::now = 100;
+  ClockedUart::receive("a\n");
+  ClockedUart::now = 250;
+  ClockedUart::receive("bc");
+  ClockedUart::now = 400;
+  ClockedUart::receive("\n");
+
+  std::vector<FrameDescriptor> descriptors;
+  readAll(receiver, &descriptors);
+  REQUIRE(descriptors.size() == 2);
+  CHECK(descriptors[0].timestamp == 100);
+  CHECK(descriptors[1].timestamp == 400);
+}
+
+TEST_CASE("frame receiver marks frames cut short by a full ring", "[frame]")
+{
+  BulkUart::reset(1000, 1);
+  FrameReceiver<BulkUart, 16, 8> receiver;
+
+  // 15 bytes fit; the rest of the frame, its delimiter included, is dropped
+  BulkUart::receive(std::string(20, 'x') + "\n" + "ok\n");
+  receiver.service();
+  CHECK(receiver.droppedBytes() == 9);
+
+  std::vector<FrameDescriptor> descriptors;
+  std::vector<std::string> frames = readAll(receiver, &descriptors);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == std::string(15, 'x'));
+  CHECK(descriptors[0].truncated);
+
+  // The next frame starts whole
+  BulkUart::receive("next\n");
+  receiver.service();
+  frames = readAll(receiver, &descriptors);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == "next\n");
+  CHECK_FALSE(descriptors.back().truncated);
+}
+
+TEST_CASE("frame receiver leaves bytes in a driver with backpressure", "[frame]")
+{
+  SimulatedUsbSerial::reset();
+  FrameReceiver<SimulatedUsbSerial, 16, 8> receiver;
+
+  // Three frames fill the ring; the fourth waits in the driver
+  SimulatedUsbSerial::receive("aaaa\nbbbb\ncccc\ndddd\n");
+  receiver.service();
+  CHECK(receiver.available() == 3);
+  CHECK(SimulatedUsbSerial::buffered() == 5);
+
+  std::vector<std::string> frames = readAll(receiver);
+  std::vector<std::string> expected{"aaaa\n", "bbbb\n", "cccc\n"};
+  CHECK(frames == expected);
+
+  receiver.service();
+  frames = readAll(receiver);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == "dddd\n");
+  CHECK(receiver.droppedBytes() == 0);
+
+  // A frame longer than the ring can never complete: it is cut at its
+  // delimiter, and the frame after it still waits whole in the driver
+  SimulatedUsbSerial::receive(std::string(20, 'x') + "\n" + "ok\n");
+  receiver.service();
+  CHECK(receiver.droppedBytes() == 6);
+  CHECK(SimulatedUsbSerial::buffered() == 3);
+
+  std::vector<FrameDescriptor> descriptors;
+  frames = readAll(receiver, &descriptors);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == std::string(15, 'x'));
+  CHECK(descriptors[0].truncated);
+
+  receiver.service();
+  frames = readAll(receiver, &descriptors);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == "ok\n");
+  CHECK_FALSE(descriptors.back().truncated);
+}
+
+TEST_CASE("frame receiver joins frames rather than lose them when its queue is full", "[frame]")
+{
+  BulkUart::reset(1000, 1);
+  FrameReceiver<BulkUart, 64, 4> receiver;
+
+  BulkUart::receive("a\nb\nc\nd\ne\n");
+  receiver.service();
+  CHECK(receiver.available() == 3);
+  CHECK(receiver.mergedFrames() == 2);
+
+  std::vector<std::string> frames = readAll(receiver);
+  std::vector<std::string> expected{"a\n", "b\n", "c\n"};
+  CHECK(frames == expected);
+
+  BulkUart::receive("f\n");
+  receiver.service();
+  frames = readAll(receiver);
+  REQUIRE(frames.size() == 1);
+  CHECK(frames[0] == "d\ne\nf\n");
+}
+
+TEST_CASE("frame receiver skips what does not fit the caller's buffer", "[frame]")
+{
+  BulkUart::reset(1000, 1);
+  FrameReceiver<BulkUart, 64, 4> receiver;
+
+  BulkUart::receive("a long frame\nshort\n");
+  receiver.service();
+
+  FrameDescriptor frame;
+  char buffer[6];
+  REQUIRE(receiver.read(frame, buffer, sizeof(buffer)));
+  CHECK(frame.length == 13);
+  CHECK(std::string(buffer, 6) == "a long");
+
+  REQUIRE(receiver.read(frame, buffer, sizeof(buffer)));
+  CHECK(std::string(buffer, frame.length) == "short\n");
+}
@@ -0,0 +1,400 @@
+#include <catch2/catch_all.hpp>
+
+#include <ConnectionDriver.h>
+#include <IoUringLoop.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static void runFor(ConnectionDriver& driver, std::chrono::milliseconds duration)
+{
+  auto deadline = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    driver.runOnce(1);
+  }
+}
+
+static void echoManyConnections(ConnectionDriver::Backend backend)
+{
+  ConnectionDriver driver(backend);
+  REQUIRE(driver.begin());
+
+  const int count = 64;
+  std::vector<int> peers;
+
+  for (int i = 0; i < count; i++) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    peers.push_back(fds[1]);
+
+    Connection* connection = driver.attach(fds[0], [](Connection& c) {
+      c.write(c.read(1024));
+    });
+    REQUIRE(connection != nullptr);
+  }
+
+  for (int i = 0; i < count; i++) {
+    std::string message = "connection " + std::to_string(i);
+    REQUIRE(::write(peers[i], message.data(), message.size()) == static_cast<ssize_t>(message.size()));
+  }
+
+  runFor(driver, 50ms);
+
+  for (int i = 0; i < count; i++) {
+    std::string expected = "connection " + std::to_string(i);
+    char buffer[64];
+    ssize_t n = ::read(peers[i], buffer, sizeof(buffer));
+    REQUIRE(n == static_cast<ssize_t>(expected.size()));
+    CHECK(std::string(buffer, n) == expected);
+    close(peers[i]);
+  }
+}
+
+TEST_CASE("connection driver echoes on many connections with either backend", "[uring]")
+{
+  echoManyConnections(ConnectionDriver::Backend::epoll);
+
+  if (!IoUringLoop::available()) {
+    WARN("io_uring unavailable, only the epoll backend was tested");
+    return;
+  }
+
+  echoManyConnections(ConnectionDriver::Backend::ioUring);
+}
+
+TEST_CASE("io_uring connection resumes a full RX ring and reports hangup", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  IoUringLoop loop;
+  REQUIRE(loop.begin());
+
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  bool closed = false;
+  IoUringConnection connection(loop, fds[0]);
+  connection.setCloseCallback([&](IoUringConnection&) { closed = true; });
+  REQUIRE(connection.begin());
+
+  // More than the RX ring holds, sent before anyone reads
+  std::vector<char> sent(3 * IoUringConnection::maxBufferSize);
+  for (size_t i = 0; i < sent.size(); i++) {
+    sent[i] = static_cast<char>(i);
+  }
+  REQUIRE(::write(fds[1], sent.data(), sent.size()) == static_cast<ssize_t>(sent.size()));
+
+  std::vector<char> received;
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (received.size() < sent.size() && std::chrono::steady_clock::now() < deadline) {
+    loop.runOnce(1);
+    std::vector<char> part = connection.read(1000);
+    received.insert(received.end(), part.begin(), part.end());
+  }
+
+  REQUIRE(received.size() == sent.size());
+  CHECK(received == sent);
+
+  close(fds[1]);
+  deadline = std::chrono::steady_clock::now() + 1s;
+  while (!closed && std::chrono::steady_clock::now() < deadline) {
+    loop.runOnce(1);
+  }
+
+  CHECK(closed);
+  CHECK_FALSE(connection.isOpen());
+}
+
+TEST_CASE("io_uring sockets share the buffer pool without losing order", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  IoUringLoop loop;
+  REQUIRE(loop.begin());
+  if (!loop.providedBuffers()) {
+    WARN("no provided buffer rings, sockets use plain reads");
+  }
+
+  // Together far more than the pool and RX rings hold, so buffers get
+  // parked, recvs cancelled and the pool runs dry before anyone reads
+  const int count = 8;
+  const size_t size = 12 * IoUringConnection::maxBufferSize;
+
+  std::vector<int> peers;
+  std::vector<std::unique_ptr<IoUringConnection>> connections;
+  std::vector<std::vector<char>> sent(count);
+  std::vector<std::vector<char>> received(count);
+  std::vector<bool> closed(count, false);
+
+  for (int i = 0; i < count; i++) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int sndbuf = 1 << 20;
+    setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    peers.push_back(fds[1]);
+
+    connections.emplace_back(new IoUringConnection(loop, fds[0]));
+    connections[i]->setCloseCallback([&closed, i](IoUringConnection&) { closed[i] = true; });
+    REQUIRE(connections[i]->begin());
+
+    for (size_t j = 0; j < size; j++) {
+      sent[i].push_back(static_cast<char>(j * 7 + i));
+    }
+  }
+
+  std::vector<size_t> written(count, 0);
+  auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool done = true;
+    for (int i = 0; i < count; i++) {
+      if (written[i] < size) {
+        ssize_t n = ::send(peers[i], sent[i].data() + written[i], size - written[i], MSG_DONTWAIT);
+        if (n > 0) {
+          written[i] += n;
+        }
+        done = done && written[i] == size;
+      }
+    }
+    loop.runOnce(1);
+    if (done) {
+      break;
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    REQUIRE(written[i] == size);
+    close(peers[i]);
+  }
+  for (int i = 0; i < 20; i++) {
+    loop.runOnce(1);
+  }
+
+  deadline = std::chrono::steady_clock::now() + 2s;
+  auto finished = [&] {
+    for (int i = 0; i < count; i++) {
+      if (!closed[i] || received[i].size() < size) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!finished() && std::chrono::steady_clock::now() < deadline) {
+    for (int i = 0; i < count; i++) {
+      std::vector<char> part = connections[i]->read(1500);
+      received[i].insert(received[i].end(), part.begin(), part.end());
+    }
+    loop.runOnce(1);
+  }
+
+  for (int i = 0; i < count; i++) {
+    REQUIRE(received[i].size() == size);
+    CHECK(received[i] == sent[i]);
+    CHECK(closed[i]);
+  }
+}
+
+TEST_CASE("io_uring connection reads a pipe with plain reads", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  IoUringLoop loop;
+  REQUIRE(loop.begin());
+
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+
+  bool closed = false;
+  IoUringConnection connection(loop, fds[0]);
+  connection.setCloseCallback([&](IoUringConnection&) { closed = true; });
+  REQUIRE(connection.begin());
+
+  std::string sent(2 * IoUringConnection::maxBufferSize + 100, 'p');
+  std::string received;
+  size_t written = 0;
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (received.size() < sent.size() && std::chrono::steady_clock::now() < deadline) {
+    if (written < sent.size()) {
+      ssize_t n = ::write(fds[1], sent.data() + written, std::min<size_t>(1000, sent.size() - written));
+      if (n > 0) {
+        written += n;
+      }
+    }
+    loop.runOnce(1);
+    std::vector<char> part = connection.read(1000);
+    received.append(part.begin(), part.end());
+  }
+  CHECK(received == sent);
+
+  close(fds[1]);
+  deadline = std::chrono::steady_clock::now() + 1s;
+  while (!closed && std::chrono::steady_clock::now() < deadline) {
+    loop.runOnce(1);
+  }
+  CHECK(closed);
+}
+
+TEST_CASE("io_uring loop writes from another thread and stops", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  IoUringLoop loop;
+  REQUIRE(loop.begin());
+
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  IoUringConnection connection(loop, fds[0]);
+  REQUIRE(connection.begin());
+
+  std::thread other([&] {
+    std::this_thread::sleep_for(10ms);
+    connection.write(std::string("from another thread"));
+    std::this_thread::sleep_for(10ms);
+    loop.stop();
+  });
+
+  loop.run();
+  other.join();
+
+  char buffer[64];
+  ssize_t n = ::read(fds[1], buffer, sizeof(buffer));
+  REQUIRE(n == 19);
+  CHECK(std::string(buffer, n) == "from another thread");
+
+  connection.end();
+  close(fds[1]);
+}
+
+TEST_CASE("io_uring connections end from another thread while the loop runs", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  IoUringLoop loop;
+  REQUIRE(loop.begin());
+  std::thread runner([&] { loop.run(); });
+
+  // Each connection is torn down with its read still in flight; end()
+  // hands the cancel to the loop thread and returns once the kernel is done
+  // with the connection's rings
+  for (int round = 0; round < 200; round++) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    auto connection = std::make_unique<IoUringConnection>(loop, fds[0]);
+    connection->setReadCallback([](IoUringConnection& c) { c.read(1024); });
+    REQUIRE(connection->begin());
+    connection->write(std::string("ping"));
+
+    if (round % 2 == 0) {
+      REQUIRE(::write(fds[1], "x", 1) == 1);
+    }
+
+    connection.reset();
+    close(fds[1]);
+  }
+
+  // The loop is still sound afterwards
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  IoUringConnection connection(loop, fds[0]);
+  connection.setReadCallback([](IoUringConnection& c) { c.write(c.read(1024)); });
+  REQUIRE(connection.begin());
+  REQUIRE(::write(fds[1], "echo", 4) == 4);
+
+  char buffer[16];
+  ssize_t n = ::read(fds[1], buffer, sizeof(buffer));
+  CHECK(std::string(buffer, n > 0 ? n : 0) == "echo");
+
+  connection.end();
+  close(fds[1]);
+  loop.stop();
+  runner.join();
+}
+
+TEST_CASE("io_uring loop keeps a stop that comes before run", "[uring]")
+{
+  if (!IoUringLoop::available()) {
+    return;
+  }
+
+  for (int round = 0; round < 100; round++) {
+    IoUringLoop loop;
+    REQUIRE(loop.begin());
+
+    std::thread t([&] { loop.run(); });
+    loop.stop();
+    t.join();
+  }
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("connection driver echo throughput", "[.][benchmark]")
+{
+  const int count = 64;
+  const int rounds = 100;
+
+  for (auto backend : {ConnectionDriver::Backend::epoll, ConnectionDriver::Backend::ioUring}) {
+    if (backend == ConnectionDriver::Backend::ioUring && !IoUringLoop::available()) {
+      continue;
+    }
+
+    ConnectionDriver driver(backend);
+    REQUIRE(driver.begin());
+
+    std::vector<int> peers;
+    for (int i = 0; i < count; i++) {
+      int fds[2];
+      REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+      peers.push_back(fds[1]);
+      driver.attach(fds[0], [](Connection& c) { c.write(c.read(1024)); });
+    }
+
+    std::string name = backend == ConnectionDriver::Backend::ioUring ? "io_uring" : "epoll";
+    BENCHMARK(name + ", 64 connections x 100 echoed 64 byte messages")
+    {
+      char message[64] = {};
+      char buffer[64];
+      size_t echoed = 0;
+
+      for (int round = 0; round < rounds; round++) {
+        for (int fd : peers) {
+          ::write(fd, message, sizeof(message));
+        }
+
+        for (int fd : peers) {
+          size_t got = 0;
+          while (got < sizeof(buffer)) {
+            driver.runOnce(0);
+            ssize_t n = recv(fd, buffer, sizeof(buffer) - got, MSG_DONTWAIT);
+            if (n > 0) {
+              got += n;
+            }
+          }
+          echoed += got;
+        }
+      }
+
+      return echoed;
+    };
+
+    driver.end();
+    for (int fd : peers) {
+      close(fd);
+    }
+  }
+}
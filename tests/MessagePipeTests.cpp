@@ -0,0 +1,56 @@
+#include <catch2/catch_all.hpp>
+
+#include <MessagePipe.h>
+
+TEST_CASE("message pipe hands over buffers without copying", "[pipe]")
+{
+  MessagePipe pipe;
+
+  std::vector<char> message(65536, 'm');
+  const char* storage = message.data();
+
+  REQUIRE(pipe.getEndA().send(std::move(message)));
+
+  std::vector<char> received;
+  REQUIRE(pipe.getEndB().receive(received));
+  CHECK(received.data() == storage);
+  CHECK(received.size() == 65536);
+
+  // Released buffers come back to the sender's pool
+  pipe.getEndB().release(std::move(received));
+  std::vector<char> reused = pipe.getEndA().allocate(100);
+  CHECK(reused.data() == storage);
+  CHECK(reused.empty());
+}
+
+TEST_CASE("message pipe send fails when the queue is full", "[pipe]")
+{
+  MessagePipe pipe;
+
+  for (int i = 0; i < MessageChannel::maxMessages - 1; i++) {
+    REQUIRE(pipe.getEndA().send(std::vector<char>(1, static_cast<char>(i))));
+  }
+
+  std::vector<char> extra = {'x', 'y'};
+  CHECK_FALSE(pipe.getEndA().send(std::move(extra)));
+  CHECK(extra.size() == 2);
+  CHECK(pipe.getEndB().messagesAvailable() == MessageChannel::maxMessages - 1);
+}
+
+TEST_CASE("message pipe still works as a byte Connection", "[pipe]")
+{
+  MessagePipe pipe;
+  Connection& a = pipe.getEndA();
+  Connection& b = pipe.getEndB();
+
+  a.write(std::string("hello"));
+  a.write(std::string(" world"));
+
+  CHECK(b.availableForReading());
+  CHECK(b.tryReadOne() == 'h');
+
+  std::vector<char> rest = b.read(100);
+  CHECK(std::string(rest.begin(), rest.end()) == "ello world");
+  CHECK_FALSE(b.availableForReading());
+  CHECK(b.tryReadOne() == -1);
+}
@@ -0,0 +1,51 @@
+#ifndef PSEUDO_TERMINAL_H
+#define PSEUDO_TERMINAL_H
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+// Opens a pseudo-terminal pair. The slave side stands in for the serial
+// device; the test drives the far end of the "cable" through the master.
+struct PseudoTerminal
+{
+  int master = -1;
+  std::string slave_path;
+
+  PseudoTerminal()
+  {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0) {
+      slave_path = ptsname(master);
+    }
+  }
+
+  ~PseudoTerminal()
+  {
+    if (master >= 0) {
+      close(master);
+    }
+  }
+
+  std::string readMaster(size_t size, int timeout_ms = 1000)
+  {
+    std::string result;
+    while (result.size() < size) {
+      struct pollfd pfd = {master, POLLIN, 0};
+      if (poll(&pfd, 1, timeout_ms) <= 0) {
+        break;
+      }
+      char buffer[256];
+      ssize_t n = ::read(master, buffer, sizeof(buffer));
+      if (n <= 0) {
+        break;
+      }
+      result.append(buffer, n);
+    }
+    return result;
+  }
+};
+
+#endif
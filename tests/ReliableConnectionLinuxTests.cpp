@@ -0,0 +1,265 @@
+#include <catch2/catch_all.hpp>
+
+#include <ReliableConnectionLinux.h>
+#include <UnixSocketConnection.h>
+
+#include "PseudoTerminal.h"
+
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+static std::vector<char> readFor(Connection& connection, size_t size)
+{
+  std::vector<char> results;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (results.size() < size && std::chrono::steady_clock::now() < deadline) {
+    std::vector<char> part = connection.read(static_cast<int>(size - results.size()));
+    results.insert(results.end(), part.begin(), part.end());
+    if (part.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return results;
+}
+
+TEST_CASE("linux serial backend round trips through a pty", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  ReliableConnectionLinux connection(pty.slave_path, 3000000);
+  connection.begin();
+  REQUIRE(connection.isOpen());
+
+  std::string inbound = "\x1b[31mred\x1b[0m";
+  REQUIRE(::write(pty.master, inbound.data(), inbound.size()) == static_cast<ssize_t>(inbound.size()));
+
+  std::vector<char> received = readFor(connection, inbound.size());
+  CHECK(std::string(received.begin(), received.end()) == inbound);
+
+  connection.write(std::string("hello"));
+  connection.flush();
+  CHECK(pty.readMaster(5) == "hello");
+
+  CHECK(connection.setBaudRate(1500000));
+
+  auto start = std::chrono::steady_clock::now();
+  connection.end();
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+  CHECK_FALSE(connection.isOpen());
+}
+
+TEST_CASE("linux serial backend queues writes without blocking the caller", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  ReliableConnectionLinux connection(pty.slave_path);
+  connection.begin();
+  REQUIRE(connection.isOpen());
+
+  // Far more than the pty and TX ring hold, so write() has to apply
+  // backpressure while the far end drains
+  std::string sent;
+  for (int i = 0; i < 20000; i++) {
+    sent += static_cast<char>('a' + i % 26);
+  }
+
+  std::string received;
+  std::thread far_end([&] {
+    received = pty.readMaster(sent.size());
+  });
+
+  for (size_t offset = 0; offset < sent.size(); offset += 1000) {
+    connection.write(std::vector<char>(sent.begin() + offset, sent.begin() + offset + 1000));
+  }
+  connection.flush();
+
+  far_end.join();
+  connection.end();
+
+  REQUIRE(received.size() == sent.size());
+  CHECK(received == sent);
+}
+
+TEST_CASE("linux serial backend releases writers when the port hangs up", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  ReliableConnectionLinux connection(pty.slave_path);
+  connection.begin();
+  REQUIRE(connection.isOpen());
+
+  // Nobody reads the far end, so the writes back up into the TX ring
+  // before the cable is pulled
+  std::string sent(1 << 20, 'x');
+  auto writer = std::async(std::launch::async, [&] {
+    connection.write(std::vector<char>(sent.begin(), sent.end()));
+    connection.flush();
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  close(pty.master);
+  pty.master = -1;
+
+  REQUIRE(writer.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+  CHECK_FALSE(connection.isOpen());
+
+  // Once stopped, neither call waits on the I/O thread
+  connection.write(std::string("late"));
+  connection.flush();
+
+  connection.end();
+}
+
+TEST_CASE("linux serial backend starts on a port handed over a unix socket", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  std::unique_ptr<UnixSocketConnection> supervisor;
+  std::unique_ptr<UnixSocketConnection> worker;
+  REQUIRE(UnixSocketConnection::createPair(supervisor, worker));
+
+  // The supervisor opens and configures the port once
+  int port = ReliableConnectionLinux::openSerialPort(pty.slave_path, 115200);
+  REQUIRE(port >= 0);
+  REQUIRE(supervisor->sendDescriptor(port));
+  close(port);
+
+  ReliableConnectionLinux connection(pty.slave_path);
+  int received = worker->receiveDescriptor(1000);
+  REQUIRE(received >= 0);
+  connection.begin(received);
+  REQUIRE(connection.isOpen());
+
+  REQUIRE(::write(pty.master, "ping", 4) == 4);
+  std::vector<char> inbound = readFor(connection, 4);
+  CHECK(std::string(inbound.begin(), inbound.end()) == "ping");
+
+  connection.write(std::string("pong"));
+  connection.flush();
+  CHECK(pty.readMaster(4) == "pong");
+
+  connection.end();
+}
+
+TEST_CASE("linux serial backend round trips with realtime options", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  // No SCHED_FIFO here: a spinning FIFO thread would starve the test on a
+  // single core machine. A pty has no ASYNC_LOW_LATENCY, which is reported
+  // and skipped.
+  RealtimeOptions options;
+  options.cpu = 0;
+  options.low_latency = true;
+  options.busy_poll = true;
+
+  ReliableConnectionLinux connection(pty.slave_path);
+  connection.setRealtime(options);
+  connection.begin();
+  REQUIRE(connection.isOpen());
+
+  REQUIRE(::write(pty.master, "ping", 4) == 4);
+  std::vector<char> inbound = readFor(connection, 4);
+  CHECK(std::string(inbound.begin(), inbound.end()) == "ping");
+
+  connection.write(std::string("pong"));
+  connection.flush();
+  CHECK(pty.readMaster(4) == "pong");
+
+  auto start = std::chrono::steady_clock::now();
+  connection.end();
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+}
+
+TEST_CASE("linux serial backend applies framing and flow control", "[linux][serial]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  SerialConfig config(3000000);
+  config.data_bits = 7;
+  config.parity = SerialConfig::Parity::odd;
+  config.stop_bits = 2;
+  config.hardware_flow_control = true;
+
+  int fd = ReliableConnectionLinux::openSerialPort(pty.slave_path, config);
+  REQUIRE(fd >= 0);
+
+  // The pty driver forces CS8 without parity, so only the stop bits and
+  // RTS/CTS can be read back here
+  struct termios tty;
+  REQUIRE(tcgetattr(fd, &tty) == 0);
+  CHECK((tty.c_cflag & CSTOPB) != 0);
+  CHECK((tty.c_cflag & CRTSCTS) != 0);
+  close(fd);
+
+  ReliableConnectionLinux connection(pty.slave_path, config);
+  connection.begin();
+  REQUIRE(connection.isOpen());
+
+  // Back to 8N1 without flow control while open
+  CHECK(connection.setConfig(SerialConfig(1500000)));
+
+  fd = open(pty.slave_path.c_str(), O_RDWR | O_NOCTTY);
+  REQUIRE(fd >= 0);
+  REQUIRE(tcgetattr(fd, &tty) == 0);
+  CHECK((tty.c_cflag & (CSTOPB | CRTSCTS)) == 0);
+  close(fd);
+
+  SerialConfig invalid;
+  invalid.data_bits = 9;
+  CHECK_FALSE(connection.setConfig(invalid));
+  CHECK(ReliableConnectionLinux::openSerialPort(pty.slave_path, invalid) < 0);
+
+  connection.end();
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("linux serial backend RX latency", "[.][benchmark]")
+{
+  for (bool busy_poll : {false, true}) {
+    // The poller and this thread both spin, so they need a core each
+    if (busy_poll && std::thread::hardware_concurrency() < 2) {
+      WARN("busy poll: skipped, needs a second CPU");
+      continue;
+    }
+
+    PseudoTerminal pty;
+    REQUIRE(!pty.slave_path.empty());
+
+    RealtimeOptions options;
+    options.busy_poll = busy_poll;
+
+    ReliableConnectionLinux connection(pty.slave_path);
+    connection.setRealtime(options);
+    connection.begin();
+    REQUIRE(connection.isOpen());
+
+    std::vector<double> samples;
+    for (int i = 0; i < 2000; i++) {
+      auto sent = std::chrono::steady_clock::now();
+      REQUIRE(::write(pty.master, "x", 1) == 1);
+      while (!connection.availableForReading()) {
+      }
+      auto arrived = std::chrono::steady_clock::now();
+      connection.read(1);
+      samples.push_back(std::chrono::duration<double, std::micro>(arrived - sent).count());
+    }
+    connection.end();
+
+    std::sort(samples.begin(), samples.end());
+    WARN((busy_poll ? "busy poll" : "epoll") << ": p50 " << samples[samples.size() / 2] << " us, p99 "
+         << samples[samples.size() * 99 / 100] << " us");
+  }
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_all.hpp>
+
+#include <EventLoop.h>
+#include <ReliableConnectionLinux.h>
+#include <SerialShare.h>
+#include <UnixSocketConnection.h>
+
+#include "PseudoTerminal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static std::string receiveFor(UnixSocketConnection& client, size_t size)
+{
+  std::string result;
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (result.size() < size && std::chrono::steady_clock::now() < deadline) {
+    std::vector<char> part = client.receiveMessage(10);
+    result.append(part.begin(), part.end());
+  }
+  return result;
+}
+
+static bool waitFor(const std::function<bool()>& condition)
+{
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+TEST_CASE("serial share fans RX out and merges client TX", "[linux][share]")
+{
+  PseudoTerminal pty;
+  REQUIRE(!pty.slave_path.empty());
+
+  std::string path = "/tmp/transmission-share-" + std::to_string(getpid()) + ".sock";
+
+  EventLoop loop;
+  REQUIRE(loop.begin());
+
+  int port = ReliableConnectionLinux::openSerialPort(pty.slave_path, 115200);
+  REQUIRE(port >= 0);
+
+  SerialShare share(loop, port, path);
+  REQUIRE(share.begin());
+
+  std::thread loop_thread([&] { loop.run(); });
+
+  UnixSocketConnection monitor(path);
+  UnixSocketConnection app(path);
+  REQUIRE(monitor.connectToPath());
+  REQUIRE(app.connectToPath());
+  REQUIRE(waitFor([&] { return share.clientCount() == 2; }));
+
+  // Every client sees what the device sends
+  REQUIRE(::write(pty.master, "status", 6) == 6);
+  CHECK(receiveFor(monitor, 6) == "status");
+  CHECK(receiveFor(app, 6) == "status");
+
+  // Both clients can talk to the device
+  monitor.write(std::string("MMMM"));
+  app.write(std::string("AAAA"));
+  std::string sent = pty.readMaster(8);
+  std::sort(sent.begin(), sent.end());
+  CHECK(sent == "AAAAMMMM");
+
+  monitor.disconnect();
+  CHECK(waitFor([&] { return share.clientCount() == 1; }));
+
+  REQUIRE(::write(pty.master, "more", 4) == 4);
+  CHECK(receiveFor(app, 4) == "more");
+  CHECK(share.droppedBytes() == 0);
+
+  loop.stop();
+  loop_thread.join();
+  share.end();
+  CHECK(access(path.c_str(), F_OK) != 0);
+}
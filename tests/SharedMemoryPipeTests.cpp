@@ -0,0 +1,161 @@
+#include <catch2/catch_all.hpp>
+
+#include <SharedMemoryPipe.h>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+
+static std::string segmentName(const char* tag)
+{
+  return std::string("/transmission-test-") + tag + "-" + std::to_string(getpid());
+}
+
+TEST_CASE("shared memory pipe echoes across processes", "[shm]")
+{
+  std::string name = segmentName("echo");
+
+  SharedMemoryPipe pipe(name);
+  REQUIRE(pipe.create());
+
+  pid_t child = fork();
+  REQUIRE(child >= 0);
+
+  if (child == 0) {
+    SharedMemoryPipe peer(name);
+    if (!peer.open()) {
+      _exit(1);
+    }
+
+    SharedMemoryPipeEnd& end = peer.getEndB();
+    while (true) {
+      std::vector<char> bs = end.read(1000);
+      if (bs.empty()) {
+        break;
+      }
+      end.write(bs);
+    }
+    _exit(0);
+  }
+
+  SharedMemoryPipeEnd& end = pipe.getEndA();
+
+  std::vector<char> sent(100000);
+  for (size_t i = 0; i < sent.size(); i++) {
+    sent[i] = static_cast<char>(i * 13);
+  }
+
+  std::vector<char> received;
+  std::thread reader([&] {
+    received = end.read(static_cast<int>(sent.size()));
+  });
+
+  end.write(sent);
+  reader.join();
+  end.close();
+
+  int status = 0;
+  waitpid(child, &status, 0);
+
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == 0);
+  REQUIRE(received.size() == sent.size());
+  CHECK(received == sent);
+}
+
+TEST_CASE("shared memory pipe read times out", "[shm]")
+{
+  SharedMemoryPipe pipe(segmentName("timeout"));
+  REQUIRE(pipe.create());
+
+  char c;
+  CHECK(pipe.getEndB().read(&c, 1, std::chrono::milliseconds(10)) == 0);
+  CHECK(pipe.getEndB().tryReadOne() == -1);
+
+  pipe.getEndA().write(std::string("x"));
+  CHECK(pipe.getEndB().tryReadOne() == 'x');
+}
+
+TEST_CASE("shared memory pipe close wakes a reader parked on the other end", "[shm]")
+{
+  // Half the rounds close before the reader has parked, half after
+  for (int round = 0; round < 50; round++) {
+    SharedMemoryPipe pipe(segmentName("close"));
+    REQUIRE(pipe.create());
+
+    std::vector<char> got{'x'};
+    std::thread reader([&] {
+      got = pipe.getEndB().read(1);
+    });
+
+    if (round % 2 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pipe.getEndA().close();
+    reader.join();
+
+    CHECK(got.empty());
+    CHECK(pipe.getEndB().isClosed());
+  }
+}
+
+TEST_CASE("shared memory pipe vs unix socket throughput", "[.][benchmark][shm]")
+{
+  const size_t total = 16 << 20;
+  std::vector<char> chunk(4096, 'b');
+
+  SharedMemoryPipe pipe(segmentName("bench"));
+  REQUIRE(pipe.create());
+
+  BENCHMARK("shared memory pipe, 16 MiB in 4 KiB chunks")
+  {
+    std::thread consumer([&] {
+      std::vector<char> buffer(4096);
+      size_t received = 0;
+      while (received < total) {
+        received += pipe.getEndB().read(buffer.data(), buffer.size(), SharedMemoryPipeEnd::forever);
+      }
+    });
+
+    for (size_t sent = 0; sent < total; sent += chunk.size()) {
+      pipe.getEndA().write(chunk.data(), chunk.size(), SharedMemoryPipeEnd::forever);
+    }
+
+    consumer.join();
+    return total;
+  };
+
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  BENCHMARK("unix socket, 16 MiB in 4 KiB chunks")
+  {
+    std::thread consumer([&] {
+      std::vector<char> buffer(4096);
+      size_t received = 0;
+      while (received < total) {
+        ssize_t n = ::read(fds[1], buffer.data(), buffer.size());
+        if (n <= 0) {
+          break;
+        }
+        received += n;
+      }
+    });
+
+    for (size_t sent = 0; sent < total;) {
+      ssize_t n = ::write(fds[0], chunk.data(), chunk.size());
+      if (n <= 0) {
+        break;
+      }
+      sent += n;
+    }
+
+    consumer.join();
+    return total;
+  };
+
+  close(fds[0]);
+  close(fds[1]);
+}
@@ -0,0 +1,245 @@
+#ifndef SIMULATED_UART_H
+#define SIMULATED_UART_H
+
+#include <SerialConfig.h>
+
+#include <stddef.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <string>
+
+// Host stand-in for a board's UART, usable as a UartConnection or
+// UartReceiver policy. Bytes put on the line with receive() land in the RX
+// FIFO; like hardware set up with an RX FIFO threshold and idle timeout,
+// it raises its interrupt once `threshold` bytes have arrived since the
+// last one, or when the line has been quiet for `idle_timeout` character
+// times with bytes still unsignalled. Everything written goes to tx.
+//
+// Each PORT is an independent UART. With INTERRUPTS false no interrupt is
+// raised, as with a core's HardwareSerial that the connection polls.
+template<int PORT = 0, bool INTERRUPTS = true>
+struct SimulatedUart
+{
+  static const bool interruptDriven = INTERRUPTS;
+
+  static inline std::deque<char> rx;
+  static inline std::string tx;
+  static inline size_t threshold = 1;
+  static inline size_t idle_timeout = 1;
+  static inline std::function<void()> on_event;
+  static inline SerialConfig config;
+
+  // What the code under test did to the UART
+  static inline size_t events = 0;
+  static inline size_t getc_calls = 0;
+  static inline size_t read_calls = 0;
+
+  static void reset(size_t rx_threshold = 1, size_t rx_idle_timeout = 1)
+  {
+    rx.clear();
+    tx.clear();
+    threshold = rx_threshold;
+    idle_timeout = rx_idle_timeout;
+    on_event = nullptr;
+    config = SerialConfig();
+    events = 0;
+    getc_calls = 0;
+    read_calls = 0;
+    unsignalled = 0;
+    in_interrupt = false;
+    pending = false;
+  }
+
+  // Policy interface
+  static void begin(const SerialConfig& serial_config, void (*isr)())
+  {
+    config = serial_config;
+    if (INTERRUPTS) {
+      on_event = isr;
+    }
+  }
+
+  static bool readable()
+  {
+    return !rx.empty();
+  }
+
+  static char getc()
+  {
+    getc_calls++;
+    char c = rx.front();
+    rx.pop_front();
+    return c;
+  }
+
+  static void putc(char c)
+  {
+    tx += c;
+  }
+
+  static void write(const char* data, size_t size)
+  {
+    tx.append(data, size);
+  }
+
+  // Line side
+  static void receive(const char* data, size_t length)
+  {
+    for (size_t i = 0; i < length; i++) {
+      rx.push_back(data[i]);
+      if (++unsignalled >= threshold) {
+        raise();
+      }
+    }
+  }
+
+  static void receive(const std::string& data)
+  {
+    receive(data.data(), data.size());
+  }
+
+  static void idleFor(size_t character_times)
+  {
+    if (unsignalled > 0 && character_times >= idle_timeout) {
+      raise();
+    }
+  }
+
+protected:
+  static inline size_t unsignalled = 0;
+  static inline bool in_interrupt = false;
+  static inline bool pending = false;
+
+  static void raise()
+  {
+    unsignalled = 0;
+    interrupt();
+  }
+
+  // One IRQ line for RX and TX. A handler is never re-entered; what is
+  // raised while it runs stays latched and runs it again on return.
+  static void interrupt()
+  {
+    if (in_interrupt) {
+      pending = true;
+      return;
+    }
+
+    do {
+      pending = false;
+      events++;
+      if (on_event) {
+        in_interrupt = true;
+        on_event();
+        in_interrupt = false;
+      }
+    } while (pending);
+  }
+};
+
+// The same, plus the bulk buffered()/read() pair of a driver that buffers
+// in software, like ESP-IDF's
+template<int PORT = 0>
+struct SimulatedBufferedUart : SimulatedUart<PORT>
+{
+  using Base = SimulatedUart<PORT>;
+
+  static size_t buffered()
+  {
+    return Base::rx.size();
+  }
+
+  static size_t read(char* data, size_t size)
+  {
+    Base::read_calls++;
+    size_t n = std::min(size, Base::rx.size());
+    std::copy(Base::rx.begin(), Base::rx.begin() + n, data);
+    Base::rx.erase(Base::rx.begin(), Base::rx.begin() + n);
+    return n;
+  }
+};
+
+// The same, plus a TX FIFO and its interrupt, for a transmit ring. Written
+// bytes wait in fifo until the line shifts them out into tx with
+// transmit(). Like the PL011's, the TX interrupt fires as the FIFO drains
+// down to tx_level, not merely because it is enabled over a low FIFO.
+//
+// Time also passes while putc() waits on a full FIFO: each wait shifts one
+// character out and counts a stall.
+template<int PORT = 0>
+struct SimulatedTxUart : SimulatedUart<PORT>
+{
+  using Base = SimulatedUart<PORT>;
+
+  static inline std::deque<char> fifo;
+  static inline size_t fifo_depth = 32;
+  static inline size_t tx_level = 4;
+  static inline bool tx_interrupt = false;
+
+  static inline size_t tx_events = 0;
+  static inline size_t stalls = 0;
+
+  static void reset(size_t rx_threshold = 1, size_t rx_idle_timeout = 1,
+                    size_t depth = 32, size_t level = 4)
+  {
+    Base::reset(rx_threshold, rx_idle_timeout);
+    fifo.clear();
+    fifo_depth = depth;
+    tx_level = level;
+    tx_interrupt = false;
+    tx_events = 0;
+    stalls = 0;
+  }
+
+  // Policy interface
+  static bool writable()
+  {
+    return fifo.size() < fifo_depth;
+  }
+
+  static void setTxInterrupt(bool enable)
+  {
+    tx_interrupt = enable;
+  }
+
+  static void putc(char c)
+  {
+    // The interrupt may refill the FIFO while we wait, as on hardware
+    while (fifo.size() >= fifo_depth) {
+      stalls++;
+      transmit(1);
+    }
+    fifo.push_back(c);
+  }
+
+  static void write(const char* data, size_t size)
+  {
+    for (size_t i = 0; i < size; i++) {
+      putc(data[i]);
+    }
+  }
+
+  // Line side
+  static void transmit(size_t characters)
+  {
+    for (size_t i = 0; i < characters && !fifo.empty(); i++) {
+      Base::tx += fifo.front();
+      fifo.pop_front();
+      if (fifo.size() == tx_level && tx_interrupt) {
+        tx_events++;
+        Base::interrupt();
+      }
+    }
+  }
+
+  // Until the FIFO stays empty, with the interrupt refilling it
+  static void transmitAll()
+  {
+    while (!fifo.empty()) {
+      transmit(1);
+    }
+  }
+};
+
+#endif
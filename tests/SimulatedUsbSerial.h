@@ -0,0 +1,114 @@
+#ifndef SIMULATED_USB_SERIAL_H
+#define SIMULATED_USB_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Host stand-in for a board's USB serial. Bytes put on the bus with
+// receive() wait in the stack, up to `capacity`; what does not fit waits
+// host-side, as a NAKed packet would, until the stack has room. Bytes
+// queued with arriveOnIdle() land the next time the connection idles.
+// Every write is recorded with its size.
+struct SimulatedUsbSerial
+{
+  static const bool interruptDriven = false;
+  static const bool backpressure = true;
+
+  static inline std::deque<char> stack;
+  static inline std::deque<char> host;
+  static inline std::string later;
+  static inline size_t capacity = 512;
+  static inline std::string tx;
+  static inline std::vector<size_t> writes;
+  static inline size_t flushes = 0;
+  static inline size_t read_calls = 0;
+  static inline size_t idles = 0;
+  static inline uint32_t now = 0;
+
+  static void reset()
+  {
+    stack.clear();
+    host.clear();
+    later.clear();
+    capacity = 512;
+    tx.clear();
+    writes.clear();
+    flushes = 0;
+    read_calls = 0;
+    idles = 0;
+    now = 0;
+  }
+
+  static void receive(const std::string& data)
+  {
+    host.insert(host.end(), data.begin(), data.end());
+    deliver();
+  }
+
+  static void arriveOnIdle(const std::string& data)
+  {
+    later += data;
+  }
+
+  // Policy interface
+  static size_t buffered()
+  {
+    return stack.size();
+  }
+
+  static size_t read(char* data, size_t size)
+  {
+    read_calls++;
+    size_t n = std::min(size, stack.size());
+    std::copy(stack.begin(), stack.begin() + n, data);
+    stack.erase(stack.begin(), stack.begin() + n);
+    deliver();
+    return n;
+  }
+
+  static void putc(char c)
+  {
+    tx += c;
+    writes.push_back(1);
+  }
+
+  static size_t write(const char* data, size_t size)
+  {
+    tx.append(data, size);
+    writes.push_back(size);
+    return size;
+  }
+
+  static void flush()
+  {
+    flushes++;
+  }
+
+  static uint32_t micros()
+  {
+    return now;
+  }
+
+  static void idle()
+  {
+    idles++;
+    now += 100;
+    receive(later);
+    later.clear();
+  }
+
+private:
+  static void deliver()
+  {
+    while (!host.empty() && stack.size() < capacity) {
+      stack.push_back(host.front());
+      host.pop_front();
+    }
+  }
+};
+
+#endif // SIMULATED_USB_SERIAL_H
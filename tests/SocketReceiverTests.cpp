@@ -0,0 +1,166 @@
+#include <catch2/catch_all.hpp>
+
+#include <socket_receiver.h>
+#include <PosixSocket.h>
+#include <TcpConnection.h>
+#include <TcpListener.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts the calls the receiver makes into the socket
+class CountingSocket : public PosixSocket
+{
+  public:
+    using PosixSocket::PosixSocket;
+
+    size_t reads = 0;
+
+    int read(uint8_t* data, size_t size)
+    {
+      reads++;
+      return PosixSocket::read(data, size);
+    }
+};
+
+static std::vector<char> pattern(size_t length)
+{
+  std::vector<char> data(length);
+  for (size_t i = 0; i < length; i++) {
+    data[i] = static_cast<char>(i * 11);
+  }
+  return data;
+}
+
+TEST_CASE("socket receiver reads a host TCP socket in bulk", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  CountingSocket socket(client.fd());
+  SocketReceiver<CountingSocket, 4096> receiver(socket);
+
+  std::vector<char> sent = pattern(256 * 1024);
+  std::thread writer([&] { server->write(sent); });
+
+  std::vector<char> received(sent.size());
+  size_t n = receiver.read(received.data(), received.size(), 5000);
+  writer.join();
+
+  CHECK(n == sent.size());
+  CHECK(received == sent);
+  // A span per wakeup, not a call per byte
+  CHECK(socket.reads < sent.size() / 64);
+}
+
+TEST_CASE("socket receiver fills its ring in spans and leaves the rest", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  CountingSocket socket(client.fd());
+  SocketReceiver<CountingSocket, 1024> receiver(socket);
+
+  std::vector<char> sent = pattern(3000);
+  server->write(sent);
+  while (socket.available() < 3000) {
+    socket.wait(100);
+  }
+
+  CHECK(receiver.fill() == 1023);
+  CHECK(socket.reads <= 2);
+  CHECK(receiver.count() == 1023);
+  CHECK(receiver.available());
+
+  // The ring first, then the socket straight into the caller's buffer
+  std::vector<char> received(3000);
+  CHECK(receiver.read(received.data(), received.size()) == 3000);
+  CHECK(received == sent);
+  CHECK(receiver.tryReadOne() == -1);
+  CHECK_FALSE(receiver.available());
+}
+
+TEST_CASE("socket receiver gives up at its deadline or when the peer closes", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  PosixSocket socket(client.fd());
+  SocketReceiver<PosixSocket, 256> receiver(socket);
+
+  server->write(std::string("\xffpartial", 8));
+  CHECK(receiver.tryReadOne() == 0xff);
+
+  char buffer[100];
+  auto start = std::chrono::steady_clock::now();
+  size_t n = receiver.read(buffer, sizeof(buffer), 50);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(std::string(buffer, n) == "partial");
+  CHECK(elapsed >= std::chrono::milliseconds(45));
+  CHECK(elapsed < std::chrono::milliseconds(1000));
+
+  // Waiting forever still ends with the stream
+  std::thread closer([&] {
+    server->write(std::string("tail"));
+    server->disconnect();
+  });
+  n = receiver.read(buffer, sizeof(buffer), SocketReceiver<PosixSocket, 256>::forever);
+  closer.join();
+  CHECK(std::string(buffer, n) == "tail");
+  CHECK_FALSE(socket.connected());
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("socket receiver throughput", "[.][benchmark]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  PosixSocket socket(client.fd());
+  SocketReceiver<PosixSocket, 8192> receiver(socket);
+  std::vector<char> sent = pattern(1 << 20);
+  std::vector<char> received(sent.size());
+
+  BENCHMARK("1 MiB over loopback in spans")
+  {
+    std::thread writer([&] { server->write(sent); });
+    size_t n = receiver.read(received.data(), received.size(), 5000);
+    writer.join();
+    return n;
+  };
+
+  BENCHMARK("1 MiB over loopback a byte at a time")
+  {
+    std::thread writer([&] { server->write(sent); });
+    size_t n = 0;
+    while (n < sent.size()) {
+      int c = receiver.tryReadOne();
+      if (c < 0) {
+        socket.wait(10);
+        continue;
+      }
+      received[n++] = static_cast<char>(c);
+    }
+    writer.join();
+    return n;
+  };
+}
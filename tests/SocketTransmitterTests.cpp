@@ -0,0 +1,199 @@
+#include <catch2/catch_all.hpp>
+
+#include <socket_transmitter.h>
+#include <PosixSocket.h>
+#include <TcpConnection.h>
+#include <TcpListener.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A host TCP socket that, like lwIP with its buffers momentarily full,
+// takes at most `limit` bytes per write and none at all while `blocked`
+class ShortWriteSocket : public PosixSocket
+{
+  public:
+    using PosixSocket::PosixSocket;
+
+    size_t limit = 1000;
+    bool blocked = false;
+    size_t writes = 0;
+
+    size_t write(const uint8_t* data, size_t size)
+    {
+      if (blocked) {
+        return 0;
+      }
+      writes++;
+      return PosixSocket::write(data, size < limit ? size : limit);
+    }
+
+    void waitWritable(uint32_t timeout_ms)
+    {
+      if (blocked) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms < 5 ? timeout_ms : 5));
+        return;
+      }
+      PosixSocket::waitWritable(timeout_ms);
+    }
+};
+
+static std::vector<char> pattern(size_t length)
+{
+  std::vector<char> data(length);
+  for (size_t i = 0; i < length; i++) {
+    data[i] = static_cast<char>(i * 17);
+  }
+  return data;
+}
+
+TEST_CASE("socket transmitter keeps what a short write left behind", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  ShortWriteSocket socket(client.fd());
+  socket.limit = 333;
+  SocketTransmitter<ShortWriteSocket, 4096> transmitter(socket);
+
+  std::vector<char> sent = pattern(200 * 1024);
+  std::vector<char> received;
+  std::thread reader([&] { received = server->read(static_cast<int>(sent.size())); });
+
+  size_t queued = 0;
+  while (queued < sent.size()) {
+    queued += transmitter.write(sent.data() + queued, sent.size() - queued);
+    if (queued < sent.size()) {
+      REQUIRE(transmitter.waitForRoom(sent.size() - queued, 5000));
+    }
+  }
+  CHECK(transmitter.flush(5000));
+  reader.join();
+
+  CHECK(transmitter.pending() == 0);
+  CHECK(received == sent);
+}
+
+TEST_CASE("socket transmitter reports backpressure and retries on poll", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  ShortWriteSocket socket(client.fd());
+  socket.limit = 4096;
+  SocketTransmitter<ShortWriteSocket, 1024> transmitter(socket);
+
+  std::vector<char> sent = pattern(1500);
+  socket.blocked = true;
+  CHECK(transmitter.write(sent.data(), sent.size()) == 1023);
+  CHECK(transmitter.availableForWrite() == 0);
+  CHECK(transmitter.pending() == 1023);
+  CHECK_FALSE(transmitter.flush(20));
+  CHECK_FALSE(transmitter.waitForRoom(1, 20));
+
+  // Nothing was lost while the stack was full
+  socket.blocked = false;
+  CHECK(transmitter.poll() == 1023);
+  CHECK(transmitter.write(sent.data() + 1023, sent.size() - 1023) == 477);
+  CHECK(transmitter.pending() == 0);
+
+  std::vector<char> received = server->read(static_cast<int>(sent.size()));
+  CHECK(received == sent);
+
+  // Closing with bytes queued is reported, not waited on forever
+  socket.blocked = true;
+  transmitter.write(sent.data(), 10);
+  server->disconnect();
+  CHECK_FALSE(transmitter.flush());
+}
+
+TEST_CASE("socket transmitter backs up on a real socket without blocking", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  // No stand-in: the kernel's own short writes, as lwip_send() with
+  // MSG_DONTWAIT gives on the ESP32, while nobody reads the far end
+  PosixSocket socket(client.fd());
+  SocketTransmitter<PosixSocket, 4096> transmitter(socket);
+
+  std::vector<char> sent = pattern(8 * 1024 * 1024);
+  size_t queued = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (queued < sent.size()) {
+    size_t n = transmitter.write(sent.data() + queued, sent.size() - queued);
+    queued += n;
+    if (n == 0) {
+      break;
+    }
+  }
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+  REQUIRE(queued < sent.size());
+  CHECK(transmitter.availableForWrite() == 0);
+
+  std::vector<char> received;
+  std::thread reader([&] { received = server->read(static_cast<int>(sent.size())); });
+
+  while (queued < sent.size()) {
+    queued += transmitter.write(sent.data() + queued, sent.size() - queued);
+    if (queued < sent.size()) {
+      REQUIRE(transmitter.waitForRoom(sent.size() - queued, 5000));
+    }
+  }
+  CHECK(transmitter.flush(5000));
+  reader.join();
+
+  CHECK(received == sent);
+}
+
+TEST_CASE("socket transmitter coalesces small writes", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  ShortWriteSocket socket(client.fd());
+  SocketTransmitter<ShortWriteSocket, 4096> transmitter(socket);
+  std::string message(16, 'm');
+
+  // Uncoalesced, each message is its own write
+  for (int i = 0; i < 100; i++) {
+    transmitter.write(message.data(), message.size());
+  }
+  CHECK(socket.writes == 100);
+
+  socket.writes = 0;
+  transmitter.setCoalescing(512, 20);
+  for (int i = 0; i < 100; i++) {
+    transmitter.write(message.data(), message.size());
+  }
+  // 1600 bytes in three 512 byte batches, the tail held back
+  CHECK(socket.writes == 3);
+  CHECK(transmitter.pending() == 1600 - 3 * 512);
+
+  CHECK(transmitter.poll() == 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  CHECK(transmitter.poll() == 1600 - 3 * 512);
+  CHECK(socket.writes == 4);
+
+  std::vector<char> received = server->read(3200);
+  CHECK(received.size() == 3200);
+}
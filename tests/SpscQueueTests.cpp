@@ -0,0 +1,111 @@
+#include <catch2/catch_all.hpp>
+
+#include <spsc_queue.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A record with no default constructor that counts its live copies
+struct Record
+{
+  static inline int live = 0;
+
+  uint32_t timestamp;
+  std::string text;
+
+  Record(uint32_t timestamp, std::string text) : timestamp(timestamp), text(std::move(text))
+  {
+    live++;
+  }
+
+  Record(Record&& other) noexcept : timestamp(other.timestamp), text(std::move(other.text))
+  {
+    live++;
+  }
+
+  Record& operator=(Record&& other) noexcept
+  {
+    timestamp = other.timestamp;
+    text = std::move(other.text);
+    return *this;
+  }
+
+  ~Record()
+  {
+    live--;
+  }
+};
+
+TEST_CASE("spsc queue builds records in place and drains them in batches", "[spsc]")
+{
+  Record::live = 0;
+  {
+    SpscQueue<Record, 8> queue;
+    for (uint32_t i = 0; i < 7; i++) {
+      CHECK(queue.emplace(i, "record " + std::to_string(i)));
+    }
+    CHECK(queue.full());
+    CHECK_FALSE(queue.emplace(7u, "no room"));
+    CHECK(Record::live == 7);
+
+    std::vector<std::string> seen;
+    CHECK(queue.drain([&](Record& record) { seen.push_back(record.text); }, 3) == 3);
+    std::vector<std::string> first{"record 0", "record 1", "record 2"};
+    CHECK(seen == first);
+    CHECK(queue.count() == 4);
+    CHECK(Record::live == 4);
+
+    // Slots freed by the batch are reused across the wrap
+    CHECK(queue.emplace(7u, "record 7"));
+    CHECK(queue.push(Record(8, "record 8")));
+
+    seen.clear();
+    CHECK(queue.drain([&](Record& record) { seen.push_back(record.text); }) == 6);
+    CHECK(seen.front() == "record 3");
+    CHECK(seen.back() == "record 8");
+    CHECK(queue.empty());
+    CHECK(queue.drain([](Record&) {}) == 0);
+
+    CHECK(queue.emplace(9u, "left behind"));
+  }
+
+  // The destructor releases what was never drained
+  CHECK(Record::live == 0);
+}
+
+TEST_CASE("spsc queue hands records across threads in order", "[spsc]")
+{
+  struct Frame
+  {
+    uint32_t sequence;
+    uint32_t length;
+
+    Frame(uint32_t sequence, uint32_t length) : sequence(sequence), length(length) {}
+  };
+
+  static const uint32_t total = 200000;
+  auto queue = std::make_unique<SpscQueue<Frame, 64>>();
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < total; i++) {
+      while (!queue->emplace(i, i * 3)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  bool ordered = true;
+  while (expected < total) {
+    queue->drain([&](Frame& frame) {
+      ordered = ordered && frame.sequence == expected && frame.length == expected * 3;
+      expected++;
+    });
+  }
+  producer.join();
+
+  CHECK(ordered);
+  CHECK(queue->empty());
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_all.hpp>
+
+#include <TcpConnection.h>
+#include <TcpListener.h>
+
+#include <sys/socket.h>
+#include <memory>
+#include <thread>
+
+TEST_CASE("tcp connection round trips over loopback", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  REQUIRE(listener.port() != 0);
+
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.connectToHost(1000));
+  CHECK(client.isConnected());
+
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+  CHECK(server->isConnected());
+
+  client.write(std::string("hello"));
+  std::vector<char> received = server->read(5);
+  CHECK(std::string(received.begin(), received.end()) == "hello");
+
+  server->write(std::string("world"));
+  CHECK(client.readOne() == 'w');
+  received = client.read(4);
+  CHECK(std::string(received.begin(), received.end()) == "orld");
+
+  CHECK(client.tryReadOne() == -1);
+  CHECK_FALSE(client.availableForReading());
+}
+
+TEST_CASE("tcp connection moves more than its ring in bulk", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.setReceiveBufferSize(256 * 1024));
+  REQUIRE(client.connectToHost(1000));
+
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  std::vector<char> sent(3 * TcpConnection::maxBufferSize + 123);
+  for (size_t i = 0; i < sent.size(); i++) {
+    sent[i] = static_cast<char>(i * 7);
+  }
+
+  // The writer blocks once both socket buffers fill, so run it alongside
+  bool corked = false;
+  bool uncorked = false;
+  std::thread writer([&] {
+    corked = server->setCork(true);
+    server->write(sent);
+    uncorked = server->setCork(false);
+  });
+
+  std::vector<char> received = client.read(static_cast<int>(sent.size()));
+  writer.join();
+
+  CHECK(corked);
+  CHECK(uncorked);
+  REQUIRE(received.size() == sent.size());
+  CHECK(received == sent);
+}
+
+TEST_CASE("tcp connection sees the peer hang up", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+
+  TcpConnection client("127.0.0.1", listener.port());
+  REQUIRE(client.setNoDelay(true));
+  REQUIRE(client.connectToHost(1000));
+
+  std::unique_ptr<TcpConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  server->write(std::string("last"));
+  server.reset();
+
+  // Buffered bytes are still delivered, then the read comes up short
+  std::vector<char> received = client.read(10);
+  CHECK(std::string(received.begin(), received.end()) == "last");
+  CHECK_FALSE(client.isConnected());
+}
+
+TEST_CASE("tcp listener accept polls and connect fails cleanly", "[tcp]")
+{
+  TcpListener listener(0, "127.0.0.1");
+  REQUIRE(listener.begin());
+  CHECK(listener.accept(0) == nullptr);
+  CHECK(listener.accept(10) == nullptr);
+
+  uint16_t closed_port = listener.port();
+  listener.end();
+
+  TcpConnection client("127.0.0.1", closed_port);
+  CHECK_FALSE(client.connectToHost(1000));
+  CHECK_FALSE(client.isConnected());
+}
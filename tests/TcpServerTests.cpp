@@ -0,0 +1,328 @@
+#include <catch2/catch_all.hpp>
+
+#include <EventLoop.h>
+#include <TcpServer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static int connectLoopback(uint16_t port)
+{
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+static bool waitFor(const std::function<bool()>& condition, std::chrono::milliseconds timeout)
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+static void echoServer(TcpServer& server)
+{
+  server.setReadHandler([](FdConnection& c) {
+    c.write(c.read(FdConnection::maxReadSize));
+  });
+}
+
+TEST_CASE("tcp server echoes across sharded workers", "[tcp-server]")
+{
+  TcpServer server(0, "127.0.0.1", 2);
+  echoServer(server);
+
+  std::atomic<int> connected(0);
+  std::atomic<int> closed(0);
+  server.setConnectHandler([&](FdConnection&) { connected++; });
+  server.setCloseHandler([&](FdConnection&) { closed++; });
+
+  REQUIRE(server.begin());
+  REQUIRE(server.port() != 0);
+  CHECK(server.workerCount() == 2);
+
+  const int count = 200;
+  std::vector<int> clients;
+  for (int i = 0; i < count; i++) {
+    int fd = connectLoopback(server.port());
+    REQUIRE(fd >= 0);
+    clients.push_back(fd);
+  }
+
+  REQUIRE(waitFor([&] { return server.connectionCount() == count; }, 2000ms));
+  CHECK(connected.load() == count);
+
+  for (int i = 0; i < count; i++) {
+    std::string message = "device " + std::to_string(i);
+    REQUIRE(::write(clients[i], message.data(), message.size()) == static_cast<ssize_t>(message.size()));
+  }
+
+  for (int i = 0; i < count; i++) {
+    std::string expected = "device " + std::to_string(i);
+    char buffer[64];
+    ssize_t n = ::read(clients[i], buffer, sizeof(buffer));
+    REQUIRE(n == static_cast<ssize_t>(expected.size()));
+    CHECK(std::string(buffer, n) == expected);
+    close(clients[i]);
+  }
+
+  REQUIRE(waitFor([&] { return server.connectionCount() == 0; }, 2000ms));
+  CHECK(closed.load() == count);
+
+  server.end();
+  CHECK_FALSE(server.isRunning());
+}
+
+TEST_CASE("tcp server ends straight after it begins", "[tcp-server]")
+{
+  // end() stops workers that may not have entered their loops yet
+  for (int round = 0; round < 50; round++) {
+    TcpServer server(0, "127.0.0.1", 4);
+    REQUIRE(server.begin());
+    server.end();
+  }
+}
+
+static double cpuSeconds()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+TEST_CASE("tcp server sheds connections when out of descriptors", "[tcp-server]")
+{
+  TcpServer server(0, "127.0.0.1", 1);
+  echoServer(server);
+  REQUIRE(server.begin());
+
+  struct rlimit saved;
+  REQUIRE(getrlimit(RLIMIT_NOFILE, &saved) == 0);
+
+  // Descriptors are handed out lowest first: after this the client below
+  // takes the last one and the server's accept() fails with EMFILE
+  int probe = dup(0);
+  REQUIRE(probe >= 0);
+  close(probe);
+  struct rlimit lowered = saved;
+  lowered.rlim_cur = probe + 1;
+  REQUIRE(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+
+  int client = connectLoopback(server.port());
+  bool connected = client >= 0;
+  std::this_thread::sleep_for(20ms);
+
+  // A spinning listener would burn the whole interval on the worker
+  double cpu_before = cpuSeconds();
+  std::this_thread::sleep_for(200ms);
+  double cpu_used = cpuSeconds() - cpu_before;
+
+  char buffer[16];
+  ssize_t n = connected ? ::recv(client, buffer, sizeof(buffer), MSG_DONTWAIT) : -1;
+  int recv_errno = errno;
+
+  if (connected) {
+    close(client);
+  }
+  setrlimit(RLIMIT_NOFILE, &saved);
+
+  REQUIRE(connected);
+  CHECK(cpu_used < 0.1);
+  CHECK(server.connectionCount() == 0);
+
+  // The peer was dropped rather than left hanging in the backlog
+  CHECK((n == 0 || (n < 0 && recv_errno == ECONNRESET)));
+
+  // With descriptors back, the server accepts again
+  client = connectLoopback(server.port());
+  REQUIRE(client >= 0);
+  REQUIRE(::write(client, "ping", 4) == 4);
+  n = ::read(client, buffer, sizeof(buffer));
+  CHECK(std::string(buffer, n > 0 ? n : 0) == "ping");
+  close(client);
+
+  server.end();
+}
+
+struct LoadResult {
+  int connections = 0;
+  size_t messages = 0;
+  double seconds = 0;
+  double p50_us = 0;
+  double p99_us = 0;
+};
+
+// Loopback load generator: every connection keeps one 64-byte message in
+// flight and sends the next as soon as the echo returns
+static LoadResult generateLoad(uint16_t port, int connections, int messages_per_connection)
+{
+  struct Client {
+    int fd;
+    int remaining;
+    size_t received;
+    std::chrono::steady_clock::time_point sent_at;
+  };
+
+  LoadResult result;
+  EventLoop loop;
+  if (!loop.begin()) {
+    return result;
+  }
+
+  char message[64] = {};
+  std::vector<Client> clients(connections);
+  std::vector<double> latencies;
+  latencies.reserve(static_cast<size_t>(connections) * messages_per_connection);
+  int finished = 0;
+
+  for (int i = 0; i < connections; i++) {
+    clients[i].fd = connectLoopback(port);
+    if (clients[i].fd < 0) {
+      return result;
+    }
+
+    // Stay under the listen backlog while the server catches up
+    if (i % 500 == 499) {
+      std::this_thread::sleep_for(5ms);
+    }
+  }
+  result.connections = connections;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (Client& client : clients) {
+    client.remaining = messages_per_connection;
+    client.received = 0;
+
+    Client* raw = &client;
+    loop.add(client.fd, EPOLLIN, [&, raw](uint32_t) {
+      char buffer[256];
+      ssize_t n = ::read(raw->fd, buffer, sizeof(buffer));
+      if (n <= 0) {
+        return;
+      }
+
+      raw->received += n;
+      if (raw->received < sizeof(message)) {
+        return;
+      }
+
+      raw->received -= sizeof(message);
+      latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - raw->sent_at).count());
+
+      if (--raw->remaining > 0) {
+        raw->sent_at = std::chrono::steady_clock::now();
+        ::write(raw->fd, message, sizeof(message));
+      } else if (++finished == connections) {
+        loop.stop();
+      }
+    });
+
+    client.sent_at = std::chrono::steady_clock::now();
+    ::write(client.fd, message, sizeof(message));
+  }
+
+  loop.run();
+
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.messages = latencies.size();
+
+  std::sort(latencies.begin(), latencies.end());
+  if (!latencies.empty()) {
+    result.p50_us = latencies[latencies.size() / 2];
+    result.p99_us = latencies[latencies.size() * 99 / 100];
+  }
+
+  for (Client& client : clients) {
+    loop.remove(client.fd);
+    close(client.fd);
+  }
+
+  return result;
+}
+
+static bool raiseFileLimit(rlim_t wanted)
+{
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+    return false;
+  }
+
+  limit.rlim_cur = std::min(wanted, limit.rlim_max);
+  return setrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur >= wanted;
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("tcp server throughput and latency at 1k and 10k connections", "[.][benchmark]")
+{
+  for (int connections : {1000, 10000}) {
+    // The generator runs in a child process so each side gets its own
+    // descriptor table
+    if (!raiseFileLimit(connections + 256)) {
+      WARN("RLIMIT_NOFILE too low for " << connections << " connections");
+      continue;
+    }
+
+    TcpServer server(0, "127.0.0.1");
+    echoServer(server);
+    REQUIRE(server.begin());
+
+    int report[2];
+    REQUIRE(pipe(report) == 0);
+
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+      close(report[0]);
+      LoadResult result = generateLoad(server.port(), connections, 20);
+      ::write(report[1], &result, sizeof(result));
+      _exit(0);
+    }
+
+    close(report[1]);
+    LoadResult result;
+    ssize_t n = ::read(report[0], &result, sizeof(result));
+    close(report[0]);
+    waitpid(child, nullptr, 0);
+
+    REQUIRE(n == static_cast<ssize_t>(sizeof(result)));
+    REQUIRE(result.connections == connections);
+
+    std::printf("%d connections, %u workers: %zu echoes in %.3f s (%.0f msg/s), p50 %.0f us, p99 %.0f us\n",
+                connections, server.workerCount(), result.messages, result.seconds,
+                result.messages / result.seconds, result.p50_us, result.p99_us);
+
+    server.end();
+  }
+}
@@ -0,0 +1,403 @@
+#include <catch2/catch_all.hpp>
+
+#include <UartConnection.h>
+#include <ram_budget.h>
+
+#include "SimulatedUart.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using FifoUart = SimulatedUart<1>;
+using PolledUart = SimulatedUart<2, false>;
+using TxUart = SimulatedTxUart<3>;
+
+static std::string pattern(size_t length)
+{
+  std::string data;
+  for (size_t i = 0; i < length; i++) {
+    data += static_cast<char>(i * 13);
+  }
+  return data;
+}
+
+TEST_CASE("uart connection fills its ring from the interrupt", "[uart]")
+{
+  FifoUart::reset(8, 2);
+  UartConnection<FifoUart, 1024> connection;
+
+  SerialConfig config(1500000);
+  config.hardware_flow_control = true;
+  connection.begin(config);
+  CHECK(FifoUart::config.baud_rate == 1500000);
+  CHECK(FifoUart::config.hardware_flow_control);
+
+  std::string burst = pattern(100);
+  FifoUart::receive(burst);
+  FifoUart::idleFor(2);
+
+  // Emptied by the interrupt, before anyone reads
+  CHECK(FifoUart::rx.empty());
+  CHECK(FifoUart::events == 13);
+  CHECK(connection.availableForReading());
+
+  std::vector<char> first = connection.read(60);
+  std::vector<char> rest = connection.read();
+  CHECK(std::string(first.begin(), first.end()) + std::string(rest.begin(), rest.end()) == burst);
+  CHECK_FALSE(connection.availableForReading());
+}
+
+TEST_CASE("uart connection polls a uart without its own interrupt", "[uart]")
+{
+  PolledUart::reset();
+  UartConnection<PolledUart, 256> connection;
+  connection.begin();
+
+  PolledUart::receive("hello");
+  CHECK(PolledUart::rx.size() == 5);
+
+  CHECK(connection.availableForReading());
+  CHECK(PolledUart::rx.empty());
+  CHECK(connection.readOne() == 'h');
+
+  std::vector<char> rest = connection.read(10);
+  CHECK(std::string(rest.begin(), rest.end()) == "ello");
+}
+
+TEST_CASE("uart connection sends XON from every read path", "[uart]")
+{
+  FifoUart::reset(16, 2);
+  UartConnection<FifoUart, 256> connection;
+  connection.enableXonXoff();
+  connection.begin();
+  REQUIRE(FifoUart::tx == "\x11");
+
+  FifoUart::receive(pattern(200));
+  FifoUart::idleFor(2);
+  REQUIRE(FifoUart::tx == "\x11\x13");
+
+  // read(int) used to leave the sender paused for good
+  CHECK(connection.read(150).size() == 150);
+  CHECK(FifoUart::tx == "\x11\x13\x11");
+
+  FifoUart::receive(pattern(200));
+  FifoUart::idleFor(2);
+  CHECK(FifoUart::tx == "\x11\x13\x11\x13");
+
+  while (connection.tryReadOne() >= 0) {
+  }
+  CHECK(FifoUart::tx == "\x11\x13\x11\x13\x11");
+}
+
+TEST_CASE("uart connection reads bytes above 0x7f without sign extension", "[uart]")
+{
+  FifoUart::reset();
+  UartConnection<FifoUart, 64> connection;
+  connection.begin();
+
+  FifoUart::receive(std::string("\xff\x80", 2));
+  CHECK(connection.tryReadOne() == 0xff);
+  CHECK(connection.tryReadOne() == 0x80);
+  CHECK(connection.tryReadOne() == -1);
+}
+
+TEST_CASE("uart connection writes through the policy", "[uart]")
+{
+  FifoUart::reset();
+  UartConnection<FifoUart, 64> connection;
+  connection.begin();
+
+  connection.write(std::string("abc"));
+  connection.write(std::vector<char>{'d', 'e'});
+  CHECK(FifoUart::tx == "abcde");
+}
+
+TEST_CASE("uart connection queues writes for the TX interrupt", "[uart]")
+{
+  std::string data = pattern(256);
+
+  // Unbuffered, the main loop waits out every character past the FIFO:
+  // 224 of them, about 19 ms at 115200 baud
+  TxUart::reset();
+  UartConnection<TxUart, 64> blocking;
+  blocking.begin();
+  blocking.write(std::vector<char>(data.begin(), data.end()));
+  CHECK(TxUart::stalls == 256 - 32);
+  TxUart::transmitAll();
+  CHECK(TxUart::tx == data);
+
+  TxUart::reset();
+  UartConnection<TxUart, 64, 1024> queued;
+  queued.begin();
+  queued.write(std::vector<char>(data.begin(), data.end()));
+
+  // Primed the FIFO and returned
+  CHECK(TxUart::stalls == 0);
+  CHECK(TxUart::fifo.size() == 32);
+  CHECK(TxUart::tx.empty());
+  CHECK(TxUart::tx_interrupt);
+
+  TxUart::transmitAll();
+  CHECK(TxUart::tx == data);
+  CHECK(TxUart::stalls == 0);
+  // One refill of 28 bytes per interrupt
+  CHECK(TxUart::tx_events == 8);
+  CHECK_FALSE(TxUart::tx_interrupt);
+}
+
+TEST_CASE("uart connection waits only while its TX ring is full", "[uart]")
+{
+  TxUart::reset();
+  UartConnection<TxUart, 64, 64> connection;
+  connection.begin();
+
+  std::string data = pattern(200);
+  CHECK(connection.write(data.data(), data.size()) == 63 + 32);
+  TxUart::transmitAll();
+  CHECK(TxUart::tx == data.substr(0, 95));
+
+  TxUart::tx.clear();
+  connection.write(std::vector<char>(data.begin(), data.end()));
+  CHECK(TxUart::stalls > 0);
+  connection.flush();
+  CHECK(TxUart::fifo.size() == 32);
+  TxUart::transmitAll();
+  CHECK(TxUart::tx == data);
+}
+
+TEST_CASE("uart connection interleaves XON/XOFF with queued writes", "[uart]")
+{
+  for (unsigned seed = 1; seed <= 20; seed++) {
+    std::mt19937 random(seed);
+    TxUart::reset(8, 2, 32, 4);
+    UartConnection<TxUart, 256, 128> connection;
+    connection.enableXonXoff();
+    connection.begin();
+
+    std::string written;
+    for (int step = 0; step < 2000; step++) {
+      switch (random() % 4) {
+        case 0: {
+          std::string chunk(random() % 100, 'a' + random() % 26);
+          connection.write(std::vector<char>(chunk.begin(), chunk.end()));
+          written += chunk;
+          break;
+        }
+        case 1:
+          TxUart::transmit(random() % 64);
+          break;
+        case 2:
+          TxUart::receive(pattern(random() % 100));
+          TxUart::idleFor(2);
+          break;
+        default:
+          connection.read(static_cast<int>(random() % 200));
+          break;
+      }
+    }
+    TxUart::transmitAll();
+
+    std::string data;
+    size_t controls = 0;
+    for (char c : TxUart::tx) {
+      if (c == 0x11 || c == 0x13) {
+        controls++;
+      } else {
+        data += c;
+      }
+    }
+    CHECK(data == written);
+    CHECK(controls > 0);
+    CHECK(TxUart::fifo.size() <= TxUart::fifo_depth);
+  }
+}
+
+TEST_CASE("uart connections on separate ports run side by side", "[uart]")
+{
+  using Uart0 = SimulatedUart<10>;
+  using Uart1 = SimulatedUart<11>;
+  using Uart2 = SimulatedTxUart<12>;
+
+  using First = UartConnection<Uart0, 256>;
+  using Second = UartConnection<Uart1, 256>;
+  using Third = UartConnection<Uart2, 1024, 256>;
+
+  Uart0::reset(8, 2);
+  Uart1::reset(16, 2);
+  Uart2::reset(4, 2);
+  First first;
+  Second second;
+  Third third;
+  second.enableXonXoff();
+  first.begin();
+  second.begin(SerialConfig(9600));
+  third.begin(SerialConfig(1000000));
+
+  // A trampoline per port, each bound to its own connection
+  CHECK(Uart0::config.baud_rate == 115200);
+  CHECK(Uart1::config.baud_rate == 9600);
+  CHECK(Uart2::config.baud_rate == 1000000);
+  CHECK(&First::onInterrupt != &Second::onInterrupt);
+  CHECK(&Second::onInterrupt != &Third::onInterrupt);
+
+  std::mt19937 random(7);
+  std::string sent[3];
+  std::string received[3];
+  std::string written;
+  for (int step = 0; step < 3000; step++) {
+    int port = random() % 3;
+    std::string chunk(random() % 40, 'a' + port);
+
+    switch (random() % 3) {
+      case 0:
+        if (port == 0) {
+          Uart0::receive(chunk);
+          Uart0::idleFor(2);
+        } else if (port == 1) {
+          Uart1::receive(chunk);
+          Uart1::idleFor(2);
+        } else {
+          Uart2::receive(chunk);
+          Uart2::idleFor(2);
+        }
+        sent[port] += chunk;
+        break;
+      case 1: {
+        Connection& connection = port == 0 ? static_cast<Connection&>(first) :
+                                 port == 1 ? static_cast<Connection&>(second) :
+                                             static_cast<Connection&>(third);
+        std::vector<char> part = connection.read(static_cast<int>(random() % 120));
+        received[port].append(part.begin(), part.end());
+        break;
+      }
+      default:
+        third.write(std::vector<char>(chunk.begin(), chunk.end()));
+        written += chunk;
+        Uart2::transmit(random() % 48);
+        break;
+    }
+  }
+
+  std::vector<char> part;
+  while (!(part = first.read(300)).empty()) {
+    received[0].append(part.begin(), part.end());
+  }
+  while (!(part = second.read(300)).empty()) {
+    received[1].append(part.begin(), part.end());
+  }
+  while (!(part = third.read(300)).empty()) {
+    received[2].append(part.begin(), part.end());
+  }
+  Uart2::transmitAll();
+
+  for (int port = 0; port < 3; port++) {
+    CHECK(received[port] == sent[port]);
+  }
+  CHECK(first.droppedBytes() + second.droppedBytes() + third.droppedBytes() == 0);
+
+  // Flow control only where it was enabled, and the TX ring only on its port
+  CHECK(Uart0::tx.empty());
+  CHECK(Uart1::tx.substr(0, 1) == "\x11");
+  CHECK(Uart2::tx == written);
+}
+
+template<typename Uart>
+static void fuzz(unsigned seed)
+{
+  std::mt19937 random(seed);
+  Uart::reset(1 + random() % 32, 2);
+  UartConnection<Uart, 512> connection;
+  connection.begin();
+
+  std::string sent;
+  std::string received;
+  for (int step = 0; step < 2000; step++) {
+    switch (random() % 3) {
+      case 0: {
+        std::string chunk = pattern(random() % 200);
+        Uart::receive(chunk);
+        sent += chunk;
+        break;
+      }
+      case 1:
+        Uart::idleFor(random() % 4);
+        break;
+      default: {
+        std::vector<char> part = connection.read(static_cast<int>(random() % 300));
+        received.append(part.begin(), part.end());
+        break;
+      }
+    }
+  }
+
+  Uart::idleFor(2);
+  std::vector<char> part;
+  while (!(part = connection.read(300)).empty()) {
+    received.append(part.begin(), part.end());
+  }
+
+  // Whatever the ring could not hold is dropped whole and counted; the
+  // rest arrives in order
+  CHECK(received.size() + connection.droppedBytes() == sent.size());
+  if (connection.droppedBytes() == 0) {
+    CHECK(received == sent);
+  }
+}
+
+TEST_CASE("uart connection sizes are chosen per instance", "[uart]")
+{
+  using Tiny = UartConnection<SimulatedUart<20>, 64, 0, 16>;
+  using Large = UartConnection<SimulatedTxUart<21>, 16384, 1024>;
+
+  // The rings are members, so sizeof is what a connection costs
+  static_assert(sizeof(Tiny) < 128);
+  static_assert(sizeof(Large) > 16384 + 1024);
+  static_assert(RamBudget<Tiny, Large>::total == sizeof(Tiny) + sizeof(Large));
+  static_assert(RamBudget<Tiny>::fits(128));
+  static_assert(!RamBudget<Tiny, Large>::fits(16 * 1024));
+
+  SimulatedUart<20>::reset();
+  Tiny tiny;
+  tiny.begin();
+  CHECK(Tiny::maxReadSize == 16);
+  CHECK(Large::maxReadSize == 128);
+
+  std::string burst = pattern(40);
+  SimulatedUart<20>::receive(burst);
+
+  std::vector<char> first = tiny.read();
+  std::vector<char> rest = tiny.read(64);
+  CHECK(first.size() == 16);
+  CHECK(std::string(first.begin(), first.end()) + std::string(rest.begin(), rest.end()) == burst);
+}
+
+TEST_CASE("uart connection keeps the stream intact under random traffic", "[uart]")
+{
+  for (unsigned seed = 1; seed <= 20; seed++) {
+    fuzz<FifoUart>(seed);
+    fuzz<PolledUart>(seed);
+  }
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("uart connection RX throughput", "[.][benchmark]")
+{
+  std::string data = pattern(1 << 16);
+
+  BENCHMARK("ISR path: 64 KiB through a 16 byte FIFO threshold")
+  {
+    FifoUart::reset(16, 2);
+    UartConnection<FifoUart, 4096> connection;
+    connection.begin();
+
+    size_t total = 0;
+    char buffer[1024];
+    for (size_t offset = 0; offset < data.size(); offset += 1024) {
+      FifoUart::receive(data.data() + offset, 1024);
+      FifoUart::idleFor(2);
+      total += connection.read(buffer, sizeof(buffer));
+    }
+    return total;
+  };
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch_all.hpp>
+
+#include <uart_receiver.h>
+
+#include "SimulatedUart.h"
+
+#include <string>
+#include <vector>
+
+using Uart = SimulatedBufferedUart<0>;
+
+static std::string pattern(size_t length)
+{
+  std::string data;
+  for (size_t i = 0; i < length; i++) {
+    data += static_cast<char>(i * 7);
+  }
+  return data;
+}
+
+template<typename Receiver>
+static std::string drain(Receiver& receiver)
+{
+  std::string result;
+  char buffer[100];
+  size_t n;
+  while ((n = receiver.read(buffer, sizeof(buffer))) > 0) {
+    result.append(buffer, n);
+  }
+  return result;
+}
+
+TEST_CASE("uart receiver takes a burst in one read per event", "[uart]")
+{
+  Uart::reset(64, 2);
+  UartReceiver<Uart, 4096> receiver;
+  Uart::on_event = [&] { receiver.service(); };
+
+  std::string burst = pattern(1000);
+  Uart::receive(burst);
+  Uart::idleFor(2);
+
+  // 15 threshold events and one for the 40 byte tail, not 1000
+  CHECK(Uart::events == 16);
+  CHECK(Uart::read_calls == 16);
+  CHECK(Uart::buffered() == 0);
+  CHECK(drain(receiver) == burst);
+}
+
+TEST_CASE("uart receiver wraps the ring with at most two reads per event", "[uart]")
+{
+  Uart::reset(48, 2);
+  UartReceiver<Uart, 256> receiver;
+  Uart::on_event = [&] { receiver.service(); };
+
+  std::string sent;
+  std::string received;
+  for (int round = 0; round < 20; round++) {
+    std::string chunk = pattern(100 + round);
+    Uart::receive(chunk);
+    Uart::idleFor(2);
+    sent += chunk;
+    received += drain(receiver);
+  }
+
+  CHECK(received == sent);
+  CHECK(Uart::read_calls <= 2 * Uart::events);
+  CHECK(receiver.droppedBytes() == 0);
+}
+
+TEST_CASE("uart receiver drops and counts what the ring cannot hold", "[uart]")
+{
+  Uart::reset(16, 2);
+  UartReceiver<Uart, 64> receiver;
+  Uart::on_event = [&] { receiver.service(); };
+
+  std::string burst = pattern(200);
+  Uart::receive(burst);
+  Uart::idleFor(2);
+
+  CHECK(Uart::buffered() == 0);
+  CHECK(receiver.count() == 63);
+  CHECK(receiver.droppedBytes() == 200 - 63);
+  CHECK(drain(receiver) == burst.substr(0, 63));
+}
+
+TEST_CASE("uart receiver sends XOFF when filling and XON once drained", "[uart]")
+{
+  using Receiver = UartReceiver<Uart, 256>;
+
+  Uart::reset(8, 2);
+  Receiver receiver;
+  receiver.setXonXoff(true);
+  Uart::on_event = [&] { receiver.service(); };
+
+  Uart::receive(pattern(150));
+  Uart::idleFor(2);
+  CHECK(Uart::tx.empty());
+
+  Uart::receive(pattern(50));
+  Uart::idleFor(2);
+  CHECK(Uart::tx == std::string(1, Receiver::XOFF));
+  CHECK(receiver.isPaused());
+
+  char buffer[100];
+  CHECK(receiver.read(buffer, 100) == 100);
+  CHECK(Uart::tx.size() == 1);
+  CHECK(receiver.read(buffer, 100) == 100);
+  CHECK(Uart::tx == std::string() + Receiver::XOFF + Receiver::XON);
+  CHECK_FALSE(receiver.isPaused());
+}
+
+TEST_CASE("uart receiver returns bytes above 0x7f as non-negative", "[uart]")
+{
+  Uart::reset();
+  UartReceiver<Uart, 64> receiver;
+  Uart::on_event = [&] { receiver.service(); };
+
+  Uart::receive(std::string("\xff\x80", 2));
+  CHECK(receiver.tryReadOne() == 0xff);
+  CHECK(receiver.tryReadOne() == 0x80);
+  CHECK(receiver.tryReadOne() == -1);
+}
+
+// Hidden by default; run with: tests "[benchmark]"
+TEST_CASE("uart receiver throughput", "[.][benchmark]")
+{
+  std::string data = pattern(1 << 16);
+
+  BENCHMARK("batched: 64 KiB at a 64 byte threshold")
+  {
+    Uart::reset(64, 2);
+    UartReceiver<Uart, 4096> receiver;
+    Uart::on_event = [&] { receiver.service(); };
+
+    size_t total = 0;
+    char buffer[1024];
+    for (size_t offset = 0; offset < data.size(); offset += 1024) {
+      Uart::receive(data.data() + offset, 1024);
+      Uart::idleFor(2);
+      total += receiver.read(buffer, sizeof(buffer));
+    }
+    return total;
+  };
+}
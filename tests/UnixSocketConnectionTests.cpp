@@ -0,0 +1,160 @@
+#include <catch2/catch_all.hpp>
+
+#include <UnixSocketConnection.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+
+static std::string socketPath(const char* name)
+{
+  return "/tmp/transmission-test-" + std::to_string(getpid()) + "-" + name + ".sock";
+}
+
+TEST_CASE("unix stream socket round trips through a listener", "[unix]")
+{
+  UnixSocketListener listener(socketPath("stream"));
+  REQUIRE(listener.begin());
+  CHECK(listener.accept(0) == nullptr);
+
+  UnixSocketConnection client(socketPath("stream"));
+  REQUIRE(client.connectToPath());
+
+  std::unique_ptr<UnixSocketConnection> server = listener.accept(1000);
+  REQUIRE(server != nullptr);
+
+  client.write(std::string("hello"));
+  std::vector<char> received = server->read(5);
+  CHECK(std::string(received.begin(), received.end()) == "hello");
+
+  server->write(std::string("world"));
+  CHECK(client.readOne() == 'w');
+  received = client.read(4);
+  CHECK(std::string(received.begin(), received.end()) == "orld");
+  CHECK(client.tryReadOne() == -1);
+
+  server.reset();
+  received = client.read(1);
+  CHECK(received.empty());
+  CHECK_FALSE(client.isConnected());
+
+  listener.end();
+  CHECK(access(socketPath("stream").c_str(), F_OK) != 0);
+}
+
+TEST_CASE("unix seqpacket socket keeps message boundaries", "[unix]")
+{
+  std::unique_ptr<UnixSocketConnection> a;
+  std::unique_ptr<UnixSocketConnection> b;
+  REQUIRE(UnixSocketConnection::createPair(a, b, UnixSocketConnection::Type::seqpacket));
+
+  REQUIRE(a->sendMessage({'o', 'n', 'e'}));
+  REQUIRE(a->sendMessage({'t', 'w', 'o', '!'}));
+
+  std::vector<char> first = b->receiveMessage(1000);
+  std::vector<char> second = b->receiveMessage(1000);
+  CHECK(std::string(first.begin(), first.end()) == "one");
+  CHECK(std::string(second.begin(), second.end()) == "two!");
+  CHECK(b->receiveMessage(0).empty());
+
+  std::vector<char> too_big(UnixSocketConnection::maxPacketSize + 1);
+  CHECK_FALSE(a->sendMessage(too_big));
+}
+
+TEST_CASE("unix socket passes descriptors in order with the data", "[unix]")
+{
+  for (auto type : {UnixSocketConnection::Type::stream, UnixSocketConnection::Type::seqpacket}) {
+    std::unique_ptr<UnixSocketConnection> a;
+    std::unique_ptr<UnixSocketConnection> b;
+    REQUIRE(UnixSocketConnection::createPair(a, b, type));
+
+    int pipe_fds[2];
+    REQUIRE(pipe(pipe_fds) == 0);
+
+    a->write(std::string("before"));
+    REQUIRE(a->sendDescriptor(pipe_fds[0]));
+    a->write(std::string("after"));
+    close(pipe_fds[0]);
+
+    int received = b->receiveDescriptor(1000);
+    REQUIRE(received >= 0);
+
+    // The marker byte never shows up in the data
+    std::vector<char> data = b->read(11);
+    CHECK(std::string(data.begin(), data.end()) == "beforeafter");
+
+    REQUIRE(::write(pipe_fds[1], "x", 1) == 1);
+    char c = 0;
+    REQUIRE(::read(received, &c, 1) == 1);
+    CHECK(c == 'x');
+
+    close(received);
+    close(pipe_fds[1]);
+    CHECK(b->receiveDescriptor(0) == -1);
+  }
+}
+
+TEST_CASE("unix stream socket reports a descriptor stuck behind a full ring", "[unix]")
+{
+  std::unique_ptr<UnixSocketConnection> a;
+  std::unique_ptr<UnixSocketConnection> b;
+  REQUIRE(UnixSocketConnection::createPair(a, b));
+
+  int pipe_fds[2];
+  REQUIRE(pipe(pipe_fds) == 0);
+
+  // More bytes ahead of the descriptor than the RX ring holds
+  std::vector<char> ahead(UnixSocketConnection::maxBufferSize + 100, 'a');
+  a->write(ahead);
+  REQUIRE(a->sendDescriptor(pipe_fds[0]));
+  close(pipe_fds[0]);
+
+  auto start = std::chrono::steady_clock::now();
+  CHECK(b->receiveDescriptor(-1) == -1);
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+  std::vector<char> data = b->read(static_cast<int>(ahead.size()));
+  CHECK(data == ahead);
+
+  int received = b->receiveDescriptor(1000);
+  REQUIRE(received >= 0);
+  close(received);
+  close(pipe_fds[1]);
+}
+
+TEST_CASE("unix socket hands an open descriptor to another process", "[unix]")
+{
+  std::unique_ptr<UnixSocketConnection> supervisor;
+  std::unique_ptr<UnixSocketConnection> worker;
+  REQUIRE(UnixSocketConnection::createPair(supervisor, worker));
+
+  pid_t child = fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    supervisor.reset();
+
+    // Use the descriptor without reopening anything
+    int fd = worker->receiveDescriptor(5000);
+    bool ok = fd >= 0 && ::write(fd, "from worker", 11) == 11;
+    _exit(ok ? 0 : 1);
+  }
+
+  worker.reset();
+
+  int pipe_fds[2];
+  REQUIRE(pipe(pipe_fds) == 0);
+  REQUIRE(supervisor->sendDescriptor(pipe_fds[1]));
+  close(pipe_fds[1]);
+
+  int status = 0;
+  REQUIRE(waitpid(child, &status, 0) == child);
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == 0);
+
+  char buffer[32];
+  ssize_t n = ::read(pipe_fds[0], buffer, sizeof(buffer));
+  REQUIRE(n == 11);
+  CHECK(std::string(buffer, n) == "from worker");
+  close(pipe_fds[0]);
+}
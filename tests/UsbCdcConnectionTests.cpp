@@ -0,0 +1,161 @@
+#include <catch2/catch_all.hpp>
+
+#include <UsbCdcConnection.h>
+
+#include "SimulatedUsbSerial.h"
+
+#include <string>
+#include <vector>
+
+using Usb = SimulatedUsbSerial;
+using SmallConnection = UsbCdcConnection<Usb, 128>;
+
+static std::string pattern(size_t length)
+{
+  std::string data;
+  for (size_t i = 0; i < length; i++) {
+    data += static_cast<char>(i * 7);
+  }
+  return data;
+}
+
+TEST_CASE("usb cdc connection empties the stack in spans", "[usb]")
+{
+  Usb::reset();
+  UsbCdcConnection<Usb, 1024> connection;
+  connection.begin();
+
+  std::string burst = pattern(500);
+  Usb::receive(burst);
+
+  std::vector<char> got = connection.read(500);
+  CHECK(std::string(got.begin(), got.end()) == burst);
+  CHECK(Usb::read_calls == 1);
+  CHECK(Usb::idles == 0);
+  CHECK_FALSE(connection.availableForReading());
+}
+
+TEST_CASE("usb cdc connection hands the stack whole packets", "[usb]")
+{
+  Usb::reset();
+  UsbCdcConnection<Usb, 256> connection;
+
+  std::string sent;
+  for (int i = 0; i < 100; i++) {
+    std::string message = pattern(10 + i % 7);
+    connection.write(message.data(), message.size());
+    sent += message;
+  }
+
+  for (size_t size : Usb::writes) {
+    CHECK(size == 64);
+  }
+  CHECK(Usb::writes.size() == sent.size() / 64);
+  CHECK(Usb::flushes == 0);
+
+  connection.flush();
+  CHECK(Usb::tx == sent);
+  CHECK(Usb::writes.back() == sent.size() % 64);
+  CHECK(Usb::flushes == 1);
+
+  // Whole packets alone still get flushed, but only once
+  std::string packet = pattern(128);
+  connection.write(packet.data(), packet.size());
+  connection.flush();
+  connection.flush();
+  CHECK(Usb::flushes == 2);
+}
+
+TEST_CASE("usb cdc connection tops up a partial packet and passes the rest through", "[usb]")
+{
+  Usb::reset();
+  UsbCdcConnection<Usb, 256> connection;
+
+  std::string head = pattern(10);
+  std::string body = pattern(1000);
+  connection.write(head.data(), head.size());
+  connection.write(body.data(), body.size());
+
+  // 54 to finish the staged packet, then 896 straight from the caller
+  std::vector<size_t> expected{64, 896};
+  CHECK(Usb::writes == expected);
+  connection.flush();
+  CHECK(Usb::tx == head + body);
+  CHECK(Usb::writes.back() == 50);
+}
+
+TEST_CASE("usb cdc connection sends a partial packet once its delay runs out", "[usb]")
+{
+  Usb::reset();
+  UsbCdcConnection<Usb, 256> connection;
+  connection.setFlushDelay(500);
+
+  connection.write(std::vector<char>{'h', 'i'});
+  CHECK(Usb::tx.empty());
+
+  Usb::now = 400;
+  connection.poll();
+  CHECK(Usb::tx.empty());
+
+  Usb::now = 500;
+  connection.poll();
+  CHECK(Usb::tx == "hi");
+  CHECK(Usb::flushes == 1);
+
+  Usb::now = 2000;
+  connection.poll();
+  CHECK(Usb::flushes == 1);
+
+  // Nothing sent since, so there is nothing to push out
+  connection.flush();
+  CHECK(Usb::flushes == 1);
+}
+
+TEST_CASE("usb cdc connection reads block until the bytes arrive", "[usb]")
+{
+  Usb::reset();
+  UsbCdcConnection<Usb, 256> connection;
+
+  Usb::receive("abc");
+  Usb::arriveOnIdle("defgh");
+
+  std::vector<char> got = connection.read(8);
+  CHECK(std::string(got.begin(), got.end()) == "abcdefgh");
+  CHECK(Usb::idles == 1);
+
+  Usb::arriveOnIdle("z");
+  CHECK(connection.readOne() == 'z');
+}
+
+TEST_CASE("usb cdc connection leaves what the ring cannot take in the stack", "[usb]")
+{
+  Usb::reset();
+  Usb::capacity = 256;
+  UsbCdcConnection<Usb, 128> connection;
+
+  std::string data = pattern(1000);
+  Usb::receive(data);
+  connection.poll();
+
+  CHECK(Usb::stack.size() + Usb::host.size() == 1000 - 127);
+
+  std::vector<char> got = connection.read(1000);
+  CHECK(std::string(got.begin(), got.end()) == data);
+  CHECK(connection.droppedBytes() == 0);
+}
+
+TEST_CASE("usb cdc connection pauses the host with XON/XOFF", "[usb]")
+{
+  Usb::reset();
+  SmallConnection connection;
+  connection.enableXonXoff();
+  connection.begin();
+  CHECK(Usb::tx == std::string(1, SmallConnection::XON));
+
+  Usb::receive(pattern(100));
+  connection.poll();
+  CHECK(Usb::tx.back() == SmallConnection::XOFF);
+
+  connection.read(90);
+  CHECK(Usb::tx.back() == SmallConnection::XON);
+}
@@ -1,9 +1,60 @@
 #include "TransmissionMain.h"
 
-TransmissionMain::TransmissionMain()
+#include <ReliableConnectionLinux.h>
+
+#include <iostream>
+
+TransmissionMain::TransmissionMain(std::vector<Port> ports) : ports(std::move(ports))
+{
+}
+
+bool TransmissionMain::begin()
+{
+  if (!event_loop.begin())
+  {
+    return false;
+  }
+
+  for (const Port& port : ports)
+  {
+    int fd = ReliableConnectionLinux::openSerialPort(port.device_path, port.config);
+    if (fd < 0)
+    {
+      end();
+      return false;
+    }
+
+    auto share = std::make_unique<SerialShare>(event_loop, fd, port.socket_path);
+    if (!share->begin())
+    {
+      end();
+      return false;
+    }
+
+    std::cout << "Sharing " << port.device_path << " at " << port.config.baud_rate << " baud on " << port.socket_path << std::endl;
+    shares.push_back(std::move(share));
+  }
+
+  return true;
+}
+
+void TransmissionMain::end()
 {
+  shares.clear();
+  event_loop.end();
 }
 
-void TransmissionMain::loop()
+bool TransmissionMain::loop()
 {
+  event_loop.runOnce(100);
+
+  for (const auto& share : shares)
+  {
+    if (share->isOpen())
+    {
+      return true;
+    }
+  }
+
+  return false;
 }
@@ -1,12 +1,40 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#include <EventLoop.h>
+#include <SerialShare.h>
+#include <SerialConfig.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Serial port sharing daemon: owns each configured port and serves it to
+// any number of local clients on its own Unix socket (see SerialShare).
 class TransmissionMain
 {
   public:
-    TransmissionMain();
+    struct Port
+    {
+      std::string device_path;
+      SerialConfig config;
+      std::string socket_path;
+    };
+
+    explicit TransmissionMain(std::vector<Port> ports);
+
+    bool begin();
+    void end();
+
+    // Dispatch one batch of serial and client traffic. Returns false once
+    // every port has gone away.
+    bool loop();
 
-    void loop();
+  private:
+    std::vector<Port> ports;
+    EventLoop event_loop;
+    std::vector<std::unique_ptr<SerialShare>> shares;
 };
 
 #endif //MAIN_H
@@ -4,11 +4,124 @@
 
 #include "TransmissionMain.h"
 
-int main()
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+static volatile std::sig_atomic_t stopping = 0;
+
+static void handleSignal(int)
+{
+  stopping = 1;
+}
+
+static void usage(const char* name)
+{
+  std::cerr << "usage: " << name << " DEVICE[@BAUD[,FRAMING][,rtscts]] SOCKET [...]" << std::endl;
+  std::cerr << "  FRAMING is data bits, parity (N, E or O) and stop bits, 8N1 by default" << std::endl;
+  std::cerr << "  e.g. " << name << " /dev/ttyUSB0@3000000,8N1,rtscts /tmp/ttyUSB0.sock" << std::endl;
+}
+
+// BAUD[,FRAMING][,rtscts], e.g. "1500000,8E1,rtscts"
+static bool parseSerialConfig(const std::string& spec, SerialConfig& config)
+{
+  size_t start = 0;
+  bool first = true;
+  while (start <= spec.size())
+  {
+    size_t comma = spec.find(',', start);
+    std::string field = spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+    if (first)
+    {
+      char* end = nullptr;
+      config.baud_rate = static_cast<uint32_t>(std::strtoul(field.c_str(), &end, 10));
+      if (field.empty() || *end != '\0')
+      {
+        return false;
+      }
+      first = false;
+    }
+    else if (field == "rtscts")
+    {
+      config.hardware_flow_control = true;
+    }
+    else if (field.size() == 3 && field[0] >= '5' && field[0] <= '8' && (field[2] == '1' || field[2] == '2'))
+    {
+      config.data_bits = static_cast<uint8_t>(field[0] - '0');
+      config.stop_bits = static_cast<uint8_t>(field[2] - '0');
+
+      switch (field[1])
+      {
+        case 'N': config.parity = SerialConfig::Parity::none; break;
+        case 'E': config.parity = SerialConfig::Parity::even; break;
+        case 'O': config.parity = SerialConfig::Parity::odd; break;
+        default: return false;
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    if (comma == std::string::npos)
+    {
+      break;
+    }
+    start = comma + 1;
+  }
+
+  return config.valid();
+}
+
+int main(int argc, char* argv[])
 {
-  TransmissionMain transmission_main = TransmissionMain();
-  while(true)
+  if (argc < 3 || (argc - 1) % 2 != 0)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<TransmissionMain::Port> ports;
+  for (int i = 1; i < argc; i += 2)
   {
-    transmission_main.loop();
+    std::string device = argv[i];
+    SerialConfig config;
+
+    size_t at = device.find('@');
+    if (at != std::string::npos)
+    {
+      if (!parseSerialConfig(device.substr(at + 1), config))
+      {
+        std::cerr << "Bad serial settings: " << device << std::endl;
+        usage(argv[0]);
+        return 2;
+      }
+      device.resize(at);
+    }
+
+    ports.push_back({device, config, argv[i + 1]});
   }
+
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  TransmissionMain transmission_main(ports);
+  if (!transmission_main.begin())
+  {
+    return 1;
+  }
+
+  while (!stopping)
+  {
+    if (!transmission_main.loop())
+    {
+      std::cerr << "All serial ports closed" << std::endl;
+      break;
+    }
+  }
+
+  transmission_main.end();
+  return 0;
 }